@@ -46,13 +46,12 @@ void SSD130X::InitDisplay(){
     halvorsen_b.zr = 6.334;
     halvorsen_b.zl = -12.186;
 
-    // This model for now converges to a point: it needs to be fixed
-    lorentz_b.xr = 10.0;
-    lorentz_b.xl = -10.0;
-    lorentz_b.yr = 10.0;
-    lorentz_b.yl = -10.0;
-    lorentz_b.zr = 10.0;
-    lorentz_b.zl = -10.0;
+    lorentz_b.xr = 19.398;
+    lorentz_b.xl = -19.398;
+    lorentz_b.yr = 26.87;
+    lorentz_b.yl = -26.87;
+    lorentz_b.zr = 47.5;
+    lorentz_b.zl = 1.512;
 
     borders[static_cast<int>(Displayed_Models::CHUA)] = chua_b;
     borders[static_cast<int>(Displayed_Models::SPROTT)] = sprott_b;
@@ -60,11 +59,48 @@ void SSD130X::InitDisplay(){
     borders[static_cast<int>(Displayed_Models::HALVORSEN)] = halvorsen_b;
     borders[static_cast<int>(Displayed_Models::LORENTZ)] = lorentz_b;
 
+    // constant rotations of the 3D view
+    float c = cosf(VIEW_ROTATION_STEP), s = sinf(VIEW_ROTATION_STEP);
+    rotation_step[0] = math::vec3f{c, -s, 0.0f};
+    rotation_step[1] = math::vec3f{s, c, 0.0f};
+    rotation_step[2] = math::vec3f{0.0f, 0.0f, 1.0f};
+
+    c = cosf(VIEW_TILT);
+    s = sinf(VIEW_TILT);
+    tilt[0] = math::vec3f{1.0f, 0.0f, 0.0f};
+    tilt[1] = math::vec3f{0.0f, c, -s};
+    tilt[2] = math::vec3f{0.0f, s, c};
+
+    UpdateProjection();
     ClearDisplay();
 }
 
 void SSD130X::setCurrentModel(Displayed_Models md){
     model_number = md;
+
+    // the old trajectory has a different scale: start over
+    memset(phosphor, 0, sizeof(phosphor));
+    last_x = -1;
+    last_y = -1;
+
+    UpdateProjection();
+}
+
+// Overrides the empiric borders, e.g. to plot states which are already normalized
+void SSD130X::setBorders(Displayed_Models md, model_borders_t border){
+    borders[static_cast<int>(md)] = border;
+
+    if(md == model_number){
+        UpdateProjection();
+    }
+}
+
+void SSD130X::setView(PlotView pv){
+    view = pv;
+
+    memset(phosphor, 0, sizeof(phosphor));
+    last_x = -1;
+    last_y = -1;
 }
 
 void SSD130X::ClearAll(){
@@ -86,14 +122,63 @@ void SSD130X::ClearDisplay(){
 }
 
 void SSD130X::DrawPoint(math::vec3f state){
-    uint8_t x, y;
-    model_borders_t current_border = borders[static_cast<int>(model_number)];
+    int x, y;
+    if(ProjectPlane(projection, state, x, y)){
+        phosphor[y][x] = PHOSPHOR_MAX;
+    }
+}
 
-    // from floating point value to a value between 0 and 63, representing the coordinates of the screen
-    x = (state.x() - current_border.xl) / (current_border.xr - current_border.xl) * 63;
-    y = (state.y() - current_border.yl) / (current_border.yr - current_border.yl) * 63;
+void SSD130X::DrawTrajectory(const math::vec3f *states, size_t count){
+    bool rotated = view == PlotView::ROTATING_3D;
+
+    for(size_t i=0; i<count; i++){
+        int x, y;
+        bool projected = rotated ? ProjectView(view_projection, states[i], x, y)
+                                 : ProjectPlane(projection, states[i], x, y);
+
+        // a diverged state is skipped, and the trajectory starts over from the next one
+        if(!projected){
+            last_x = -1;
+            last_y = -1;
+            continue;
+        }
+
+        if(last_x < 0){
+            phosphor[y][x] = PHOSPHOR_MAX;
+        } else {
+            PlotSegment(last_x, last_y, x, y);
+        }
+
+        last_x = x;
+        last_y = y;
+    }
+}
+
+void SSD130X::RenderPhosphor(){
+    // 4x4 Bayer matrix, used as ordered dithering thresholds
+    static const uint8_t bayer[4][4] = {
+        { 0,  8,  2, 10},
+        {12,  4, 14,  6},
+        { 3, 11,  1,  9},
+        {15,  7, 13,  5}
+    };
+
+    for(int y=0; y<PLOT_SIZE; y++){
+        for(int x=0; x<PLOT_SIZE; x++){
+            uint8_t &value = phosphor[y][x];
+
+            if(value > bayer[y & 3][x & 3] * 16 + 8){
+                display.DrawPixel(63+x, y, true);
+            }
+
+            value = (value * PHOSPHOR_DECAY) >> 8;
+        }
+    }
 
-    display.DrawPixel(63+x, y, true);
+    if(view == PlotView::ROTATING_3D){
+        rotation = rotation_step * rotation;
+        UpdateViewProjection();
+    }
 }
 
 void SSD130X::UpdateDisplay(){
@@ -103,6 +188,63 @@ void SSD130X::UpdateDisplay(){
 
 // private methods
 
+void SSD130X::UpdateProjection(){
+    model_borders_t current_border = borders[static_cast<int>(model_number)];
+
+    // from floating point value to a value between 0 and 63, representing the coordinates of the screen
+    float sx = (PLOT_SIZE - 1) / (current_border.xr - current_border.xl);
+    float sy = (PLOT_SIZE - 1) / (current_border.yr - current_border.yl);
+
+    projection.sx = sx * (1 << PLOT_FRAC_BITS);
+    projection.sy = sy * (1 << PLOT_FRAC_BITS);
+    projection.ox = static_cast<int32_t>(-current_border.xl * projection.sx);
+    projection.oy = static_cast<int32_t>(-current_border.yl * projection.sy);
+
+    // the 3D view fits the bounding sphere of the model borders, so it never clips while rotating
+    view_center = math::vec3f{
+        (current_border.xr + current_border.xl) / 2,
+        (current_border.yr + current_border.yl) / 2,
+        (current_border.zr + current_border.zl) / 2
+    };
+    math::vec3f half_size = math::vec3f{
+        current_border.xr - current_border.xl,
+        current_border.yr - current_border.yl,
+        current_border.zr - current_border.zl
+    } / 2.0f;
+    view_scale = (PLOT_SIZE - 1) / 2.0f / sqrtf(half_size.length_sq()) * (1 << PLOT_FRAC_BITS);
+
+    UpdateViewProjection();
+}
+
+void SSD130X::UpdateViewProjection(){
+    view_projection = MakeViewProjection(rotation, tilt, view_center, view_scale);
+}
+
+// Bresenham line between two plot pixels, drawn into the phosphor buffer
+void SSD130X::PlotSegment(int x0, int y0, int x1, int y1){
+    int dx = x1 > x0 ? x1 - x0 : x0 - x1;
+    int dy = y1 > y0 ? y0 - y1 : y1 - y0;
+    int step_x = x0 < x1 ? 1 : -1;
+    int step_y = y0 < y1 ? 1 : -1;
+    int err = dx + dy;
+
+    while(true){
+        phosphor[y0][x0] = PHOSPHOR_MAX;
+
+        if(x0 == x1 && y0 == y1) break;
+
+        int e2 = 2 * err;
+        if(e2 >= dy){
+            err += dy;
+            x0 += step_x;
+        }
+        if(e2 <= dx){
+            err += dx;
+            y0 += step_y;
+        }
+    }
+}
+
 void SSD130X::WriteText(int pos, const char* text){
     display.SetCursor(2, 1+(pos*10));
     display.WriteString(text, Font_6x8, true);
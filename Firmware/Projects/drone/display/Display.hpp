@@ -2,11 +2,22 @@
 #include "dev/oled_ssd130x.h"
 #include <stdio.h>
 #include <string.h>
+#include <math.h>
 #include "../math/models.hpp"
+#include "projection.hpp"
 
 #define DISPLAY_ADDR 0x3C
 #define N_MODELS 5
 
+// Intensity of a freshly drawn phosphor pixel
+#define PHOSPHOR_MAX 255
+// Per-frame phosphor intensity multiplier, in 1/256 units (~1 s persistence at 30 fps)
+#define PHOSPHOR_DECAY 224
+// Rotation of the 3D view around the z axis, in radians per frame (~10 s per turn at 30 fps)
+#define VIEW_ROTATION_STEP 0.02f
+// Tilt of the 3D view around the screen x axis, in radians (0 = looking down the z axis)
+#define VIEW_TILT 1.0f
+
 using namespace daisy;
 
 // Retrieves empiric min and max values of a certain model
@@ -19,15 +30,22 @@ typedef struct model_borders {
 */
 enum class Displayed_Models {CHUA, SPROTT, ROSSLER, HALVORSEN, LORENTZ};
 
+// PLANE_XY plots the x/y plane, ROTATING_3D an orthographic projection of the slowly rotating attractor
+enum class PlotView {PLANE_XY, ROTATING_3D};
+
 class SSD130X {
     public:
         SSD130X() {};
         void InitDisplay();
         void setCurrentModel(Displayed_Models md); 
+        void setView(PlotView pv);
+        void setBorders(Displayed_Models md, model_borders_t border);
         void ClearAll();
         void ClearDisplay();
         void UpdateDisplay();
         void DrawPoint(math::vec3f state);
+        void DrawTrajectory(const math::vec3f *states, size_t count);
+        void RenderPhosphor();
         void WriteText(int pos, const char *text);
         void SelectText(int pos);
 
@@ -43,11 +61,39 @@ class SSD130X {
             "Halvorsen",
             "Lorentz"
         };
-        Displayed_Models model_number;
+        Displayed_Models model_number = Displayed_Models::CHUA;
 
         /** It must follow the order of the models defined in enum class Displayed_Models.
         * The values are assigned in InitDisplay() method, and it must not be modified.
         * To find the borders of a new model, use MinMaxFinder main code
         */
         model_borders_t borders[N_MODELS];
+
+        PlotView view = PlotView::PLANE_XY;
+
+        // Projection of the current model, updated by setCurrentModel()
+        plot_projection_t projection;
+
+        /** The 3D view matrix is updated once per frame by multiplying it with a constant rotation,
+        * so the only trigonometry happens in InitDisplay()
+        */
+        math::mat3f rotation = math::mat3f::identity();
+        math::mat3f rotation_step, tilt;
+        // Center and scale of the bounding sphere of the current model, for the 3D view
+        math::vec3f view_center;
+        float view_scale;
+        // Projection of the 3D view, updated every frame
+        view_projection_t view_projection;
+
+        /** Persistence buffer of the plot area: trajectories are drawn at PHOSPHOR_MAX
+        * and fade by PHOSPHOR_DECAY every frame, then get dithered to 1-bit by RenderPhosphor()
+        */
+        uint8_t phosphor[PLOT_SIZE][PLOT_SIZE] = {};
+
+        // Last plotted pixel, used to connect consecutive batches of the trajectory
+        int last_x = -1, last_y = -1;
+
+        void UpdateProjection();
+        void UpdateViewProjection();
+        void PlotSegment(int x0, int y0, int x1, int y1);
 };
@@ -2,6 +2,7 @@
 #include "daisysp.h"
 #include "Display.hpp"
 #include "../math/models.hpp"
+#include "../math/seed_tables.hpp"
 
 using namespace daisy;
 
@@ -31,7 +32,8 @@ int main(void)
     
     math::DiscretizedModel<math::Rossler> model({}, 0.01); // Change the object model here for model selection in the graph
     model.dt = 0.05f; // Speed of the model
-    math::vec3f state = math::vec3f{1.0, 1.0, -1.0};
+    math::vec3f state = math::model_seeds(model.model)[0];
+    math::vec3f batch[20];
 
     TimerHandle::Config config;
     config.dir = TimerHandle::Config::CounterDir::UP;
@@ -46,10 +48,12 @@ int main(void)
 
         for (int i = 0; i < 20; i++) {
             state = model.step(state);
-
-            display.DrawPoint(state);
+            batch[i] = state;
         }
 
+        display.DrawTrajectory(batch, 20);
+        display.RenderPhosphor();
+
         sprintf(coords[0], FLT_FMT(3), FLT_VAR(3,state.x()));
         sprintf(coords[1], FLT_FMT(3), FLT_VAR(3,state.y()));
 
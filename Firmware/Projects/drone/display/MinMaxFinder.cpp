@@ -2,6 +2,7 @@
 #include "daisysp.h"
 #include "Display.hpp"
 #include "../math/models.hpp"
+#include "../math/seed_tables.hpp"
 
 using namespace daisy;
 
@@ -46,7 +47,7 @@ int main(void)
 
     math::DiscretizedModel<math::Rossler> model({}, 0.01); // All models to test: Chua, Sprott, Rossler, Halvorsen, Lorentz
     model.dt = 0.01f;
-    math::vec3f state = math::vec3f{-1.0, -1.0, 1.0};
+    math::vec3f state = math::model_seeds(model.model)[0];
 
     TimerHandle::Config config;
     config.dir = TimerHandle::Config::CounterDir::UP;
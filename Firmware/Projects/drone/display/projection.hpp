@@ -0,0 +1,97 @@
+#pragma once
+
+#include <stdint.h>
+#include <math.h>
+#include "../math/vecmath.hpp"
+
+/* Fixed-point projections of the plot, free of hardware dependencies so that
+ * tools/display_bench.cpp can time them on host.
+ */
+
+// Side of the square plot area, in pixels
+#define PLOT_SIZE 64
+// Fractional bits used by the fixed-point plot projection
+#define PLOT_FRAC_BITS 16
+
+/** Precomputed projection from model coordinates to plot pixels:
+* pixel = ((int32_t)(coord * s) + o) >> PLOT_FRAC_BITS
+* It replaces the subtractions and divisions by the borders with a multiply-add per axis.
+*/
+typedef struct plot_projection {
+    float sx, sy;
+    int32_t ox, oy;
+} plot_projection_t;
+
+/** Projection used by the 3D view: the rows of the view matrix, premultiplied by the plot scale.
+* pixel = ((int32_t)dot(row, coords) + o) >> PLOT_FRAC_BITS
+*/
+typedef struct view_projection {
+    math::vec3f row_x, row_y;
+    int32_t ox, oy;
+} view_projection_t;
+
+/** Projects a state onto the x/y plane of the plot.
+* Returns false, leaving x and y untouched, if the state is not finite
+*/
+inline bool ProjectPlane(const plot_projection_t &projection, math::vec3f state, int &x, int &y){
+    // keeps diverging models from overflowing the fixed-point conversion
+    constexpr float limit = 1 << 30;
+
+    if(!math::is_finite(state.x()) || !math::is_finite(state.y())){
+        return false;
+    }
+
+    int32_t fx = static_cast<int32_t>(math::clamp(state.x() * projection.sx, -limit, limit));
+    int32_t fy = static_cast<int32_t>(math::clamp(state.y() * projection.sy, -limit, limit));
+
+    x = math::clamp<int32_t>((fx + projection.ox) >> PLOT_FRAC_BITS, 0, PLOT_SIZE - 1);
+    y = math::clamp<int32_t>((fy + projection.oy) >> PLOT_FRAC_BITS, 0, PLOT_SIZE - 1);
+    return true;
+}
+
+// Orthographic projection of a state through the 3D view; false if the state is not finite
+inline bool ProjectView(const view_projection_t &projection, math::vec3f state, int &x, int &y){
+    constexpr float limit = 1 << 30;
+
+    const math::vec3f &rx = projection.row_x, &ry = projection.row_y;
+    float px = rx.x() * state.x() + rx.y() * state.y() + rx.z() * state.z();
+    float py = ry.x() * state.x() + ry.y() * state.y() + ry.z() * state.z();
+
+    // any non-finite component propagates to both sums
+    if(!math::is_finite(px) || !math::is_finite(py)){
+        return false;
+    }
+
+    int32_t fx = static_cast<int32_t>(math::clamp(px, -limit, limit));
+    int32_t fy = static_cast<int32_t>(math::clamp(py, -limit, limit));
+
+    x = math::clamp<int32_t>((fx + projection.ox) >> PLOT_FRAC_BITS, 0, PLOT_SIZE - 1);
+    y = math::clamp<int32_t>((fy + projection.oy) >> PLOT_FRAC_BITS, 0, PLOT_SIZE - 1);
+    return true;
+}
+
+/** Projection of the 3D view for the accumulated rotation, once per frame.
+* The rotation is orthonormalized first (Gram-Schmidt), so that rounding errors do not build up.
+* center and scale fit the bounding sphere of the model into the plot.
+*/
+inline view_projection_t MakeViewProjection(math::mat3f &rotation, const math::mat3f &tilt,
+                                            math::vec3f center, float scale){
+    math::vec3f r0 = rotation[0], r1 = rotation[1];
+    r0 = r0 / sqrtf(r0.length_sq());
+    r1 = r1 - dot(r1, r0) * r0;
+    r1 = r1 / sqrtf(r1.length_sq());
+    rotation[0] = r0;
+    rotation[1] = r1;
+    rotation[2] = math::cross(r0, r1);
+
+    math::mat3f view_matrix = tilt * rotation;
+    view_projection_t projection;
+    projection.row_x = view_matrix[0] * scale;
+    projection.row_y = view_matrix[1] * scale;
+
+    // the center of the model goes to the center of the plot
+    constexpr int32_t plot_center = (PLOT_SIZE / 2) << PLOT_FRAC_BITS;
+    projection.ox = plot_center - static_cast<int32_t>(dot(projection.row_x, center));
+    projection.oy = plot_center - static_cast<int32_t>(dot(projection.row_y, center));
+    return projection;
+}
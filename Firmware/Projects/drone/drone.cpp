@@ -8,19 +8,28 @@
 #include <atomic>
 #include <daisy_seed.h>
 
+#include <algorithm>
 #include <array>
 #include <limits>
 
+#include "math/cic.hpp"
 #include "math/vecmath.hpp"
 // Chaotic models
-#include "math/chaos_osc.hpp"
-#include "math/models.hpp"
+#include "engine/gates.hpp"
+#include "engine/khaos_engine.hpp"
+#include "engine/record.hpp"
+#include "engine/snapshot.hpp"
 
+#include "display/Display.hpp"
 #include "hardware/digipot.hpp"
 #include "hardware/i2c_utils.hpp"
+#include "hardware/qspi_storage.hpp"
+#include "hardware/quadrature.hpp"
 
 #include "per/adc.h"
 #include "per/i2c.h"
+#include "sync/RingBuf.hpp"
+#include "sync/Scheduler.hpp"
 #include "sync/TriBuf.hpp"
 
 using namespace daisy;
@@ -30,17 +39,98 @@ constexpr bool DEBUG = true;
 constexpr const char *LOG_LABEL = "[Khaos-V]";
 constexpr std::array<const char *, 2> LOG_RESULT{"Error", "Success"};
 
-constexpr uint32_t INPUT_SAMPLE_RATE = 1;     // per second
+constexpr uint32_t INPUT_SAMPLE_RATE = 1;     // per second, without input changes
 constexpr uint32_t OUTPUT_SAMPLE_RATE = 100;  // per second
 constexpr uint32_t DISPLAY_REFRESH_RATE = 30; // per second
+constexpr uint32_t CONTROL_SAMPLE_RATE = 4000; // per second: CVs and encoders
+
+/// CV conditioning: CIC decimator of order CV_FILTER_ORDER, decimating by CV_DECIMATION.
+/// Filtered CVs are updated at CONTROL_SAMPLE_RATE / CV_DECIMATION per second (125 Hz).
+constexpr size_t CV_FILTER_ORDER = 2;
+constexpr uint32_t CV_DECIMATION = 32;
+/// Minimum change of a filtered CV to be forwarded, in 16-bit LSB: two PARAM_RESOLUTION steps.
+/// A CV at rest may be held up to this far off (about 10 mV, 12 cents on the rate input)
+constexpr uint16_t CV_HYSTERESIS = 128;
+/// Rate input, 1V/oct: CV1 plus encoder 1, CV_FULL_SCALE_VOLTS over the 16-bit range, sets the
+/// mean rotation frequency of every model, MODEL_BASE_FREQUENCY at 0 V (see math/freq_tables.hpp)
+constexpr float CV_FULL_SCALE_VOLTS = 5.0f;
+constexpr float MODEL_BASE_FREQUENCY = 0.05f; // Hz
 
 /// Number of samples stored in the output buffer
 constexpr size_t OUTPUT_BUFFER_SIZE = 128;
 
+/// Plot shown on the display
+constexpr PlotView DISPLAY_VIEW = PlotView::ROTATING_3D;
+/// Number of trajectory points plotted in each display frame
+constexpr size_t DISPLAY_POINTS_PER_FRAME = 32;
+/// Only one output sample out of TRAJECTORY_DECIMATION is sent to the display
+constexpr size_t TRAJECTORY_DECIMATION =
+    math::max<size_t>(1, OUTPUT_SAMPLE_RATE / (DISPLAY_REFRESH_RATE * DISPLAY_POINTS_PER_FRAME));
+/// Capacity of the trajectory feed; must be a power of two and hold a few frames
+constexpr size_t TRAJECTORY_BUFFER_SIZE = 128;
+
+/// Steps taken in the background by a newly selected model, to skip its transient
+constexpr size_t MODEL_PREROLL_STEPS = 2048;
+/// Maximum preroll steps per output block: bounds the extra cost of a model switch
+constexpr size_t MODEL_PREROLL_STEPS_PER_BLOCK = OUTPUT_BUFFER_SIZE;
+/// Length of the crossfade between the outgoing and the incoming model, in samples
+constexpr size_t MODEL_CROSSFADE_SAMPLES = 4 * OUTPUT_BUFFER_SIZE;
+
+constexpr KhaosEngineConfig ENGINE_CONFIG{OUTPUT_SAMPLE_RATE, OUTPUT_BUFFER_SIZE,
+                                          MODEL_PREROLL_STEPS, MODEL_PREROLL_STEPS_PER_BLOCK,
+                                          MODEL_CROSSFADE_SAMPLES};
+
+/// Fraction of the block period the output callback may spend rendering: beyond, the quality
+/// governor (engine/governor.hpp) trades the integration accuracy of the models for speed
+constexpr float RENDER_BUDGET = 0.5f;
+
+/// Poincaré sections of the normalized output driving the gates (LEDs): z rising through the
+/// middle, x changing lobe (with hysteresis against chatter), y rising through the upper half
+constexpr std::array<math::SectionConfig, 3> GATE_SECTIONS{{
+    {2, 0.0f, math::SectionDirection::RISING, 0.0f},
+    {0, 0.0f, math::SectionDirection::BOTH, 0.2f},
+    {1, 0.5f, math::SectionDirection::RISING, 0.0f},
+}};
+/// Length of the gate pulses, in output samples
+constexpr uint32_t GATE_PULSE_SAMPLES = 4;
+/// The control timer plays the gate edges (see engine/gates.hpp): they land within a tick of the
+/// interpolated crossings, 1/40 of an output sample (250 us)
+constexpr uint32_t GATE_TICKS_PER_SAMPLE = CONTROL_SAMPLE_RATE / OUTPUT_SAMPLE_RATE;
+
+/// Deadlines of the main loop tasks, relative to their release, in microseconds.
+/// Tasks are not preempted: a deadline must leave room for the longest other task (the display
+/// update, about 12 ms), see tools/scheduler_sim.cpp
+constexpr uint32_t INPUT_DEADLINE = 20000;
+constexpr uint32_t DISPLAY_DEADLINE = 1000000 / DISPLAY_REFRESH_RATE;
+constexpr uint32_t LOG_PERIOD = 20000;
+constexpr uint32_t LOG_DEADLINE = 50000;
+/// Period of the scheduler statistics in the log (DEBUG only)
+constexpr uint32_t SCHEDULER_STATS_PERIOD = 10000000;
+
+/// Snapshots of the session, restored at power-up (see engine/snapshot.hpp): taken every
+/// SNAPSHOT_PERIOD microseconds into the last 64 KiB of the QSPI flash. Each of its 16 sectors is
+/// erased once every 256 snapshots (slots of 256 bytes), about every 4 hours of use: 100k erase
+/// cycles last for decades.
+constexpr size_t SNAPSHOT_STORAGE_SIZE = 16 * QspiStorage::SECTOR_SIZE;
+constexpr size_t SNAPSHOT_STORAGE_BASE = QspiStorage::FLASH_SIZE - SNAPSHOT_STORAGE_SIZE;
+constexpr uint32_t SNAPSHOT_PERIOD = 60000000;
+/// One snapshot out of 16 erases a sector first, blocking the main loop for about 50 ms: the
+/// display skips a frame (see tools/scheduler_sim.cpp)
+constexpr uint32_t SNAPSHOT_DEADLINE = 1000000;
+
+/// Writes inputs and model changes to the log as `REC` lines, to replay them with tools/replay.cpp
+constexpr bool RECORD_EVENTS = DEBUG;
+/// Capacity of the record feed from the output callback; must be a power of two
+constexpr size_t RECORD_BUFFER_SIZE = 16;
+
 /// @brief Sets how many 'ticks' cover the full range.
 /// Controls the resolution for encoder-controlled parameters.
 constexpr uint16_t ROTARY_ENCODER_RESOLUTION = 32;
 constexpr size_t PARAM_RESOLUTION = 1024;
+/// Encoder acceleration: detents less than 60 ms apart take more steps, up to 32 steps per
+/// detent at 6 ms apart (about 170 detents per second)
+constexpr EncoderAcceleration ENCODER_ACCELERATION{CONTROL_SAMPLE_RATE * 60 / 1000,
+                                                   CONTROL_SAMPLE_RATE * 6 / 1000, 32};
 
 /* --- Definitions ------------------------------------------------------------------------------ */
 
@@ -52,10 +142,11 @@ struct KhaosInputData;
  * actual input data, as long as only one "process" updates it.
  */
 struct KhaosInput {
-    std::atomic_bool pending_refresh{false};
-
     AdcHandle adc;
-    std::array<Encoder, 4> encoders;
+    /// A and B lines of the encoders, sampled by control_timer_callback
+    std::array<std::array<GPIO, 2>, 4> encoder_pins;
+    /// Push switches of the encoders
+    std::array<Switch, 4> buttons;
 
     enum AdcChannels { ADC_CV0 = 0, ADC_CV1, ADC_NUM_CHANNELS };
 
@@ -70,9 +161,10 @@ struct KhaosInput {
  */
 struct KhaosOutput {
     DacHandle dac;
-    std::array<GPIO, 3> leds;
+    /// Gate outputs, one per Poincaré section
+    std::array<GPIO, GATE_SECTIONS.size()> leds;
 
-    /// @brief Initialize DAC channels
+    /// @brief Initialize LEDs and DAC channels
     void init();
 };
 
@@ -89,46 +181,115 @@ struct KhaosInputData {
     KhaosInputData();
 };
 
-// TODO: choose models
-struct KhaosModelData {
-    enum SelectedModel { ROSSLER = 0, NUM_MODELS } selected;
-    math::Rossler rossler;
+/// Clock of the main loop scheduler: microseconds of the system timer, sleeps until the next
+/// interrupt. Periodic releases are noticed at the next interrupt, at most 250 us later with the
+/// control timer running.
+struct KhaosClock {
+    uint32_t now() const { return System::GetUs(); }
+
+    template <class Ready> void sleep(Ready &&ready, uint32_t wake_time) {
+        // With interrupts masked, an interrupt raised after the check still ends the WFI and is
+        // served right after: a signal cannot be missed
+        __disable_irq();
+        if (!ready())
+            __WFI();
+        __enable_irq();
+    }
 };
 
+/// Tasks of the main loop, in the order they are added to the scheduler
+enum MainTask { TASK_INPUT = 0, TASK_DISPLAY, TASK_LOG, TASK_SNAPSHOT, TASK_STATS, NUM_TASKS };
+
 /// @brief Initializes timers
 void init_timers();
 
-void input_timer_callback(void *data);
+/// @brief Reads the inputs and maps them to model parameters
+void input_task(void *data);
+/// @brief Plots the trajectory produced since the last frame
+void display_task(void *data);
+/// @brief Logs model changes, watchdog reseeds and quality changes
+void log_task(void *data);
+/// @brief Saves the model data, oscillator states and encoder positions to the flash
+void snapshot_task(void *data);
+/// @brief Logs the CPU time and deadline misses of each task
+void stats_task(void *data);
+/// @brief Plays the gate edges, acquires and filters the CVs, decodes the encoders, then requests
+/// an input refresh when any of them changed
+void control_timer_callback(void *data);
+/// @brief Hands a snapshot of the model data over to output_dma_callback
+void publish_model_data(const KhaosModelData &data);
 void output_dma_callback(uint16_t **out, size_t size);
-void display_refresh_callback(void *data);
+/// @brief Logs an event as a `REC` line
+void log_record(DaisySeed &hw, const RecordEvent &event);
 
 // /// @brief Initialized chaotic models with default parameters
 // void init_chaotic_models();
 
 /* --- Global variables ------------------------------------------------------------------------- */
 
-/// TIM3: 16-bit timer
-TimerHandle input_timer;
-/// TIM4: 16-bit timer
-TimerHandle display_timer;
+/// TIM5: 32-bit timer
+TimerHandle control_timer;
+
+static DaisySeed hw;
+static KhaosClock main_clock;
+static Scheduler<KhaosClock, NUM_TASKS> scheduler(main_clock); // owner: main
+
+// Needed to maintain a persistent state, even if the reader loses some updates
+static KhaosInputData input_data; // owner: main
+// Same for the model data: after a swap the writer side of the TriBuf holds stale data
+static KhaosModelData model_params; // owner: main
 
 static KhaosInput input;
+/// Filtered CVs; written by control_timer_callback, read by main
+static std::array<std::atomic<uint16_t>, KhaosInput::ADC_NUM_CHANNELS> cv_values;
+/// Encoder steps; accumulated by control_timer_callback, read by main
+static std::array<EncoderCounter, 4> encoder_counters{
+    EncoderCounter(ENCODER_ACCELERATION), EncoderCounter(ENCODER_ACCELERATION),
+    EncoderCounter(ENCODER_ACCELERATION), EncoderCounter(ENCODER_ACCELERATION)};
 static KhaosOutput output;
 
 static TriBuf<KhaosModelData> model_data;
 static TriBuf<KhaosModelData>::Writer model_data_writer; // owner: main
 static TriBuf<KhaosModelData>::Reader model_data_reader; // owner: output_dma_callback
 
+/// Owner: main until output.init(), then output_dma_callback
+static KhaosEngine engine(ENGINE_CONFIG);
+
+/// Oscillator states, published by output_dma_callback for the snapshots
+static TriBuf<KhaosEngineState> engine_state;
+static TriBuf<KhaosEngineState>::Writer engine_state_writer; // owner: output_dma_callback
+static TriBuf<KhaosEngineState>::Reader engine_state_reader; // owner: main
+
+static QspiStorage snapshot_storage(hw.qspi, SNAPSHOT_STORAGE_BASE, SNAPSHOT_STORAGE_SIZE);
+static SnapshotLog<KhaosSnapshot> snapshots(snapshot_storage); // owner: main
+
 static std::array<std::array<uint16_t, OUTPUT_BUFFER_SIZE>, 2> output_buf;
 
-/* --- Main code -------------------------------------------------------------------------------- */
+using Gates = KhaosGates<GATE_SECTIONS.size(), OUTPUT_BUFFER_SIZE>;
+/// Gate triggers of the block starting on the DAC, from output_dma_callback to
+/// control_timer_callback
+static TriBuf<Gates::Schedule> gate_schedule;
+static TriBuf<Gates::Schedule>::Writer gate_schedule_writer; // owner: output_dma_callback
+static TriBuf<Gates::Schedule>::Reader gate_schedule_reader; // owner: control_timer_callback
 
-int main() {
-    DaisySeed hw;
+static SSD130X display; // owner: main
+/// Decimated states produced by output_dma_callback, plotted by main
+static RingBuf<math::vec3f, TRAJECTORY_BUFFER_SIZE> trajectory;
+
+/// Watchdog reseeds of each model; written by output_dma_callback, logged by main
+static std::array<std::atomic<uint32_t>, KhaosModelData::NUM_MODELS> model_reseeds;
 
-    // Needed to maintain a persistent state, even if the reader loses some updates
-    KhaosInputData input_data;
+/// Quality level of each model; written by output_dma_callback, logged by main
+static std::array<std::atomic<uint32_t>, KhaosModelData::NUM_MODELS> model_quality;
+
+/// Output frames rendered so far; written by output_dma_callback
+static std::atomic<uint32_t> rendered_frames{0};
+/// Model changes applied by output_dma_callback, logged by main
+static RingBuf<RecordEvent, RECORD_BUFFER_SIZE> records;
+
+/* --- Main code -------------------------------------------------------------------------------- */
 
+int main() {
     hw.Init();
     hw.StartLog(DEBUG);
     hw.PrintLine("%s Starting initialization...", LOG_LABEL);
@@ -138,12 +299,40 @@ int main() {
     // has access to one of these at any time
     model_data_writer = model_data.get_writer();
     model_data_reader = model_data.get_reader();
+    engine_state_writer = engine_state.get_writer();
+    engine_state_reader = engine_state.get_reader();
+    gate_schedule_writer = gate_schedule.get_writer();
+    gate_schedule_reader = gate_schedule.get_reader();
 
     hw.PrintLine("%s Acquired TriBuf handles", LOG_LABEL);
 
-    // input.init();
-    // output.init();
+    // Render cost, measured in ticks of the system timer
+    GovernorConfig governor;
+    uint64_t block_ticks =
+        static_cast<uint64_t>(System::GetTickFreq()) * OUTPUT_BUFFER_SIZE / OUTPUT_SAMPLE_RATE;
+    governor.budget = static_cast<uint32_t>(
+        math::min<uint64_t>(block_ticks * RENDER_BUDGET, std::numeric_limits<uint32_t>::max()));
+    engine.set_governor(governor);
+
+    // Resume the previous session before the output starts: the oscillators are already on
+    // their attractors, no preroll needed
+    KhaosSnapshot snapshot;
+    bool resumed = snapshots.load(snapshot);
+    if (resumed) {
+        model_params = snapshot.model_data;
+        input_data.encoder_values = snapshot.encoder_values;
+        engine.resume(model_params, snapshot.engine_state);
+        hw.PrintLine("%s Resumed snapshot %lu", LOG_LABEL,
+                     static_cast<unsigned long>(snapshots.get_sequence()));
+    } else {
+        hw.PrintLine("%s No snapshot found, starting from the seeds", LOG_LABEL);
+    }
+
+    // The control timer samples the ADC and the encoder pins: they must be set up first
+    input.init();
     init_timers();
+    // The engine is set up (and resumed): the output callback may start rendering
+    output.init();
 
     hw.PrintLine("%s Successfully initialized peripherals", LOG_LABEL);
 
@@ -164,6 +353,14 @@ int main() {
         goto bad_init;
     }
 
+    display.InitDisplay();
+    // the display is fed with normalized outputs
+    for (size_t i = 0; i < KhaosModelData::NUM_MODELS; i++) {
+        display.setBorders(static_cast<Displayed_Models>(i), {1.0f, -1.0f, 1.0f, -1.0f, 1.0f, -1.0f});
+    }
+    display.setCurrentModel(Displayed_Models::ROSSLER);
+    display.setView(DISPLAY_VIEW);
+
     // Tasks:
     // - read input
     // - propagate parameters to chaotic oscillators
@@ -172,37 +369,47 @@ int main() {
 
     hw.PrintLine("%s System initialized successfully", LOG_LABEL);
 
-    while (true) {
-        bool expected_pending = true;
-
-        // Process input data if new data is available
-        if (input.pending_refresh.compare_exchange_strong(expected_pending, false, std::memory_order_relaxed)) {
-            input.refresh(input_data);
-
-            std::array<uint16_t, 2> params;
-
-            for (size_t i = 0; i < 2; i++) {
-                int32_t raw_value = static_cast<int32_t>(input_data.cvs[i]) +
-                                    static_cast<int32_t>(input_data.encoder_values[i]);
-
-                constexpr uint16_t max_value = std::numeric_limits<uint16_t>::max();
+    if (RECORD_EVENTS) {
+        log_record(hw,
+                   RecordEvent(0, RecordType::CONFIG, 0, &ENGINE_CONFIG, sizeof(ENGINE_CONFIG)));
+
+        // The replay starts from the restored state too
+        for (size_t i = 0; resumed && i < KhaosModelData::NUM_MODELS; i++) {
+            auto index = static_cast<uint8_t>(i);
+            KhaosModelData::visit_params(model_params, i, [&](const auto &params) {
+                log_record(hw, RecordEvent(0, RecordType::PARAMS, index, &params, sizeof(params)));
+            });
+            const math::vec3f &state = snapshot.engine_state.states[i];
+            log_record(hw, RecordEvent(0, RecordType::STATE, index, &state, sizeof(state)));
+        }
+        if (resumed) {
+            log_record(hw, RecordEvent(0, RecordType::SELECT,
+                                       static_cast<uint8_t>(model_params.selected)));
+            log_record(hw, RecordEvent(0, RecordType::FREQUENCY, 0, &model_params.frequency,
+                                       sizeof(model_params.frequency)));
+        }
+    }
 
-                params[i] = static_cast<uint16_t>(math::clamp<int32_t>(raw_value, 0, max_value));
-            }
+    // Outputs and inputs run in interrupts; everything else runs here, in these tasks
+    scheduler.add("input", input_task, nullptr, 1000000 / INPUT_SAMPLE_RATE, INPUT_DEADLINE);
+    scheduler.add("display", display_task, nullptr, 1000000 / DISPLAY_REFRESH_RATE,
+                  DISPLAY_DEADLINE);
+    scheduler.add("log", log_task, nullptr, LOG_PERIOD, LOG_DEADLINE);
+    scheduler.add("snapshot", snapshot_task, nullptr, SNAPSHOT_PERIOD, SNAPSHOT_DEADLINE);
+    scheduler.add("stats", stats_task, nullptr, DEBUG ? SCHEDULER_STATS_PERIOD : 0,
+                  SCHEDULER_STATS_PERIOD);
 
-            // TODO: map params to model-specific (float) parameters
-            // m_data.remap_params(...);
-            // model_data_writer.swap();
-        }
+    while (true) {
+        scheduler.run_once();
     }
 
 bad_init:
     hw.SetLed(true);
     hw.PrintLine("%s Something went wrong during the initialization", LOG_LABEL);
 
-    // output.dac.Stop();
-    // display_timer.DeInit();
-    // input_timer.DeInit();
+    output.dac.Stop();
+    control_timer.DeInit();
+    input.adc.Stop();
 
     hw.PrintLine("%s System shut down", LOG_LABEL);
     hw.DeInit();
@@ -218,24 +425,30 @@ void KhaosInput::init() {
     // Setup Control Voltages
     adc_config[AdcChannels::ADC_CV0].InitSingle(seed::A0);
     adc_config[AdcChannels::ADC_CV1].InitSingle(seed::A1);
+    // Continuous DMA conversions, oversampled in hardware; filtered by control_timer_callback
     adc.Init(adc_config.data(), adc_config.size());
     adc.Start();
 
-    encoders[0].Init(seed::D17, seed::D18, seed::D24); // input 1
-    encoders[1].Init(seed::D19, seed::D20, seed::D25); // input 2
-
-    // selezione modello: analog1, analog2 o digital
-    encoders[2].Init(seed::D2, seed::D3, seed::D26);
-
-    // selezione modello: quale digitale?
-    encoders[3].Init(seed::D13, seed::D14, seed::D27);
+    // Encoders: A, B, push switch
+    constexpr std::array<std::array<Pin, 3>, 4> encoder_config{{
+        {seed::D17, seed::D18, seed::D24}, // input 1
+        {seed::D19, seed::D20, seed::D25}, // input 2
+        {seed::D2, seed::D3, seed::D26},   // selezione modello: analog1, analog2 o digital
+        {seed::D13, seed::D14, seed::D27}, // selezione modello: quale digitale?
+    }};
+
+    for (size_t i = 0; i < encoder_config.size(); i++) {
+        encoder_pins[i][0].Init(encoder_config[i][0], GPIO::Mode::INPUT, GPIO::Pull::PULLUP);
+        encoder_pins[i][1].Init(encoder_config[i][1], GPIO::Mode::INPUT, GPIO::Pull::PULLUP);
+        buttons[i].Init(encoder_config[i][2]);
+    }
 }
 
 void KhaosInput::refresh(KhaosInputData &data) {
     /* Encoders */
-    for (size_t i = 0; i < input.encoders.size(); i++) {
-        input.encoders[i].Debounce();
-        int32_t increment = input.encoders[i].Increment();
+    for (size_t i = 0; i < encoder_counters.size(); i++) {
+        // Decoded in control_timer_callback: steps since the last refresh, accelerated
+        int32_t increment = encoder_counters[i].read_increment();
 
         int32_t new_value =
             static_cast<int32_t>(data.encoder_values[i]) +
@@ -256,26 +469,16 @@ void KhaosInput::refresh(KhaosInputData &data) {
         // TODO: change to FallingEdge; do not save switch data directly,
         // (falling edges may be lost due to how TripleBuffer works),
         // but rather select here which chaotic model to use
-        data.switches[i] = input.encoders[i].Pressed();
+        input.buttons[i].Debounce();
+        data.switches[i] = input.buttons[i].Pressed();
     }
 
     /* Control Voltages */
-    data.cvs[0] = input.adc.Get(KhaosInput::ADC_CV0);
-    data.cvs[1] = input.adc.Get(KhaosInput::ADC_CV1);
+    data.cvs[0] = cv_values[KhaosInput::ADC_CV0].load(std::memory_order_relaxed);
+    data.cvs[1] = cv_values[KhaosInput::ADC_CV1].load(std::memory_order_relaxed);
 }
 
 void KhaosOutput::init() {
-    // DAC configuration
-    DacHandle::Config dac_config;
-    dac_config.chn = DacHandle::Channel::BOTH;
-    dac_config.buff_state = DacHandle::BufferState::DISABLED;
-    dac_config.bitdepth = DacHandle::BitDepth::BITS_12;
-    dac_config.mode = DacHandle::Mode::DMA;
-    dac_config.target_samplerate = OUTPUT_SAMPLE_RATE;
-    dac.Init(dac_config);
-    dac.Start(output_buf[0].data(), output_buf[1].data(), output_buf[0].size(),
-              output_dma_callback);
-
     // LED configuration
     GPIO::Config led_config;
     led_config.mode = GPIO::Mode::OUTPUT;
@@ -288,6 +491,17 @@ void KhaosOutput::init() {
 
     led_config.pin = seed::D6;
     leds[2].Init(led_config);
+
+    // DAC configuration, last: its callback schedules the LED edges
+    DacHandle::Config dac_config;
+    dac_config.chn = DacHandle::Channel::BOTH;
+    dac_config.buff_state = DacHandle::BufferState::DISABLED;
+    dac_config.bitdepth = DacHandle::BitDepth::BITS_12;
+    dac_config.mode = DacHandle::Mode::DMA;
+    dac_config.target_samplerate = OUTPUT_SAMPLE_RATE;
+    dac.Init(dac_config);
+    dac.Start(output_buf[0].data(), output_buf[1].data(), output_buf[0].size(),
+              output_dma_callback);
 }
 
 KhaosInputData::KhaosInputData() {
@@ -300,52 +514,280 @@ KhaosInputData::KhaosInputData() {
 void init_timers() {
     TimerHandle::Config config;
 
-    /* Input management timer */
+    /* Control (CV and encoder) sampling timer */
     config.dir = TimerHandle::Config::CounterDir::UP;
     config.enable_irq = true; // needed for user callback
-    config.periph = TimerHandle::Config::Peripheral::TIM_3;
-    input_timer.Init(config);
-    input_timer.SetCallback(input_timer_callback);
-    input_timer.SetPrescaler(3999); // avoids overflow since the timer is 16-bit
-    input_timer.SetPeriod(input_timer.GetFreq() / INPUT_SAMPLE_RATE);
-    input_timer.Start();
-
-    /* Output management timer */
-    config.dir = TimerHandle::Config::CounterDir::UP;
-    config.enable_irq = true; // needed for user callback
-    config.periph = TimerHandle::Config::Peripheral::TIM_4;
-    display_timer.Init(config);
-    display_timer.SetCallback(display_refresh_callback);
-    display_timer.SetPrescaler(3999); // avoids overflow since the timer is 16-bit
-    display_timer.SetPeriod(input_timer.GetFreq() / DISPLAY_REFRESH_RATE);
-    display_timer.Start();
+    config.periph = TimerHandle::Config::Peripheral::TIM_5;
+    control_timer.Init(config);
+    control_timer.SetCallback(control_timer_callback);
+    control_timer.SetPrescaler(0); // 32-bit: full resolution for the kHz rate
+    control_timer.SetPeriod(control_timer.GetFreq() / CONTROL_SAMPLE_RATE);
+    control_timer.Start();
 }
 
-void input_timer_callback(void *data) {
-    input.pending_refresh.store(true, std::memory_order_relaxed);
+void control_timer_callback(void *data) {
+    using CvFilter = math::CvFilter<CV_FILTER_ORDER, CV_DECIMATION>;
+    static std::array<CvFilter, KhaosInput::ADC_NUM_CHANNELS> filters{
+        CvFilter(CV_HYSTERESIS), CvFilter(CV_HYSTERESIS)};
+    static Gates::Pulses gate_pulses(GATE_PULSE_SAMPLES * GATE_TICKS_PER_SAMPLE);
+    static uint32_t gate_mask = 0;
+    static bool started = false;
+    static uint32_t tick = 0;
+    tick++;
+
+    // Gates, first for a steady timing: a schedule starts with its block on the DAC. Only
+    // changes are written, so the LEDs are not touched before the DAC starts
+    if (gate_schedule_reader.try_swap())
+        gate_pulses.start(gate_schedule_reader.data());
+    uint32_t gates = gate_pulses.tick();
+    if (gates != gate_mask) {
+        gate_mask = gates;
+        for (size_t i = 0; i < output.leds.size(); i++)
+            output.leds[i].Write(gates & (1u << i));
+    }
+
+    // Encoders, sampled fast enough to see every transition (see hardware/quadrature.hpp)
+    bool changed = false;
+    for (size_t i = 0; i < encoder_counters.size(); i++) {
+        changed |= encoder_counters[i].process(input.encoder_pins[i][0].Read(),
+                                               input.encoder_pins[i][1].Read(), tick);
+    }
+
+    // The ADC converts continuously into its DMA buffer; Get() reads the latest conversion
+    if (!started) {
+        started = true;
+        for (size_t i = 0; i < filters.size(); i++) {
+            filters[i].reset(input.adc.Get(i));
+            cv_values[i].store(filters[i].get(), std::memory_order_relaxed);
+        }
+        return;
+    }
+
+    for (size_t i = 0; i < filters.size(); i++) {
+        if (filters[i].process(input.adc.Get(i))) {
+            cv_values[i].store(filters[i].get(), std::memory_order_relaxed);
+            changed = true;
+        }
+    }
+
+    // New values reach the models without waiting for the next input period
+    if (changed)
+        scheduler.signal(TASK_INPUT);
+}
+
+void publish_model_data(const KhaosModelData &data) {
+    model_data_writer.data() = data;
+    model_data_writer.swap();
 }
 
 void output_dma_callback(uint16_t **out, size_t size) {
-    static ChaosOsc<math::Rossler> rossler(math::Rossler{}, math::vec3f{1.0f, 1.0f, 1.0f},
-                                           static_cast<float>(OUTPUT_SAMPLE_RATE), 1.0f);
-    // TODO: other models...
+    static std::array<math::vec3f, OUTPUT_BUFFER_SIZE> block;
+    static size_t decimation_counter = 0;
+    static KhaosModelData::SelectedModel selected = KhaosModelData{}.selected;
+    static float frequency = KhaosModelData{}.frequency;
+    static Gates gates(GATE_SECTIONS, GATE_TICKS_PER_SAMPLE);
+
+    uint32_t frame = rendered_frames.load(std::memory_order_relaxed);
 
     // Use new data to change model parameters
     if (model_data_reader.try_swap()) {
         auto &data = model_data_reader.data();
+        uint32_t changed = engine.set_model_data(data);
+
+        if (RECORD_EVENTS) {
+            for (size_t i = 0; i < KhaosModelData::NUM_MODELS; i++) {
+                if (changed & (1u << i)) {
+                    KhaosModelData::visit_params(data, i, [&](const auto &params) {
+                        records.push(RecordEvent(frame, RecordType::PARAMS,
+                                                 static_cast<uint8_t>(i), &params, sizeof(params)));
+                    });
+                }
+            }
+            if (data.selected != selected) {
+                records.push(RecordEvent(frame, RecordType::SELECT,
+                                         static_cast<uint8_t>(data.selected)));
+            }
+            if (data.frequency != frequency) {
+                records.push(RecordEvent(frame, RecordType::FREQUENCY, 0, &data.frequency,
+                                         sizeof(data.frequency)));
+            }
+        }
+        selected = data.selected;
+        frequency = data.frequency;
+    }
 
-        rossler.set_model(data.rossler);
+    // Generate output samples, prerolling and crossfading a newly selected model
+    size = math::min(size, block.size());
+    uint32_t start = System::GetTick();
+    uint32_t reseeded = engine.render(block.data(), size);
+    // Integration quality of the next blocks, from the cost of this one
+    uint32_t requalified = engine.govern(System::GetTick() - start);
+
+    for (size_t i = 0; i < KhaosModelData::NUM_MODELS; i++) {
+        if (requalified & (1u << i)) {
+            auto level = static_cast<uint8_t>(engine.get_quality_level(i));
+            model_quality[i].store(level, std::memory_order_relaxed);
+            if (RECORD_EVENTS) {
+                records.push(RecordEvent(frame + size, RecordType::QUALITY,
+                                         static_cast<uint8_t>(i), &level, sizeof(level)));
+            }
+        }
+    }
+
+    for (size_t i = 0; i < KhaosModelData::NUM_MODELS; i++) {
+        if (reseeded & (1u << i)) {
+            model_reseeds[i].store(model_reseeds[i].load(std::memory_order_relaxed) + 1,
+                                   std::memory_order_relaxed);
+        }
     }
 
-    // Generate output samples
-    // TODO: remap model values; choose which model; etc...
     for (size_t i = 0; i < size; i++) {
-        math::vec3f state = rossler.step();
-        out[0][i] = state.x();
-        out[1][i] = state.y();
+        const math::vec3f &state = block[i];
+        out[0][i] = to_dac(state.x());
+        out[1][i] = to_dac(state.y());
+
+        // Feed the display with exactly what is being output; a full feed drops points
+        if (++decimation_counter == TRAJECTORY_DECIMATION) {
+            decimation_counter = 0;
+            trajectory.push(state);
+        }
+    }
+
+    // The block rendered by the previous call starts playing now (the DAC plays one buffer half
+    // while the other is filled): its gate schedule starts with it
+    gate_schedule_writer.swap();
+    gates.process(block.data(), size, gate_schedule_writer.data());
+
+    engine_state_writer.data() = engine.get_state();
+    engine_state_writer.swap();
+
+    rendered_frames.store(frame + size, std::memory_order_relaxed);
+}
+
+void log_record(DaisySeed &hw, const RecordEvent &event) {
+    char hex[RECORD_HEX_SIZE];
+    record_encode(event, hex);
+    hw.PrintLine("%s%s", RECORD_PREFIX, hex);
+}
+
+void input_task(void *data) {
+    input.refresh(input_data);
+
+    if (RECORD_EVENTS) {
+        static RecordedInput last_recorded{};
+        RecordedInput recorded{};
+        for (size_t i = 0; i < 4; i++) {
+            recorded.encoder_values[i] = input_data.encoder_values[i];
+            recorded.switches |= static_cast<uint8_t>(input_data.switches[i]) << i;
+        }
+        recorded.cvs[0] = input_data.cvs[0];
+        recorded.cvs[1] = input_data.cvs[1];
+
+        if (memcmp(&recorded, &last_recorded, sizeof(recorded)) != 0) {
+            last_recorded = recorded;
+            log_record(hw, RecordEvent(rendered_frames.load(std::memory_order_relaxed),
+                                       RecordType::INPUT, 0, &recorded, sizeof(recorded)));
+        }
     }
+
+    std::array<uint16_t, 2> params;
+
+    for (size_t i = 0; i < 2; i++) {
+        int32_t raw_value = static_cast<int32_t>(input_data.cvs[i]) +
+                            static_cast<int32_t>(input_data.encoder_values[i]);
+
+        constexpr uint16_t max_value = std::numeric_limits<uint16_t>::max();
+
+        params[i] = static_cast<uint16_t>(math::clamp<int32_t>(raw_value, 0, max_value));
+    }
+
+    // The rate input: the engine keeps the frequency when the parameters change
+    constexpr float volts_per_lsb = CV_FULL_SCALE_VOLTS / std::numeric_limits<uint16_t>::max();
+    float frequency = math::volts_to_frequency(params[1] * volts_per_lsb, MODEL_BASE_FREQUENCY);
+    if (frequency != model_params.frequency) {
+        model_params.frequency = frequency;
+        publish_model_data(model_params);
+    }
+
+    // TODO: map params[0] to model-specific (float) parameters, e.g.
+    // model_params.rossler.c = ...;
+    // model_params.touch(KhaosModelData::ROSSLER);
+    // publish_model_data(model_params);
 }
 
-void display_refresh_callback(void *data) {
-    // TODO: ...
+void display_task(void *data) {
+    static std::array<math::vec3f, TRAJECTORY_BUFFER_SIZE> points;
+    size_t count = trajectory.pop(points.data(), points.size());
+
+    display.ClearDisplay();
+    display.DrawTrajectory(points.data(), count);
+    display.RenderPhosphor();
+    display.UpdateDisplay();
+}
+
+void log_task(void *data) {
+    // Model changes, in the order they were applied
+    RecordEvent event;
+    while (records.pop(&event, 1)) {
+        log_record(hw, event);
+    }
+
+    // Telemetry
+    static std::array<uint32_t, KhaosModelData::NUM_MODELS> logged_reseeds{};
+    static std::array<uint32_t, KhaosModelData::NUM_MODELS> logged_quality{};
+    for (size_t i = 0; i < KhaosModelData::NUM_MODELS; i++) {
+        uint32_t reseeds = model_reseeds[i].load(std::memory_order_relaxed);
+        uint32_t quality = model_quality[i].load(std::memory_order_relaxed);
+
+        if (reseeds != logged_reseeds[i]) {
+            logged_reseeds[i] = reseeds;
+            hw.PrintLine("%s Model %u reseeded by the watchdog (%lu total)", LOG_LABEL,
+                         static_cast<unsigned>(i), static_cast<unsigned long>(reseeds));
+        }
+        if (quality != logged_quality[i]) {
+            logged_quality[i] = quality;
+            hw.PrintLine("%s Model %u integrated at quality level %lu", LOG_LABEL,
+                         static_cast<unsigned>(i), static_cast<unsigned long>(quality));
+        }
+    }
+}
+
+void snapshot_task(void *data) {
+    // Nothing rendered yet: the flash already holds these states
+    if (!engine_state_reader.try_swap())
+        return;
+
+    KhaosSnapshot snapshot;
+    snapshot.model_data = model_params;
+    snapshot.engine_state = engine_state_reader.data();
+    snapshot.encoder_values = input_data.encoder_values;
+
+    if (!snapshots.save(snapshot))
+        hw.PrintLine("%s Could not save the snapshot", LOG_LABEL);
+}
+
+void stats_task(void *data) {
+    static uint32_t last_time = main_clock.now();
+    static uint64_t last_idle = 0;
+
+    uint32_t now = main_clock.now();
+    uint64_t idle = scheduler.idle_time();
+    uint32_t elapsed = now - last_time;
+    // On the first call the idle time counts from boot, and may exceed the elapsed time
+    uint64_t idle_delta = std::min<uint64_t>(idle - last_idle, elapsed);
+    unsigned load = elapsed ? static_cast<unsigned>(100 - 100 * idle_delta / elapsed) : 0;
+    last_time = now;
+    last_idle = idle;
+
+    // Interrupts count as busy time
+    hw.PrintLine("%s Main loop busy %u%%", LOG_LABEL, load);
+    for (size_t i = 0; i < scheduler.size(); i++) {
+        const auto &stats = scheduler.stats(i);
+        hw.PrintLine("%s   %-8s runs %lu  misses %lu  skipped %lu  max %lu us  response %lu us",
+                     LOG_LABEL, scheduler.name(i), static_cast<unsigned long>(stats.runs),
+                     static_cast<unsigned long>(stats.misses),
+                     static_cast<unsigned long>(stats.skipped),
+                     static_cast<unsigned long>(stats.max_time),
+                     static_cast<unsigned long>(stats.max_response));
+    }
 }
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "../math/section.hpp"
+#include "../math/vecmath.hpp"
+
+template <size_t N, size_t MAX_TRIGGERS> class GatePulses;
+
+/// @brief Crossings of the Poincaré sections during one output block, in ticks of the gate clock
+/// from the start of the block, in increasing order
+template <size_t MAX_TRIGGERS> struct GateSchedule {
+    struct Trigger {
+        uint32_t tick;
+        uint32_t gate;
+    };
+
+    std::array<Trigger, MAX_TRIGGERS> triggers;
+    size_t count = 0;
+};
+
+/**
+ * Trigger/gate outputs derived from the rendered states: gate `i` fires each time the trajectory
+ * crosses Poincaré section `i`.
+ * Sections are defined on the normalized output, so they hold for every model and across
+ * crossfades.
+ *
+ * A crossing between samples `n - 1` and `n` of a block, at the interpolated position `p`, is
+ * scheduled at `n + p` samples from the start of the block, in ticks of a clock faster than the
+ * output (the gate clock, see GatePulses): one sample after the crossing itself, so that a gate
+ * never rises before the step of the DAC that crosses the section, and so that a crossing just
+ * before the first sample of a block still falls within it.
+ *
+ * @tparam N number of sections (gates)
+ * @tparam MAX_BLOCK_SIZE maximum number of samples of a block
+ */
+template <size_t N, size_t MAX_BLOCK_SIZE> class KhaosGates {
+  public:
+    static_assert(N <= 32, "gates are played as a 32-bit mask");
+
+    /// Every sample may cross every section
+    using Schedule = GateSchedule<N * MAX_BLOCK_SIZE>;
+    using Pulses = GatePulses<N, N * MAX_BLOCK_SIZE>;
+
+    /// @param ticks_per_sample ticks of the gate clock per output sample
+    KhaosGates(const std::array<math::SectionConfig, N> &sections, uint32_t ticks_per_sample)
+        : ticks_per_sample(static_cast<float>(ticks_per_sample)) {
+        for (size_t i = 0; i < N; i++)
+            detectors[i] = math::SectionDetector<math::vec3f>(sections[i]);
+    }
+
+    /// @brief Feeds a block of output samples (at most MAX_BLOCK_SIZE), and lists its crossings
+    /// in `schedule`
+    void process(const math::vec3f *block, size_t size, Schedule &schedule) {
+        schedule.count = 0;
+        for (size_t n = 0; n < size; n++) {
+            for (size_t i = 0; i < N; i++) {
+                float position = detectors[i].process(block[n]);
+                if (position < 0.0f)
+                    continue;
+                crossings[i]++;
+                auto tick = static_cast<uint32_t>((n + position) * ticks_per_sample + 0.5f);
+                // Crossings of different sections within a sample interval come in any order
+                size_t k = schedule.count++;
+                for (; k > 0 && schedule.triggers[k - 1].tick > tick; k--)
+                    schedule.triggers[k] = schedule.triggers[k - 1];
+                schedule.triggers[k] = {tick, static_cast<uint32_t>(i)};
+            }
+        }
+    }
+
+    /// @brief Crossings of section `i` so far
+    uint32_t get_crossings(size_t i) const { return crossings[i]; }
+
+  private:
+    float ticks_per_sample;
+    std::array<math::SectionDetector<math::vec3f>, N> detectors;
+    std::array<uint32_t, N> crossings{};
+};
+
+/**
+ * Plays the schedules of KhaosGates as pulses of fixed length, one tick of the gate clock at a
+ * time: a schedule starts when its block starts playing on the DAC. A crossing during a pulse
+ * extends it.
+ * Triggers the previous schedule had not played yet (its block ended early on the gate clock)
+ * fire when the next one starts: a crossing is late by at most the drift, never lost.
+ *
+ * @tparam N number of gates
+ * @tparam MAX_TRIGGERS capacity of the schedules
+ */
+template <size_t N, size_t MAX_TRIGGERS> class GatePulses {
+  public:
+    /// @param pulse_ticks length of the pulses, in ticks of the gate clock (at least 1)
+    explicit GatePulses(uint32_t pulse_ticks) : pulse_ticks(pulse_ticks > 0 ? pulse_ticks : 1) {}
+
+    /// @brief Starts playing `next` from the current tick. It is copied: the caller may reuse it
+    void start(const GateSchedule<MAX_TRIGGERS> &next) {
+        for (; played < schedule.count; played++)
+            remaining[schedule.triggers[played].gate] = pulse_ticks;
+        schedule.count = next.count;
+        for (size_t k = 0; k < next.count; k++)
+            schedule.triggers[k] = next.triggers[k];
+        played = 0;
+        elapsed = 0;
+    }
+
+    /**
+     * @brief Advances by one tick of the gate clock.
+     * @return bitmask of the gates high during this tick
+     */
+    uint32_t tick() {
+        for (; played < schedule.count && schedule.triggers[played].tick <= elapsed; played++)
+            remaining[schedule.triggers[played].gate] = pulse_ticks;
+        elapsed++;
+
+        uint32_t gates = 0;
+        for (size_t i = 0; i < N; i++) {
+            if (remaining[i] > 0) {
+                remaining[i]--;
+                gates |= 1u << i;
+            }
+        }
+        return gates;
+    }
+
+  private:
+    uint32_t pulse_ticks;
+    GateSchedule<MAX_TRIGGERS> schedule;
+    size_t played = 0;
+    /// Ticks since the start of the schedule
+    uint32_t elapsed = 0;
+    std::array<uint32_t, N> remaining{};
+};
@@ -0,0 +1,159 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+/// Integration settings of an oscillator, from the most accurate to the cheapest
+struct QualityLevel {
+    /// Maximum time step, relative to the nominal one
+    float dt_scale;
+    /// Hard bound on the integration steps per output sample (see ChaosOsc::step())
+    uint32_t max_steps_per_sample;
+};
+
+struct GovernorConfig {
+    /// Cost allowed per block, in the unit of the measurements (e.g. timer ticks); 0 disables
+    /// the governor
+    uint32_t budget = 0;
+    /// Models are degraded when a block costs more than this fraction of the budget...
+    float high_watermark = 0.8f;
+    /// ...and upgraded again after `upgrade_blocks` blocks in a row below this fraction. Must be
+    /// below `high_watermark` times the cost ratio between consecutive levels, or levels flap.
+    float low_watermark = 0.3f;
+    uint32_t upgrade_blocks = 16;
+};
+
+/**
+ * @brief Keeps the cost of the output blocks within a budget by choosing the quality level of
+ * each model.
+ *
+ * Fed once per block with the measured cost of the block and the integration steps taken by each
+ * model. Above the high watermark, the models taking most steps are degraded, as many levels as
+ * needed assuming each level halves their cost. Below the low watermark for long enough, the
+ * most degraded model which ran is upgraded by one level. Models which did not run follow the
+ * most degraded one which did, so that switching models under load does not overrun.
+ *
+ * A block never costs more than the `max_steps_per_sample` of the current levels allow; the
+ * governor trades accuracy before that bound drops model time (slowing the oscillators down).
+ *
+ * @tparam N number of models
+ * @tparam L number of quality levels
+ */
+template <size_t N, size_t L> class QualityGovernor {
+  public:
+    static_assert(L > 0, "");
+
+    explicit QualityGovernor(const std::array<QualityLevel, L> &levels) : levels(levels) {
+        level.fill(0);
+    }
+
+    void set_config(const GovernorConfig &new_config) {
+        config = new_config;
+        calm_blocks = 0;
+    }
+
+    [[nodiscard]] bool enabled() const { return config.budget != 0; }
+
+    /**
+     * @param cost of the last block
+     * @param steps integration steps of each model in the last block
+     * @return bitmask of the models whose level changed
+     */
+    uint32_t update(uint32_t cost, const std::array<uint32_t, N> &steps) {
+        if (!enabled())
+            return 0;
+
+        uint32_t changed = adjust(static_cast<float>(cost), steps);
+
+        // Models which did not run follow the most degraded one which did: a model switched in
+        // under load starts at a level the load allows
+        size_t running_level = 0;
+        bool running = false;
+        for (size_t i = 0; i < N; i++) {
+            if (steps[i] > 0) {
+                running_level = running && running_level > level[i] ? running_level : level[i];
+                running = true;
+            }
+        }
+        for (size_t i = 0; running && i < N; i++) {
+            if (steps[i] == 0 && level[i] != running_level) {
+                level[i] = running_level;
+                changed |= 1u << i;
+            }
+        }
+        return changed;
+    }
+
+    /// @brief Forces the level of a model, e.g. to replay a recorded session.
+    void set_level(size_t model, size_t new_level) {
+        level[model] = new_level < L ? new_level : L - 1;
+    }
+
+    [[nodiscard]] size_t get_level(size_t model) const { return level[model]; }
+    [[nodiscard]] const QualityLevel &get_quality(size_t model) const {
+        return levels[level[model]];
+    }
+
+  private:
+    std::array<QualityLevel, L> levels;
+    GovernorConfig config;
+    std::array<size_t, N> level;
+    uint32_t calm_blocks = 0;
+
+    /// @brief Degrades or upgrades the models which ran, depending on the cost of the block.
+    uint32_t adjust(float cost, const std::array<uint32_t, N> &steps) {
+        const float high = config.high_watermark * static_cast<float>(config.budget);
+        const float low = config.low_watermark * static_cast<float>(config.budget);
+
+        if (cost > high) {
+            calm_blocks = 0;
+            uint32_t total_steps = 0;
+            for (uint32_t s : steps)
+                total_steps += s;
+            if (total_steps == 0)
+                return 0;
+
+            // Share of the cost of each model, estimated from its steps
+            std::array<float, N> share;
+            for (size_t i = 0; i < N; i++)
+                share[i] = cost * static_cast<float>(steps[i]) / static_cast<float>(total_steps);
+
+            uint32_t changed = 0;
+            while (cost > high) {
+                size_t model = N;
+                for (size_t i = 0; i < N; i++) {
+                    bool degradable = level[i] + 1 < L && steps[i] > 0;
+                    if (degradable && (model == N || share[i] > share[model]))
+                        model = i;
+                }
+                if (model == N)
+                    break; // everything at the cheapest level
+
+                level[model]++;
+                share[model] /= 2.0f;
+                cost -= share[model];
+                changed |= 1u << model;
+            }
+            return changed;
+        }
+
+        if (cost >= low) {
+            calm_blocks = 0;
+            return 0;
+        }
+        if (++calm_blocks < config.upgrade_blocks)
+            return 0;
+        calm_blocks = 0;
+
+        size_t model = N;
+        for (size_t i = 0; i < N; i++) {
+            if (level[i] > 0 && steps[i] > 0 && (model == N || level[i] > level[model]))
+                model = i;
+        }
+        if (model == N)
+            return 0;
+        level[model]--;
+        return 1u << model;
+    }
+};
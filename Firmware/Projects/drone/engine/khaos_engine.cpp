@@ -0,0 +1,216 @@
+#include "khaos_engine.hpp"
+
+KhaosOscillators::KhaosOscillators(float sample_rate)
+    : chua(math::Chua{}, math::model_seeds(math::Chua{})[0], sample_rate, 1.0f),
+      sprott(math::Sprott{}, math::model_seeds(math::Sprott{})[0], sample_rate, 1.0f),
+      rossler(math::Rossler{}, math::model_seeds(math::Rossler{})[0], sample_rate, 1.0f),
+      halvorsen(math::Halvorsen{}, math::model_seeds(math::Halvorsen{})[0], sample_rate, 1.0f),
+      lorentz(math::Lorentz{}, math::model_seeds(math::Lorentz{})[0], sample_rate, 1.0f) {
+    for (size_t i = 0; i < KhaosModelData::NUM_MODELS; i++) {
+        const ModelBounds &bounds = MODEL_BOUNDS[i];
+
+        for (size_t k = 0; k < 3; k++) {
+            center[i][k] = (bounds.max[k] + bounds.min[k]) / 2.0f;
+            scale[i][k] = 2.0f / (bounds.max[k] - bounds.min[k]);
+        }
+
+        math::vec3f half_diagonal = (bounds.max - bounds.min) / 2.0f;
+        float size_sq = math::dot(half_diagonal, half_diagonal);
+
+        ChaosWatchdog<math::vec3f> watchdog;
+        watchdog.center = center[i];
+        watchdog.escape_radius_sq = WATCHDOG_ESCAPE_FACTOR * WATCHDOG_ESCAPE_FACTOR * size_sq;
+        watchdog.min_motion_sq = WATCHDOG_MIN_MOTION * WATCHDOG_MIN_MOTION * size_sq;
+        watchdog.collapse_checks = WATCHDOG_COLLAPSE_BLOCKS;
+        // Where the seeds are not verified, the model may have no attractor: letting it rest on
+        // its fixed point beats relaunching it every few blocks
+        visit(i, [&watchdog](auto &osc) {
+            watchdog.seeds = math::model_seeds(osc.get_model());
+            watchdog.num_seeds = math::SeedTable::SEEDS_PER_CELL;
+            osc.set_watchdog(watchdog);
+            if (!math::model_seeds_verified(osc.get_model()))
+                osc.set_collapse_checks(0);
+        });
+
+        math::OrbitCacheConfig orbit;
+        float half_width = (bounds.max.x() - bounds.min.x()) / 2.0f;
+        orbit.section = {0, center[i].x(), math::SectionDirection::RISING, 0.1f * half_width};
+        orbit.tolerance = ORBIT_TOLERANCE;
+        orbit.min_extent = ORBIT_MIN_EXTENT * sqrtf(size_sq);
+        orbit.confirm_periods = ORBIT_CONFIRM_PERIODS;
+        orbits[i] = math::OrbitCache<math::vec3f, ORBIT_CACHE_SIZE>(orbit);
+    }
+}
+
+uint32_t KhaosOscillators::set_models(const KhaosModelData &data) {
+    uint32_t changed_models = 0;
+    auto changed = [&](KhaosModelData::SelectedModel model) {
+        bool result = data.generation[model] != generation[model];
+        generation[model] = data.generation[model];
+        changed_models |= static_cast<uint32_t>(result) << model;
+        if (result)
+            release_orbit(model);
+        return result;
+    };
+    auto apply = [](auto &osc, const auto &params) {
+        osc.set_params(params);
+        osc.set_seeds(math::model_seeds(osc.get_model()), math::SeedTable::SEEDS_PER_CELL);
+        osc.set_collapse_checks(math::model_seeds_verified(osc.get_model())
+                                    ? WATCHDOG_COLLAPSE_BLOCKS
+                                    : 0);
+    };
+
+    if (changed(KhaosModelData::CHUA))
+        apply(chua, data.chua);
+    if (changed(KhaosModelData::SPROTT))
+        apply(sprott, data.sprott);
+    if (changed(KhaosModelData::ROSSLER))
+        apply(rossler, data.rossler);
+    if (changed(KhaosModelData::HALVORSEN))
+        apply(halvorsen, data.halvorsen);
+    if (changed(KhaosModelData::LORENTZ))
+        apply(lorentz, data.lorentz);
+
+    // The intrinsic frequency depends on the parameters: a model whose parameters changed
+    // needs a new time scale for the same frequency
+    bool retuned = data.frequency != frequency;
+    frequency = data.frequency;
+    for (size_t i = 0; frequency > 0.0f && i < KhaosModelData::NUM_MODELS; i++) {
+        if (retuned || (changed_models & (1u << i)))
+            set_frequency(i, frequency);
+    }
+    return changed_models;
+}
+
+void KhaosOscillators::set_frequency(size_t model, float new_frequency) {
+    bool changed = visit(model, [new_frequency](auto &osc) {
+        float sample_dt = osc.get_sample_dt();
+        osc.set_frequency(new_frequency);
+        return osc.get_sample_dt() != sample_dt;
+    });
+    // A cached orbit only holds at the time scale it was recorded at
+    if (changed)
+        release_orbit(model);
+}
+
+math::vec3f KhaosOscillators::step(size_t model) {
+    auto &orbit = orbits[model];
+    math::vec3f state;
+
+    if (orbit.is_playing()) {
+        state = orbit.play();
+    } else {
+        state = visit(model, [this, model](auto &osc) {
+            math::vec3f next = osc.step();
+            block_steps[model] += osc.get_last_steps();
+            return next;
+        });
+        stepped |= 1u << model;
+        orbit.record(state);
+    }
+
+    for (size_t k = 0; k < 3; k++) {
+        state[k] = (state[k] - center[model][k]) * scale[model][k];
+    }
+    return state;
+}
+
+void KhaosOscillators::release_orbit(size_t model) {
+    auto &orbit = orbits[model];
+    if (orbit.is_playing()) {
+        math::vec3f state = orbit.get_state();
+        visit(model, [&state](auto &osc) { osc.set_state(state); });
+    }
+    orbit.reset();
+}
+
+void KhaosOscillators::set_quality(size_t model, const QualityLevel &quality) {
+    visit(model, [&quality](auto &osc) {
+        osc.set_max_dt(math::DEFAULT_DT * quality.dt_scale);
+        osc.set_max_steps_per_sample(quality.max_steps_per_sample);
+    });
+}
+
+uint32_t KhaosOscillators::check_health() {
+    uint32_t reseeded = 0;
+    for (size_t i = 0; i < KhaosModelData::NUM_MODELS; i++) {
+        if ((stepped & (1u << i)) && visit(i, [](auto &osc) { return osc.check_health(); })) {
+            reseeded |= 1u << i;
+            orbits[i].reset();
+        }
+    }
+    stepped = 0;
+    return reseeded;
+}
+
+KhaosEngine::KhaosEngine(const KhaosEngineConfig &config)
+    : oscillators(static_cast<float>(config.sample_rate)),
+      model_switch(KhaosModelData{}.selected, config.preroll_steps, config.preroll_steps_per_block,
+                   config.crossfade_samples),
+      governor(QUALITY_LEVELS) {}
+
+uint32_t KhaosEngine::set_model_data(const KhaosModelData &data) {
+    model_switch.select(data.selected);
+    return oscillators.set_models(data);
+}
+
+uint32_t KhaosEngine::render(math::vec3f *block, size_t size) {
+    oscillators.block_steps.fill(0);
+    model_switch.process(block, size, [this](size_t model) { return oscillators.step(model); });
+    return oscillators.check_health();
+}
+
+KhaosEngineState KhaosEngine::get_state() const {
+    KhaosEngineState state{{oscillators.chua.state, oscillators.sprott.state,
+                            oscillators.rossler.state, oscillators.halvorsen.state,
+                            oscillators.lorentz.state}};
+    for (size_t i = 0; i < KhaosModelData::NUM_MODELS; i++) {
+        if (oscillators.orbits[i].is_playing())
+            state.states[i] = oscillators.orbits[i].get_state();
+    }
+    return state;
+}
+
+void KhaosEngine::resume(const KhaosModelData &data, const KhaosEngineState &state) {
+    oscillators.set_models(data);
+    for (size_t i = 0; i < KhaosModelData::NUM_MODELS; i++) {
+        oscillators.visit(i, [&](auto &osc) { osc.set_state(state.states[i]); });
+        oscillators.orbits[i].reset();
+    }
+    model_switch.resume(data.selected);
+}
+
+void KhaosEngine::set_governor(const GovernorConfig &config) { governor.set_config(config); }
+
+uint32_t KhaosEngine::govern(uint32_t cost) {
+    uint32_t changed = governor.update(cost, oscillators.block_steps);
+    for (size_t i = 0; i < KhaosModelData::NUM_MODELS; i++) {
+        if (changed & (1u << i))
+            oscillators.set_quality(i, governor.get_quality(i));
+    }
+    return changed;
+}
+
+void KhaosEngine::set_quality_level(size_t model, size_t level) {
+    governor.set_level(model, level);
+    oscillators.set_quality(model, governor.get_quality(model));
+}
+
+size_t KhaosEngine::get_quality_level(size_t model) const { return governor.get_level(model); }
+
+void KhaosEngine::set_frequency_multiplier(size_t model, float multiplier) {
+    bool changed = oscillators.visit(model, [multiplier](auto &osc) {
+        float sample_dt = osc.get_sample_dt();
+        osc.set_frequency_multiplier(multiplier);
+        return osc.get_sample_dt() != sample_dt;
+    });
+    // A cached orbit only holds at the time scale it was recorded at
+    if (changed)
+        oscillators.release_orbit(model);
+}
+
+/// @brief Converts a normalized output in [-1, 1] to a DAC value
+uint16_t to_dac(float value) {
+    return static_cast<uint16_t>(
+        math::clamp((value + 1.0f) * 0.5f * DAC_MAX_VALUE, 0.0f, DAC_MAX_VALUE));
+}
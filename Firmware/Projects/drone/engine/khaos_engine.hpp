@@ -0,0 +1,194 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include "../math/chaos_osc.hpp"
+#include "../math/model_switch.hpp"
+#include "../math/models.hpp"
+#include "../math/orbit_cache.hpp"
+#include "../math/seed_tables.hpp"
+#include "governor.hpp"
+#include "model_data.hpp"
+
+/*
+ * Output generation, independent of the hardware: model data in, normalized states out.
+ * Shared by the firmware output callback and the host replayer (tools/replay.cpp), so that a
+ * recorded session is rendered by the same code on both.
+ */
+
+constexpr float DAC_MAX_VALUE = 4095.0f; // 12-bit
+
+/// Periodic orbits are cached (see math/orbit_cache.hpp) when their crossings of the plane x =
+/// center, one period apart, match within ORBIT_TOLERANCE times the distance moved in one sample
+/// for ORBIT_CONFIRM_PERIODS periods, and the orbit reaches ORBIT_MIN_EXTENT times the half
+/// diagonal of the bounds. The crossings are located to about 1e-3 sample step.
+/// ORBIT_CACHE_SIZE samples of history per model (24 KiB) hold a period-2 Rossler orbit at 100
+/// samples per second.
+constexpr size_t ORBIT_CACHE_SIZE = 2048;
+constexpr float ORBIT_TOLERANCE = 0.05f;
+constexpr float ORBIT_MIN_EXTENT = 0.05f;
+constexpr uint32_t ORBIT_CONFIRM_PERIODS = 3;
+
+/// Quality levels of the governor, from the nominal integration. Each level covers the same model
+/// time per sample at most as the previous one, in half the steps, so at half the cost.
+constexpr std::array<QualityLevel, 4> QUALITY_LEVELS{{
+    {1.0f, DEFAULT_MAX_STEPS_PER_SAMPLE},
+    {2.0f, DEFAULT_MAX_STEPS_PER_SAMPLE / 2},
+    {4.0f, DEFAULT_MAX_STEPS_PER_SAMPLE / 4},
+    {8.0f, DEFAULT_MAX_STEPS_PER_SAMPLE / 8},
+}};
+
+/**
+ * All chaotic oscillators driven by the output.
+ * Their states persist across model switches, so a model selected again resumes from its
+ * attractor.
+ */
+struct KhaosOscillators {
+    ChaosOsc<math::Chua> chua;
+    ChaosOsc<math::Sprott> sprott;
+    ChaosOsc<math::Rossler> rossler;
+    ChaosOsc<math::Halvorsen> halvorsen;
+    ChaosOsc<math::Lorentz> lorentz;
+
+    /// Normalization: output = (state - center) * scale
+    std::array<math::vec3f, KhaosModelData::NUM_MODELS> center, scale;
+
+    /// Bitmask of the models stepped since the last health check
+    uint32_t stepped = 0;
+    /// Integration steps of each model since the start of the block
+    std::array<uint32_t, KhaosModelData::NUM_MODELS> block_steps{};
+
+    /// Periodic orbits played back instead of integrated
+    std::array<math::OrbitCache<math::vec3f, ORBIT_CACHE_SIZE>, KhaosModelData::NUM_MODELS> orbits;
+
+    /// Generation of the parameters applied to each model
+    std::array<uint32_t, KhaosModelData::NUM_MODELS> generation{};
+    /// Frequency applied to the models, 0 if none
+    float frequency = 0.0f;
+
+    explicit KhaosOscillators(float sample_rate);
+    /// @brief Applies the parameters of the models whose generation changed, and the seeds
+    /// verified for them (see math/seed_tables.hpp), then the frequency to the models whose
+    /// parameters or frequency changed.
+    /// @return bitmask of the models whose parameters changed
+    uint32_t set_models(const KhaosModelData &);
+
+    /// @brief Sets the time scale of a model so that it rotates at `frequency` Hz (see
+    /// ChaosOsc::set_frequency()), dropping its cached orbit if the time scale changed.
+    void set_frequency(size_t model, float frequency);
+
+    /// @brief Advances a model by one output sample, from its cached orbit if it has one.
+    /// @return the new state, normalized to [-1, 1]
+    math::vec3f step(size_t model);
+
+    /// @brief Drops the cached orbit of a model, which integrates again from where the orbit was;
+    /// needed whenever its parameters or time scale change.
+    void release_orbit(size_t model);
+
+    /// @brief Applies the integration settings of a quality level to a model.
+    void set_quality(size_t model, const QualityLevel &quality);
+
+    /// @brief Runs the watchdog of the models stepped since the last call.
+    /// @return bitmask of the models reseeded
+    uint32_t check_health();
+
+    /// @brief Calls `f(ChaosOsc<...> &)` on the oscillator of the given model.
+    template <class F> auto visit(size_t model, F &&f) {
+        switch (model) {
+        case KhaosModelData::CHUA:
+            return f(chua);
+        case KhaosModelData::SPROTT:
+            return f(sprott);
+        case KhaosModelData::ROSSLER:
+            return f(rossler);
+        case KhaosModelData::HALVORSEN:
+            return f(halvorsen);
+        case KhaosModelData::LORENTZ:
+        default:
+            return f(lorentz);
+        }
+    }
+};
+
+/// Oscillator states, in SelectedModel order: enough to resume on the attractors
+struct KhaosEngineState {
+    std::array<math::vec3f, KhaosModelData::NUM_MODELS> states;
+};
+
+static_assert(std::is_trivially_copyable<KhaosEngineState>::value,
+              "KhaosEngineState is copied through a TriBuf from interrupts");
+
+struct KhaosEngineConfig {
+    /// Output samples per second
+    uint32_t sample_rate;
+    /// Samples per output block
+    uint32_t block_size;
+    uint32_t preroll_steps;
+    uint32_t preroll_steps_per_block;
+    uint32_t crossfade_samples;
+};
+
+/**
+ * Oscillators and model switching, rendered block by block.
+ */
+class KhaosEngine {
+  public:
+    explicit KhaosEngine(const KhaosEngineConfig &config);
+
+    /// @brief Applies new model data.
+    /// @return bitmask of the models whose parameters changed
+    uint32_t set_model_data(const KhaosModelData &data);
+
+    /**
+     * @brief Renders one block of normalized states, prerolling and crossfading a newly selected
+     * model, then runs the watchdog.
+     * @return bitmask of the models reseeded by the watchdog
+     */
+    uint32_t render(math::vec3f *block, size_t size);
+
+    KhaosEngineState get_state() const;
+
+    /**
+     * @brief Resumes a previous session, before rendering starts: applies the model data and
+     * the oscillator states, and plays the selected model at once, without preroll.
+     */
+    void resume(const KhaosModelData &data, const KhaosEngineState &state);
+
+    /// @brief Enables the quality governor (see engine/governor.hpp); disabled by default.
+    void set_governor(const GovernorConfig &config);
+
+    /**
+     * @brief Feeds the governor with the cost of the last rendered block and applies the new
+     * quality levels, from the next block on.
+     * @return bitmask of the models whose quality level changed
+     */
+    uint32_t govern(uint32_t cost);
+
+    /// @brief Forces the quality level of a model, e.g. to replay a recorded session.
+    void set_quality_level(size_t model, size_t level);
+    [[nodiscard]] size_t get_quality_level(size_t model) const;
+
+    /// @brief Integration steps taken by each model in the last rendered block.
+    [[nodiscard]] const std::array<uint32_t, KhaosModelData::NUM_MODELS> &get_block_steps() const {
+        return oscillators.block_steps;
+    }
+
+    /// @brief Sets the time scale of a model (see ChaosOsc::set_frequency_multiplier()).
+    void set_frequency_multiplier(size_t model, float multiplier);
+
+    /// @brief Period of the orbit a model is played back from, in samples; 0 if it integrates.
+    [[nodiscard]] float get_orbit_period(size_t model) const {
+        return oscillators.orbits[model].get_period();
+    }
+
+  private:
+    KhaosOscillators oscillators;
+    ModelSwitch<KhaosModelData::NUM_MODELS> model_switch;
+    QualityGovernor<KhaosModelData::NUM_MODELS, QUALITY_LEVELS.size()> governor;
+};
+
+/// @brief Converts a normalized output in [-1, 1] to a DAC value
+uint16_t to_dac(float value);
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include "../math/models.hpp"
+
+/*
+ * Model selection, parameters and bounds, and the watchdog criteria. Kept apart from the engine,
+ * which includes the generated seed tables, so that tools/gen_seed_tables.cpp can use them.
+ */
+
+/// An oscillator is reseeded when its distance from the center of its bounds exceeds
+/// WATCHDOG_ESCAPE_FACTOR times their half diagonal...
+constexpr float WATCHDOG_ESCAPE_FACTOR = 4.0f;
+/// ...or when it moves less than WATCHDOG_MIN_MOTION times their half diagonal between two
+/// consecutive blocks, for WATCHDOG_COLLAPSE_BLOCKS blocks in a row
+constexpr float WATCHDOG_MIN_MOTION = 1e-3f;
+constexpr uint32_t WATCHDOG_COLLAPSE_BLOCKS = 16;
+
+/**
+ * Model selection and parameters, published by main to the output callback through a TriBuf.
+ * Only parameter snapshots are stored, not whole models: each model has a generation counter and
+ * the callback applies the parameters of a model only when its generation changed.
+ */
+// Must follow the order of Displayed_Models
+struct KhaosModelData {
+    enum SelectedModel { CHUA = 0, SPROTT, ROSSLER, HALVORSEN, LORENTZ, NUM_MODELS };
+
+    SelectedModel selected = ROSSLER;
+    std::array<uint32_t, NUM_MODELS> generation{};
+    math::ChuaParams chua;
+    math::SprottParams sprott;
+    math::RosslerParams rossler;
+    math::HalvorsenParams halvorsen;
+    math::LorentzParams lorentz;
+    /// Mean rotation frequency of every model, in Hz (see ChaosOsc::set_frequency()), kept
+    /// across parameter changes; 0 leaves the time scales as they are
+    float frequency = 0.0f;
+
+    /// @brief Marks the parameters of a model as changed.
+    void touch(SelectedModel model) { generation[model]++; }
+
+    /// @brief Calls `f(math::...Params &)` on the parameters of the given model, with the
+    /// constness of `data`.
+    template <class Data, class F> static auto visit_params(Data &data, size_t model, F &&f) {
+        switch (model) {
+        case CHUA:
+            return f(data.chua);
+        case SPROTT:
+            return f(data.sprott);
+        case ROSSLER:
+            return f(data.rossler);
+        case HALVORSEN:
+            return f(data.halvorsen);
+        case LORENTZ:
+        default:
+            return f(data.lorentz);
+        }
+    }
+};
+
+static_assert(std::is_trivially_copyable<KhaosModelData>::value,
+              "KhaosModelData is copied through a TriBuf from interrupts");
+
+struct ModelBounds {
+    math::vec3f min, max;
+};
+
+/// Empirical bounds of each model (see display/MinMaxFinder.cpp), in SelectedModel order.
+/// Outputs are normalized to [-1, 1] using these bounds, so that models can be crossfaded.
+constexpr std::array<ModelBounds, KhaosModelData::NUM_MODELS> MODEL_BOUNDS{{
+    {{-2.228f, -0.364f, -3.862f}, {2.228f, 0.364f, 3.862f}},   // Chua
+    {{-0.99f, -2.006f, -1.895f}, {2.12f, 1.31f, 1.915f}},      // Sprott
+    {{-9.104f, -10.789f, 0.013f}, {11.431f, 7.839f, 22.838f}}, // Rossler
+    {{-12.239f, -12.347f, -12.186f}, {6.358f, 6.331f, 6.334f}}, // Halvorsen
+    {{-19.398f, -26.87f, 1.512f}, {19.398f, 26.87f, 47.5f}},   // Lorentz
+}};
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+/*
+ * Compact binary record of everything that drives the output, so that a session can be replayed
+ * off-device (see tools/replay.cpp).
+ *
+ * Each event is timestamped with the output frame (sample) at which it took effect, and written
+ * to the debug log as one `REC <hex>` line. Serialized events are little-endian:
+ *   frame (4 bytes) | type (1) | index (1) | size (1) | payload (size bytes)
+ */
+
+/// Largest payload: a KhaosEngineConfig
+constexpr size_t RECORD_MAX_PAYLOAD = 20;
+constexpr size_t RECORD_HEADER_SIZE = 7;
+/// Hex characters of the longest event, including the terminator
+constexpr size_t RECORD_HEX_SIZE = 2 * (RECORD_HEADER_SIZE + RECORD_MAX_PAYLOAD) + 1;
+constexpr const char *RECORD_PREFIX = "REC ";
+
+enum class RecordType : uint8_t {
+    /// Engine configuration (KhaosEngineConfig), at the start of a session
+    CONFIG = 1,
+    /// New input data (RecordedInput)
+    INPUT,
+    /// New parameters of model `index` (math::...Params)
+    PARAMS,
+    /// Model `index` selected, no payload
+    SELECT,
+    /// State of oscillator `index` (math::vec3f), at the start of a session resumed from a
+    /// snapshot
+    STATE,
+    /// Quality level of model `index` set by the governor (uint8_t), from this frame on
+    QUALITY,
+    /// Frequency of the models in Hz (float, see KhaosModelData::frequency), from this frame on
+    FREQUENCY,
+};
+
+struct RecordEvent {
+    uint32_t frame = 0;
+    RecordType type = RecordType::CONFIG;
+    uint8_t index = 0;
+    uint8_t size = 0;
+    uint8_t payload[RECORD_MAX_PAYLOAD];
+
+    RecordEvent() = default;
+
+    RecordEvent(uint32_t frame, RecordType type, uint8_t index, const void *data = nullptr,
+                size_t data_size = 0)
+        : frame(frame), type(type), index(index), size(static_cast<uint8_t>(data_size)) {
+        if (data_size > RECORD_MAX_PAYLOAD)
+            size = RECORD_MAX_PAYLOAD;
+        if (data)
+            memcpy(payload, data, size);
+    }
+
+    /// @brief Copies the payload into `out` if it has exactly its size.
+    template <class T> bool get(T &out) const {
+        if (size != sizeof(T))
+            return false;
+        memcpy(&out, payload, sizeof(T));
+        return true;
+    }
+};
+
+/// Payload of INPUT events
+struct RecordedInput {
+    uint16_t encoder_values[4];
+    uint16_t cvs[2];
+    /// One bit per encoder switch
+    uint8_t switches;
+};
+
+/**
+ * @brief Serializes an event as a null-terminated hex string.
+ * @param out at least RECORD_HEX_SIZE characters
+ */
+inline void record_encode(const RecordEvent &event, char *out) {
+    constexpr char HEX[] = "0123456789abcdef";
+    uint8_t bytes[RECORD_HEADER_SIZE + RECORD_MAX_PAYLOAD];
+
+    for (size_t i = 0; i < 4; i++)
+        bytes[i] = static_cast<uint8_t>(event.frame >> (8 * i));
+    bytes[4] = static_cast<uint8_t>(event.type);
+    bytes[5] = event.index;
+    bytes[6] = event.size;
+    memcpy(bytes + RECORD_HEADER_SIZE, event.payload, event.size);
+
+    size_t length = RECORD_HEADER_SIZE + event.size;
+    for (size_t i = 0; i < length; i++) {
+        *out++ = HEX[bytes[i] >> 4];
+        *out++ = HEX[bytes[i] & 0xF];
+    }
+    *out = '\0';
+}
+
+/// @brief Parses a hex string produced by `record_encode()`.
+inline bool record_decode(const char *hex, RecordEvent &event) {
+    auto nibble = [](char c) -> int {
+        if (c >= '0' && c <= '9')
+            return c - '0';
+        if (c >= 'a' && c <= 'f')
+            return c - 'a' + 10;
+        return -1;
+    };
+
+    uint8_t bytes[RECORD_HEADER_SIZE + RECORD_MAX_PAYLOAD];
+    size_t length = 0;
+    while (length < sizeof(bytes)) {
+        int high = nibble(hex[0]);
+        int low = high < 0 ? -1 : nibble(hex[1]);
+        if (low < 0)
+            break;
+        bytes[length++] = static_cast<uint8_t>(high << 4 | low);
+        hex += 2;
+    }
+
+    if (length < RECORD_HEADER_SIZE || length != RECORD_HEADER_SIZE + bytes[6])
+        return false;
+
+    event.frame = 0;
+    for (size_t i = 0; i < 4; i++)
+        event.frame |= static_cast<uint32_t>(bytes[i]) << (8 * i);
+    event.type = static_cast<RecordType>(bytes[4]);
+    event.index = bytes[5];
+    event.size = bytes[6];
+    memcpy(event.payload, bytes + RECORD_HEADER_SIZE, event.size);
+    return true;
+}
@@ -0,0 +1,173 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#include "khaos_engine.hpp"
+#include "storage.hpp"
+
+/**
+ * Everything restored at power-up: model selection and parameters, oscillator states and
+ * encoder positions.
+ */
+struct KhaosSnapshot {
+    KhaosModelData model_data;
+    KhaosEngineState engine_state;
+    std::array<uint16_t, 4> encoder_values;
+};
+
+static_assert(std::is_trivially_copyable<KhaosSnapshot>::value, "KhaosSnapshot is stored as is");
+
+/// @brief CRC-32 (IEEE 802.3), bitwise: snapshots are small and rarely written.
+inline uint32_t crc32(const void *data, size_t size, uint32_t crc = 0) {
+    auto bytes = static_cast<const uint8_t *>(data);
+    crc = ~crc;
+    for (size_t i = 0; i < size; i++) {
+        crc ^= bytes[i];
+        for (int k = 0; k < 8; k++)
+            crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+    }
+    return ~crc;
+}
+
+/**
+ * @brief Wear-levelled log of snapshots in a Storage.
+ *
+ * The storage is divided in fixed-size slots, written in turn; a sector is erased right before
+ * its first slot is written, so every sector is erased once per round of the whole storage.
+ * Each slot holds a header (magic, sequence number, CRC) followed by the snapshot: the valid slot
+ * with the highest sequence number is the latest snapshot. An interrupted write leaves an invalid
+ * slot, and the previous snapshot is loaded instead.
+ *
+ * Writes and erases block for milliseconds: never call `save()` from an interrupt.
+ */
+template <class T> class SnapshotLog {
+  public:
+    static_assert(std::is_trivially_copyable<T>::value, "");
+
+    struct Header {
+        uint32_t magic;
+        uint32_t sequence;
+        /// Of the sequence number and the snapshot
+        uint32_t crc;
+    };
+
+    /// Changes with the size of the snapshot, so that stale layouts are ignored
+    static constexpr uint32_t MAGIC = 0x4B480000u ^ static_cast<uint32_t>(sizeof(T));
+
+    static constexpr size_t slot_size() {
+        size_t size = 16;
+        while (size < sizeof(Header) + sizeof(T))
+            size *= 2;
+        return size;
+    }
+    /// Power of two: slots never straddle a flash page or a sector
+    static constexpr size_t SLOT_SIZE = slot_size();
+
+    explicit SnapshotLog(Storage &storage) : storage(storage) {}
+
+    /// @brief Number of slots, or 0 if the storage cannot hold a log (it needs two sectors).
+    size_t num_slots() const {
+        size_t sector = storage.sector_size();
+        if (sector % SLOT_SIZE != 0 || storage.size() < 2 * sector)
+            return 0;
+        return storage.size() / SLOT_SIZE;
+    }
+
+    /**
+     * @brief Finds the latest snapshot; must be called before `save()`.
+     * @return false if the storage holds no valid snapshot
+     */
+    bool load(T &out) {
+        size_t slots = num_slots();
+        bool found = false;
+        next_slot = 0;
+
+        for (size_t slot = 0; slot < slots; slot++) {
+            Header header;
+            if (!storage.read(slot * SLOT_SIZE, &header, sizeof(header)) || header.magic != MAGIC)
+                continue;
+            if (found && static_cast<int32_t>(header.sequence - sequence) <= 0)
+                continue;
+
+            T value;
+            if (!read_slot(slot, header, value))
+                continue;
+
+            out = value;
+            sequence = header.sequence;
+            next_slot = (slot + 1) % slots;
+            found = true;
+        }
+        return found;
+    }
+
+    /**
+     * @brief Writes a new snapshot in the next slot, erasing its sector first if needed.
+     * Slots which cannot be written (not erased, or failing verification) are skipped.
+     * @return false if no slot could be written
+     */
+    bool save(const T &value) {
+        size_t slots = num_slots();
+        if (slots == 0)
+            return false;
+
+        const size_t slots_per_sector = storage.sector_size() / SLOT_SIZE;
+        Header header{MAGIC, sequence + 1, 0};
+        header.crc = crc32(&value, sizeof(T), crc32(&header.sequence, sizeof(header.sequence)));
+
+        // Unusable slots are skipped, for one round of the storage at most
+        for (size_t attempt = 0; attempt < slots; attempt++) {
+            size_t slot = next_slot;
+            next_slot = (slot + 1) % slots;
+
+            if (slot % slots_per_sector == 0) {
+                if (!storage.erase_sector(slot / slots_per_sector))
+                    continue;
+            } else if (!is_erased(slot)) {
+                continue;
+            }
+
+            if (!storage.write(slot * SLOT_SIZE + sizeof(Header), &value, sizeof(T)) ||
+                !storage.write(slot * SLOT_SIZE, &header, sizeof(Header))) {
+                continue;
+            }
+
+            T check;
+            if (read_slot(slot, header, check) && memcmp(&check, &value, sizeof(T)) == 0) {
+                sequence = header.sequence;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /// @brief Sequence number of the latest snapshot loaded or saved
+    uint32_t get_sequence() const { return sequence; }
+
+  private:
+    Storage &storage;
+    size_t next_slot = 0;
+    uint32_t sequence = 0;
+
+    bool read_slot(size_t slot, const Header &header, T &out) {
+        if (!storage.read(slot * SLOT_SIZE + sizeof(Header), &out, sizeof(T)))
+            return false;
+        uint32_t crc = crc32(&out, sizeof(T), crc32(&header.sequence, sizeof(header.sequence)));
+        return crc == header.crc;
+    }
+
+    bool is_erased(size_t slot) {
+        uint32_t words[SLOT_SIZE / sizeof(uint32_t)];
+        if (!storage.read(slot * SLOT_SIZE, words, sizeof(words)))
+            return false;
+        for (uint32_t word : words) {
+            if (word != 0xFFFFFFFFu)
+                return false;
+        }
+        return true;
+    }
+};
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+/**
+ * @brief Non-volatile storage with the semantics of NOR flash: erased bytes read 0xFF, writes
+ * can only clear bits, and erasing works on whole sectors.
+ * Addresses are relative to the start of the storage.
+ */
+class Storage {
+  public:
+    virtual ~Storage() = default;
+
+    virtual size_t size() const = 0;
+    virtual size_t sector_size() const = 0;
+
+    virtual bool read(size_t address, void *out, size_t size) = 0;
+    /// @brief Programs erased bytes
+    virtual bool write(size_t address, const void *data, size_t size) = 0;
+    virtual bool erase_sector(size_t sector) = 0;
+};
+
+/**
+ * @brief Storage in RAM, for host tools: emulates NOR flash (writes AND the bits) and counts the
+ * erases of each sector.
+ */
+template <size_t SIZE, size_t SECTOR_SIZE> class RamStorage : public Storage {
+  public:
+    static_assert(SIZE % SECTOR_SIZE == 0, "");
+    static constexpr size_t NUM_SECTORS = SIZE / SECTOR_SIZE;
+
+    RamStorage() { data.fill(0xFF); }
+
+    size_t size() const override { return SIZE; }
+    size_t sector_size() const override { return SECTOR_SIZE; }
+
+    bool read(size_t address, void *out, size_t size) override {
+        if (address + size > SIZE)
+            return false;
+        memcpy(out, data.data() + address, size);
+        return true;
+    }
+
+    bool write(size_t address, const void *in, size_t size) override {
+        if (address + size > SIZE)
+            return false;
+        auto bytes = static_cast<const uint8_t *>(in);
+        for (size_t i = 0; i < size; i++)
+            data[address + i] &= bytes[i];
+        return true;
+    }
+
+    bool erase_sector(size_t sector) override {
+        if (sector >= NUM_SECTORS)
+            return false;
+        memset(data.data() + sector * SECTOR_SIZE, 0xFF, SECTOR_SIZE);
+        erases[sector]++;
+        return true;
+    }
+
+    std::array<uint8_t, SIZE> data;
+    std::array<uint32_t, NUM_SECTORS> erases{};
+};
@@ -0,0 +1,39 @@
+#include "qspi_storage.hpp"
+
+#include <cstring>
+
+using namespace daisy;
+
+bool QspiStorage::read(size_t address, void *out, size_t size) {
+    if (address + size > region_size)
+        return false;
+
+    auto data = static_cast<const uint8_t *>(qspi.GetData(base + address));
+
+    // Writes and erases go around the data cache: drop the lines which may hold stale data
+    constexpr uintptr_t LINE = 32;
+    uintptr_t start = reinterpret_cast<uintptr_t>(data) & ~(LINE - 1);
+    uintptr_t end = reinterpret_cast<uintptr_t>(data) + size;
+    SCB_InvalidateDCache_by_Addr(reinterpret_cast<uint32_t *>(start),
+                                 static_cast<int32_t>(end - start));
+
+    memcpy(out, data, size);
+    return true;
+}
+
+bool QspiStorage::write(size_t address, const void *data, size_t size) {
+    if (address + size > region_size)
+        return false;
+
+    // The driver takes a mutable buffer but only reads it
+    auto bytes = const_cast<uint8_t *>(static_cast<const uint8_t *>(data));
+    return qspi.Write(static_cast<uint32_t>(base + address), static_cast<uint32_t>(size), bytes) ==
+           QSPIHandle::Result::OK;
+}
+
+bool QspiStorage::erase_sector(size_t sector) {
+    if ((sector + 1) * SECTOR_SIZE > region_size)
+        return false;
+    return qspi.EraseSector(static_cast<uint32_t>(base + sector * SECTOR_SIZE)) ==
+           QSPIHandle::Result::OK;
+}
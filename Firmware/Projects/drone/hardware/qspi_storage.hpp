@@ -0,0 +1,28 @@
+#pragma once
+#include "daisy_seed.h"
+
+#include "../engine/storage.hpp"
+
+/// @brief Storage in a region of the QSPI flash of the Daisy Seed (IS25LP064A: 8 MiB, 4 KiB
+/// sectors). The flash stays memory-mapped: reads are plain copies, writes and erases block.
+class QspiStorage : public Storage {
+  public:
+    static constexpr size_t SECTOR_SIZE = 4096;
+    static constexpr size_t FLASH_SIZE = 8 * 1024 * 1024;
+
+    /// @param base offset of the region in the flash, a multiple of SECTOR_SIZE
+    /// @param size size of the region, a multiple of SECTOR_SIZE
+    QspiStorage(daisy::QSPIHandle &qspi, size_t base, size_t size)
+        : qspi(qspi), base(base), region_size(size) {}
+
+    size_t size() const override { return region_size; }
+    size_t sector_size() const override { return SECTOR_SIZE; }
+
+    bool read(size_t address, void *out, size_t size) override;
+    bool write(size_t address, const void *data, size_t size) override;
+    bool erase_sector(size_t sector) override;
+
+  private:
+    daisy::QSPIHandle &qspi;
+    size_t base, region_size;
+};
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+/**
+ * Quadrature decoding of the rotary encoders, independent of the hardware: the A and B levels
+ * are sampled periodically by a timer interrupt and fed to an EncoderCounter, which main reads
+ * between refreshes (see tools/encoder_check.cpp).
+ */
+
+/**
+ * @brief Gray-code state machine: every valid transition of (A, B) moves one quarter of a cycle.
+ * Contact bounce only produces back-and-forth transitions, which cancel out.
+ */
+class QuadratureDecoder {
+  public:
+    /// Level of (A, B) when the encoder rests on a detent (contacts open, pull-ups)
+    static constexpr uint8_t REST_STATE = 0b11;
+
+    /**
+     * @brief Feeds the current levels of A and B.
+     * @return +1 or -1 when a detent is completed clockwise or counterclockwise, 0 otherwise
+     */
+    int8_t process(bool a, bool b) {
+        // Index: previous state, current state
+        static constexpr int8_t TRANSITIONS[16] = {0, -1, 1, 0, 1, 0, 0, -1,
+                                                   -1, 0, 0, 1, 0, 1, -1, 0};
+
+        uint8_t state = static_cast<uint8_t>(a << 1 | b);
+        if (state == previous)
+            return 0;
+
+        int8_t transition = TRANSITIONS[previous << 2 | state];
+        if (transition == 0)
+            invalid++; // both lines changed: a transition was missed
+        previous = state;
+        quarters += transition;
+
+        // A detent is counted back at rest, once more than half a cycle went one way
+        if (state != REST_STATE)
+            return 0;
+        int8_t detent = quarters >= 2 ? 1 : (quarters <= -2 ? -1 : 0);
+        quarters = 0;
+        return detent;
+    }
+
+    /// @brief Transitions missed because the lines were sampled too slowly
+    uint32_t get_invalid() const { return invalid; }
+
+  private:
+    uint8_t previous = REST_STATE;
+    int8_t quarters = 0;
+    uint32_t invalid = 0;
+};
+
+/**
+ * @brief Velocity-dependent step size: one step per detent when detents come `slow_interval`
+ * ticks apart or more, up to `max_multiplier` steps at `fast_interval` ticks apart or less,
+ * linearly in velocity (1 / interval) in between.
+ */
+struct EncoderAcceleration {
+    uint32_t slow_interval;
+    uint32_t fast_interval;
+    int32_t max_multiplier;
+
+    int32_t multiplier(uint32_t interval) const {
+        if (interval >= slow_interval)
+            return 1;
+        if (interval <= fast_interval)
+            return max_multiplier;
+        // (slow / interval - 1) / (slow / fast - 1), in integers
+        uint64_t num = static_cast<uint64_t>(max_multiplier - 1) * (slow_interval - interval) *
+                       fast_interval;
+        uint64_t den = static_cast<uint64_t>(interval) * (slow_interval - fast_interval);
+        return 1 + static_cast<int32_t>(num / den);
+    }
+};
+
+/**
+ * @brief Decodes one encoder and accumulates its accelerated steps.
+ * `process()` runs in the sampling interrupt and `read_increment()` in main: the position has a
+ * single writer and a single reader, so no step is lost between refreshes and no lock is needed.
+ */
+class EncoderCounter {
+  public:
+    explicit EncoderCounter(const EncoderAcceleration &acceleration = {1, 1, 1})
+        : acceleration(acceleration) {}
+
+    /**
+     * @brief Feeds the levels of A and B sampled at `tick`.
+     * @return true if the position changed
+     */
+    bool process(bool a, bool b, uint32_t tick) {
+        int8_t detent = decoder.process(a, b);
+        if (detent == 0)
+            return false;
+
+        // Acceleration only builds up while turning the same way
+        int32_t steps = detent == last_direction ? acceleration.multiplier(tick - last_tick) : 1;
+        last_direction = detent;
+        last_tick = tick;
+
+        // Wraps around; the reader only looks at differences
+        uint32_t position = this->position.load(std::memory_order_relaxed);
+        this->position.store(position + static_cast<uint32_t>(detent * steps),
+                             std::memory_order_relaxed);
+        return true;
+    }
+
+    /// @brief Steps since the last call
+    int32_t read_increment() {
+        uint32_t position = this->position.load(std::memory_order_relaxed);
+        auto increment = static_cast<int32_t>(position - last_read);
+        last_read = position;
+        return increment;
+    }
+
+    uint32_t get_invalid() const { return decoder.get_invalid(); }
+
+  private:
+    EncoderAcceleration acceleration;
+    QuadratureDecoder decoder;
+    int8_t last_direction = 0;
+    uint32_t last_tick = 0;
+    std::atomic<uint32_t> position{0}; // writer: process()
+    uint32_t last_read = 0;            // owner: read_increment()
+};
@@ -1,7 +1,39 @@
 #pragma once
 
+#include "freq_tables.hpp"
 #include "models.hpp"
-#include <daisy_seed.h>
+#include <cmath>
+#include <cstdint>
+
+/**
+ * @brief Configuration of the ChaosOsc health watchdog.
+ * The watchdog is disabled as long as no seeds are provided.
+ */
+template <typename State> struct ChaosWatchdog {
+  /// @brief Center of the escape sphere
+  State center;
+  /// @brief Squared radius beyond which the state is considered diverged
+  float escape_radius_sq = 0.0f;
+  /// @brief Squared distance between two consecutive checks below which the state is still
+  float min_motion_sq = 0.0f;
+  /// @brief Consecutive still checks after which the state is considered collapsed; 0 disables
+  /// the collapse check, e.g. where the model has no attractor to be brought back to
+  uint32_t collapse_checks = 1;
+  /// @brief Known on-attractor states, used in turn to reseed the oscillator
+  const State *seeds = nullptr;
+  size_t num_seeds = 0;
+};
+
+/// @brief Watchdog counters, for telemetry
+struct ChaosOscStats {
+  /// @brief Reseeds caused by a non-finite or escaped state
+  uint32_t diverged = 0;
+  /// @brief Reseeds caused by a state collapsed onto a fixed point
+  uint32_t collapsed = 0;
+};
+
+/// @brief Default bound on the integration steps per output sample
+constexpr uint32_t DEFAULT_MAX_STEPS_PER_SAMPLE = 16;
 
 template <typename M> class ChaosOsc {
 private:
@@ -12,30 +44,38 @@ private:
   float freq_multiplier;
   /// @brief Maximum time step allowed for the discretized model
   float max_dt;
-  /// @brief Ratio between desired time step and max_dt
-  float dt_overshoot;
-
-  void recalculate_params() {
-    float new_dt = freq_multiplier / sampling_frequency;
-
-    if (new_dt <= max_dt) {
-      model.dt = new_dt;
-      dt_overshoot = 0.0;
-    } else {
-      model.dt = max_dt;
-      dt_overshoot = (new_dt / max_dt);
-    }
-  }
+  /// @brief Maximum number of integration steps per output sample
+  uint32_t max_steps_per_sample;
+  /// @brief Model time covered by one output sample at nominal rate
+  float sample_dt;
+  /// @brief Model time still to be integrated
+  float pending_time = 0.0f;
+  /// @brief Integration steps taken by the last sample
+  uint32_t last_steps = 0;
+
+  ChaosWatchdog<typename M::StateType> watchdog;
+  ChaosOscStats stats;
+  /// @brief State at the previous health check
+  typename M::StateType last_checked;
+  uint32_t still_checks = 0;
+  size_t next_seed = 0;
+
+  /// Steps may exceed max_dt by this fraction, so that rounding errors in the accumulated time
+  /// do not cost an extra step
+  static constexpr float STEP_SLACK = 1e-3f;
+
+  void recalculate_params() { sample_dt = freq_multiplier / sampling_frequency; }
 
 public:
   math::DiscretizedModel<M> model;
   typename M::StateType state;
 
   ChaosOsc(M model, typename M::StateType initial_state, float sampling_frequency,
-           float freq_multiplier, float max_dt = math::DEFAULT_DT)
-      : sampling_frequency(sampling_frequency),
-        freq_multiplier(freq_multiplier), max_dt(max_dt), model{model, 0.0f},
-        state(initial_state) {
+           float freq_multiplier, float max_dt = math::DEFAULT_DT,
+           uint32_t max_steps_per_sample = DEFAULT_MAX_STEPS_PER_SAMPLE)
+      : sampling_frequency(sampling_frequency), freq_multiplier(freq_multiplier), max_dt(max_dt),
+        max_steps_per_sample(max_steps_per_sample), last_checked(initial_state),
+        model{model, 0.0f}, state(initial_state) {
     recalculate_params();
   }
 
@@ -49,21 +89,119 @@ public:
     recalculate_params();
   }
 
-  void set_max_dt(float new_max_dt) {
-    max_dt = new_max_dt;
-    recalculate_params();
+  /**
+   * @brief Sets the time scale so that the mean rotation of the model runs at `frequency` Hz,
+   * whatever its current parameters (see math/freq_tables.hpp).
+   * Costs one table interpolation: meant to be called once per block, e.g. from a 1V/oct CV.
+   */
+  void set_frequency(float frequency) {
+    constexpr float TWO_PI = 6.28318530718f;
+    set_frequency_multiplier(TWO_PI * frequency / math::intrinsic_omega(model.model));
+  }
+
+  void set_max_dt(float new_max_dt) { max_dt = new_max_dt; }
+
+  /// @brief Bounds the cost of a sample (see `step()`).
+  void set_max_steps_per_sample(uint32_t new_max_steps) {
+    max_steps_per_sample = math::max<uint32_t>(1, new_max_steps);
   }
 
   void set_model(M new_model) { model.model = new_model; }
 
-  [[nodiscard]] float get_dt_overshoot() const { return dt_overshoot; }
+  /// @brief Applies a parameter snapshot, leaving the rest of the model untouched.
+  void set_params(const typename M::Params &params) {
+    static_cast<typename M::Params &>(model.model) = params;
+  }
+
+  void set_watchdog(const ChaosWatchdog<typename M::StateType> &new_watchdog) {
+    watchdog = new_watchdog;
+    last_checked = state;
+    still_checks = 0;
+    next_seed = 0;
+  }
+
+  /// @brief Replaces the seeds of the watchdog, e.g. with those verified for new parameters.
+  void set_seeds(const typename M::StateType *seeds, size_t num_seeds) {
+    watchdog.seeds = seeds;
+    watchdog.num_seeds = num_seeds;
+    next_seed = 0;
+  }
+
+  /// @brief Changes the collapse criterion of the watchdog (see ChaosWatchdog::collapse_checks).
+  void set_collapse_checks(uint32_t checks) {
+    watchdog.collapse_checks = checks;
+    still_checks = 0;
+  }
+
+  [[nodiscard]] const ChaosOscStats &get_stats() const { return stats; }
+
+  /// @brief Moves the oscillator to a given state, e.g. one saved by a previous session.
+  void set_state(const typename M::StateType &new_state) {
+    state = new_state;
+    last_checked = new_state;
+    still_checks = 0;
+    pending_time = 0.0f;
+  }
+
+  /// @brief Moves the state to the next seed of the watchdog.
+  void reseed() {
+    if (watchdog.num_seeds == 0)
+      return;
+
+    state = watchdog.seeds[next_seed];
+    next_seed = (next_seed + 1) % watchdog.num_seeds;
+    last_checked = state;
+    still_checks = 0;
+  }
+
+  /**
+   * @brief Health check, meant to be called once per block: reseeds the oscillator if its
+   * state is NaN/Inf, outside the escape radius, or has not moved for `collapse_checks` checks.
+   * @return true if the oscillator has been reseeded
+   */
+  bool check_health() {
+    if (watchdog.num_seeds == 0)
+      return false;
+
+    auto offset = state - watchdog.center;
+    float radius_sq = math::dot(offset, offset);
+
+    // NaN/Inf in any component propagates to radius_sq
+    if (!math::is_finite(radius_sq) || radius_sq > watchdog.escape_radius_sq) {
+      stats.diverged++;
+      reseed();
+      return true;
+    }
+
+    auto motion = state - last_checked;
+    last_checked = state;
+
+    if (watchdog.collapse_checks > 0 && math::dot(motion, motion) < watchdog.min_motion_sq) {
+      if (++still_checks >= watchdog.collapse_checks) {
+        stats.collapsed++;
+        reseed();
+        return true;
+      }
+    } else {
+      still_checks = 0;
+    }
+
+    return false;
+  }
+
+  /// @brief Model time covered by one output sample at nominal rate.
+  [[nodiscard]] float get_sample_dt() const { return sample_dt; }
 
   const M &get_model() const { return model.model; }
 
   M &get_model() { return model.model; }
 
+  /// @brief Integration step used for the last sample.
   [[nodiscard]] float get_dt() const { return model.dt; }
 
+  /// @brief Integration steps taken by the last sample.
+  [[nodiscard]] uint32_t get_last_steps() const { return last_steps; }
+
   void reset(float new_sampling_frequency, float new_frequency_multiplier,
              float new_max_dt) {
     sampling_frequency = new_sampling_frequency;
@@ -72,24 +210,37 @@ public:
     recalculate_params();
   }
 
-  typename M::StateType step() {
-    if (dt_overshoot == 0.0) {
-      state = model.step(state);
-    } else {
-      auto overshoot = static_cast<size_t>(truncf(dt_overshoot));
+  /**
+   * @brief Advances the oscillator by one output sample.
+   *
+   * The model time of the sample, `rate` times the nominal one, is added to an accumulator that
+   * is integrated in equal steps of at most max_dt: each sample lands exactly on its model time
+   * whatever the ratio between the two, and `rate` may change at every sample (audio-rate
+   * modulation of the time step). At most `max_steps_per_sample` steps are taken; time beyond
+   * this budget is carried over to the next samples, up to one sample's budget, and the rest is
+   * dropped.
+   *
+   * @param rate time scale of this sample, clamped to be non-negative
+   */
+  typename M::StateType step(float rate = 1.0f) {
+    pending_time += sample_dt * math::max(rate, 0.0f);
+    if (pending_time <= 0.0f) {
+      last_steps = 0;
+      return state;
+    }
 
-      // step 'overshoot' times using max_dt
-      for (size_t k = overshoot; k > 0; k--) {
-        state = model.step(state);
-      }
+    float steps_needed = ceilf(pending_time / (max_dt * (1.0f + STEP_SLACK)));
+    uint32_t steps = math::min(static_cast<uint32_t>(steps_needed), max_steps_per_sample);
+    float dt = math::min(pending_time / static_cast<float>(steps), max_dt * (1.0f + STEP_SLACK));
 
-      // do a single step with the remaining dt
-      float remainder_dt = dt_overshoot - static_cast<float>(overshoot) * max_dt;
-      model.dt = remainder_dt;
+    model.dt = dt;
+    last_steps = steps;
+    for (uint32_t k = 0; k < steps; k++) {
       state = model.step(state);
-      model.dt = max_dt;
     }
 
+    pending_time -= dt * static_cast<float>(steps);
+    pending_time = math::min(pending_time, max_dt * static_cast<float>(max_steps_per_sample));
     return state;
   }
 };
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "vecmath.hpp"
+
+namespace math {
+
+/**
+ * @brief Random bits and uniform samples from a chaotic map, for noise and random gates.
+ *
+ * Each iteration of the map yields the 16 low mantissa bits of every component, the bits which
+ * depend most on the whole history of the trajectory, packed in pairs into 32-bit words. These
+ * bits are not uniform by themselves (the invariant density of the map shows through), so they
+ * are whitened: each word is offset by a Weyl sequence, which also rules out the short cycles a
+ * map iterated in finite precision may fall into, then mixed by the MurmurHash3 finalizer.
+ *
+ * Meets the requirements of UniformRandomBitGenerator, so that it can drive the distributions of
+ * <random> on host. Not cryptographically secure: the whitening is invertible and the state of
+ * the map is small.
+ *
+ * @tparam M discrete model with a float state of even dimension (e.g. `Crypto`)
+ */
+template <class M> class ChaosRng {
+  public:
+    using result_type = uint32_t;
+    using State = typename M::StateType;
+
+    static_assert(State::size() % 2 == 0, "the state is packed in pairs of components");
+    static constexpr size_t WORDS = State::size() / 2;
+    /// Iterations after seeding, for a perturbation of the seed state to reach the output bits
+    static constexpr size_t WARMUP = 64;
+
+    ChaosRng(const M &model, const State &state, uint32_t seed = 0) : model(model) {
+        reseed(state, seed);
+    }
+
+    /**
+     * @brief Restarts the map from `state`, perturbed according to `seed`: distinct seeds give
+     * unrelated sequences.
+     */
+    void reseed(const State &new_state, uint32_t seed) {
+        state = new_state;
+        for (size_t k = 0; k < State::size(); k++) {
+            uint32_t bits = mix(seed + static_cast<uint32_t>(k + 1) * WEYL_STEP);
+            state[k] += 1e-3f * (static_cast<float>(bits >> 8) * 0x1p-24f - 0.5f);
+        }
+        weyl = mix(seed);
+        for (size_t i = 0; i < WARMUP; i++)
+            state = model.step(state);
+        next = WORDS;
+    }
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return UINT32_MAX; }
+
+    result_type operator()() {
+        if (next == WORDS)
+            refill();
+        return words[next++];
+    }
+
+    /// @brief Uniform in [0, 1), with 24 random bits
+    float uniform() { return static_cast<float>(operator()() >> 8) * 0x1p-24f; }
+
+    /// @brief Uniform in [-1, 1)
+    float bipolar() { return 2.0f * uniform() - 1.0f; }
+
+    /// @brief true with probability `p`, e.g. to fire a random gate
+    bool bernoulli(float p) { return uniform() < p; }
+
+    void fill(uint32_t *out, size_t size) {
+        for (size_t i = 0; i < size; i++)
+            out[i] = operator()();
+    }
+
+    void fill_uniform(float *out, size_t size) {
+        for (size_t i = 0; i < size; i++)
+            out[i] = uniform();
+    }
+
+    [[nodiscard]] const State &get_state() const { return state; }
+
+  private:
+    /// 2^32 / golden ratio: the Weyl sequence visits every word before repeating
+    static constexpr uint32_t WEYL_STEP = 0x9E3779B9u;
+
+    M model;
+    State state;
+    uint32_t weyl = 0;
+    std::array<uint32_t, WORDS> words{};
+    size_t next = WORDS;
+
+    /// @brief MurmurHash3 finalizer: every input bit flips each output bit with probability 1/2
+    static uint32_t mix(uint32_t h) {
+        h ^= h >> 16;
+        h *= 0x85EBCA6Bu;
+        h ^= h >> 13;
+        h *= 0xC2B2AE35u;
+        h ^= h >> 16;
+        return h;
+    }
+
+    static uint32_t low_bits(float x) {
+        uint32_t bits;
+        std::memcpy(&bits, &x, sizeof(bits));
+        return bits & 0xFFFFu;
+    }
+
+    void refill() {
+        state = model.step(state);
+        for (size_t i = 0; i < WORDS; i++) {
+            uint32_t raw = low_bits(state[2 * i]) | low_bits(state[2 * i + 1]) << 16;
+            weyl += WEYL_STEP;
+            words[i] = mix(raw + weyl);
+        }
+        next = 0;
+    }
+};
+
+} // namespace math
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace math {
+
+/**
+ * @brief Cascaded integrator-comb decimator for unsigned 16-bit samples: ORDER moving averages
+ * of RATIO samples, decimated by RATIO, with unity DC gain.
+ *
+ * Costs ORDER additions per input sample and ORDER subtractions per output sample, with no
+ * multiplication. Registers wrap around, which is harmless in a CIC as long as they hold the
+ * ORDER * log2(RATIO) + 16 bits of the output.
+ */
+template <size_t ORDER, uint32_t RATIO> class CicDecimator {
+  public:
+    static_assert(ORDER >= 1, "");
+    static_assert(RATIO >= 2 && (RATIO & (RATIO - 1)) == 0, "RATIO must be a power of two");
+
+    static constexpr uint32_t ilog2(uint32_t x) { return x > 1 ? 1 + ilog2(x >> 1) : 0; }
+    static constexpr uint32_t GAIN_BITS = ORDER * ilog2(RATIO);
+    static_assert(GAIN_BITS + 16 <= 32, "registers would overflow");
+
+    /// @brief Group delay, in input samples
+    static constexpr float DELAY = ORDER * (RATIO - 1) / 2.0f;
+
+    /// @brief Starts from a steady input `value`, e.g. the first sample, to skip the transient.
+    void reset(uint16_t value = 0) {
+        integrators.fill(0);
+        combs.fill(0);
+        phase = 0;
+        // The impulse response spans ORDER * RATIO samples
+        for (uint32_t i = 0; i < ORDER * RATIO; i++)
+            process(value);
+    }
+
+    /**
+     * @brief Feeds one input sample.
+     * @return true when a new output sample is available (one call out of RATIO)
+     */
+    bool process(uint16_t sample) {
+        uint32_t value = sample;
+        for (auto &integrator : integrators)
+            value = integrator += value;
+
+        if (++phase < RATIO)
+            return false;
+        phase = 0;
+
+        for (auto &comb : combs) {
+            uint32_t delayed = comb;
+            comb = value;
+            value -= delayed;
+        }
+        output = static_cast<uint16_t>(value >> GAIN_BITS);
+        return true;
+    }
+
+    /// @brief Last output sample
+    uint16_t get() const { return output; }
+
+  private:
+    std::array<uint32_t, ORDER> integrators{};
+    std::array<uint32_t, ORDER> combs{};
+    uint32_t phase = 0;
+    uint16_t output = 0;
+};
+
+/**
+ * @brief Holds a value until the input moves away from it by more than a threshold: removes the
+ * residual flicker of a filtered control value. The held value jumps to the input, but may then
+ * stay up to `threshold` away from it at rest, e.g. when the input settles after a slow move.
+ */
+class Hysteresis {
+  public:
+    explicit Hysteresis(uint16_t threshold = 0) : threshold(threshold) {}
+
+    /// @return true if the held value changed
+    bool process(uint16_t value) {
+        uint16_t distance = value > held ? value - held : held - value;
+        if (distance <= threshold)
+            return false;
+        held = value;
+        return true;
+    }
+
+    void reset(uint16_t value) { held = value; }
+
+    uint16_t get() const { return held; }
+
+  private:
+    uint16_t threshold;
+    uint16_t held = 0;
+};
+
+/**
+ * @brief Conditioning of a control voltage acquired at a high rate: CIC decimation to the control
+ * rate, then hysteresis.
+ */
+template <size_t ORDER, uint32_t RATIO> class CvFilter {
+  public:
+    explicit CvFilter(uint16_t hysteresis = 0) : hysteresis(hysteresis) {}
+
+    /**
+     * @brief Feeds one acquired sample.
+     * @return true when the control value changed
+     */
+    bool process(uint16_t sample) {
+        return decimator.process(sample) && hysteresis.process(decimator.get());
+    }
+
+    /// @brief Control value: filtered, decimated and stable
+    uint16_t get() const { return hysteresis.get(); }
+
+    void reset(uint16_t value) {
+        decimator.reset(value);
+        hysteresis.reset(value);
+    }
+
+  private:
+    CicDecimator<ORDER, RATIO> decimator;
+    Hysteresis hysteresis;
+};
+
+} // namespace math
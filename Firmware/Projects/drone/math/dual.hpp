@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cmath>
+
+#include "vecmath.hpp"
+
+namespace math {
+/**
+ * @brief Dual number `v + d ε`, with `ε² = 0`, for forward-mode automatic differentiation.
+ *
+ * Evaluating a function on `x + v ε` yields `f(x) + (J(x) v) ε`: the Jacobian-vector product
+ * comes out of a single evaluation, exact up to rounding (no step size as in finite differences).
+ * Operators are hidden friends, so scalars (including integer literals) convert implicitly.
+ */
+template <class T> struct dual {
+    /// @brief Value
+    T v;
+    /// @brief Derivative (tangent) part
+    T d;
+
+    constexpr dual() : v(0), d(0) {}
+    constexpr dual(T value) : v(value), d(0) {}
+    constexpr dual(T value, T derivative) : v(value), d(derivative) {}
+
+    friend dual operator+(dual a, dual b) { return {a.v + b.v, a.d + b.d}; }
+    friend dual operator-(dual a, dual b) { return {a.v - b.v, a.d - b.d}; }
+    friend dual operator-(dual a) { return {-a.v, -a.d}; }
+    friend dual operator*(dual a, dual b) { return {a.v * b.v, a.v * b.d + a.d * b.v}; }
+    friend dual operator/(dual a, dual b) {
+        return {a.v / b.v, (a.d * b.v - a.v * b.d) / (b.v * b.v)};
+    }
+
+    friend dual &operator+=(dual &a, dual b) { return a = a + b; }
+    friend dual &operator-=(dual &a, dual b) { return a = a - b; }
+    friend dual &operator*=(dual &a, dual b) { return a = a * b; }
+    friend dual &operator/=(dual &a, dual b) { return a = a / b; }
+
+    friend bool operator<(dual a, dual b) { return a.v < b.v; }
+    friend bool operator>(dual a, dual b) { return a.v > b.v; }
+
+    // Elementary functions, found by ADL from templated models
+    friend dual fabs(dual a) { return a.v < 0 ? -a : a; }
+    friend dual sqrt(dual a) {
+        T s = std::sqrt(a.v);
+        return {s, a.d / (2 * s)};
+    }
+    friend dual sin(dual a) { return {std::sin(a.v), a.d * std::cos(a.v)}; }
+    friend dual cos(dual a) { return {std::cos(a.v), -a.d * std::sin(a.v)}; }
+};
+
+using dualf = dual<float>;
+
+/**
+ * @brief Jacobian-vector product `J(x) v` of a model's vector field, in one evaluation.
+ *
+ * @tparam M a model providing `template <class S> vec<N, S> field(vec<N, S>) const`
+ */
+template <class M, size_t N, class T> vec<N, T> jvp(const M &model, vec<N, T> x, vec<N, T> v) {
+    vec<N, dual<T>> xd;
+    for (size_t i = 0; i < N; i++) {
+        xd[i] = dual<T>(x[i], v[i]);
+    }
+
+    vec<N, dual<T>> fd = model.field(xd);
+
+    vec<N, T> res;
+    for (size_t i = 0; i < N; i++) {
+        res[i] = fd[i].d;
+    }
+    return res;
+}
+
+/**
+ * @brief Jacobian of a model's vector field, computed column by column with `jvp()`.
+ */
+template <class M, size_t N, class T> mat<N, T> jacobian(const M &model, vec<N, T> x) {
+    mat<N, T> res;
+    for (size_t j = 0; j < N; j++) {
+        vec<N, T> e;
+        for (size_t i = 0; i < N; i++) {
+            e[i] = i == j ? T(1) : T(0);
+        }
+
+        vec<N, T> column = jvp(model, x, e);
+        for (size_t i = 0; i < N; i++) {
+            res[i][j] = column[i];
+        }
+    }
+    return res;
+}
+} // namespace math
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+/**
+ * Approximations of the transcendental functions used in the model hot paths.
+ *
+ * Build with -DFASTMATH_ENABLED=0 to fall back to the exact libm functions everywhere they are
+ * used, e.g. to tell an approximation artifact from a model artifact.
+ * Error bounds below are measured by tools/fastmath_bench.cpp.
+ */
+#ifndef FASTMATH_ENABLED
+#define FASTMATH_ENABLED 1
+#endif
+
+namespace math::fast {
+
+constexpr bool ENABLED = FASTMATH_ENABLED;
+
+namespace _internal {
+    // pi/2 split in three parts (Cody-Waite), the first ones exactly representable with few bits,
+    // so that `x - q * pi/2` stays exact for |q| < 2^11
+    constexpr float PIO2_HI = 1.5703125f;
+    constexpr float PIO2_MID = 4.837512969970703125e-4f;
+    constexpr float PIO2_LO = 7.549789954891882e-8f;
+    constexpr float TWO_OVER_PI = 0.636619772367581f;
+
+    // Minimax polynomials on [-pi/4, pi/4]
+    inline float sin_poly(float r, float r2) {
+        return r + r * r2 * (-1.6666654611e-1f + r2 * (8.3321608736e-3f + r2 * -1.9515295891e-4f));
+    }
+
+    inline float cos_poly(float r2) {
+        return 1.0f - 0.5f * r2 +
+               r2 * r2 * (4.166664568298827e-2f + r2 * (-1.388731625493765e-3f +
+                                                        r2 * 2.443315711809948e-5f));
+    }
+} // namespace _internal
+
+/**
+ * @brief Sine and cosine of the same angle, sharing the range reduction.
+ * Max absolute error 1.2e-7 for |x| < 1000 (degrades linearly beyond, as the reduction loses bits).
+ */
+inline void sincos(float x, float &s, float &c) {
+    if constexpr (!ENABLED) {
+        s = sinf(x);
+        c = cosf(x);
+        return;
+    }
+
+    using namespace _internal;
+
+    // Reduce to r in [-pi/4, pi/4] and the quadrant q
+    float q = nearbyintf(x * TWO_OVER_PI);
+    float r = ((x - q * PIO2_HI) - q * PIO2_MID) - q * PIO2_LO;
+    float r2 = r * r;
+
+    float sr = sin_poly(r, r2), cr = cos_poly(r2);
+    switch (static_cast<int32_t>(q) & 3) {
+    case 0: s = sr, c = cr; break;
+    case 1: s = cr, c = -sr; break;
+    case 2: s = -sr, c = -cr; break;
+    default: s = -cr, c = sr; break;
+    }
+}
+
+/// @brief Max absolute error 1.2e-7 for |x| < 1000.
+inline float sin(float x) {
+    float s, c;
+    sincos(x, s, c);
+    return s;
+}
+
+/// @brief Max absolute error 1.2e-7 for |x| < 1000.
+inline float cos(float x) {
+    float s, c;
+    sincos(x, s, c);
+    return c;
+}
+
+/**
+ * @brief 1 / sqrt(x) for positive normal x: bit-level initial guess and two Newton steps.
+ * Max relative error 4.8e-6.
+ */
+inline float rsqrt(float x) {
+    if constexpr (!ENABLED)
+        return 1.0f / sqrtf(x);
+
+    uint32_t bits;
+    memcpy(&bits, &x, sizeof(bits));
+    bits = 0x5f3759dfu - (bits >> 1);
+
+    float y;
+    memcpy(&y, &bits, sizeof(y));
+    float half_x = 0.5f * x;
+    y = y * (1.5f - half_x * y * y);
+    y = y * (1.5f - half_x * y * y);
+    return y;
+}
+
+} // namespace math::fast
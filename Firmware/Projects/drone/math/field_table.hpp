@@ -0,0 +1,176 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstring>
+
+#include "models.hpp"
+#include "vecmath.hpp"
+
+namespace math {
+
+/**
+ * @brief Function of a state sampled on a regular grid over a box, evaluated by multilinear
+ * interpolation (bilinear for 2D states, trilinear for 3D ones).
+ *
+ * Meant for vector fields and maps which are expensive to evaluate: a lookup blends the 2^D grid
+ * points around the state, for a cost which does not depend on the function. The error is that
+ * of linear interpolation, proportional to the curvature of the function times the square of
+ * the grid spacing. States outside the box are clamped onto it: use `contains()` to fall back to
+ * the function there.
+ *
+ * The grid is filled by `build()`, a bounded number of points per call if needed, so that
+ * building it can be spread over several output blocks.
+ *
+ * @tparam State vector type (e.g. `vec3f`) of both the argument and the value
+ * @tparam N grid points per axis
+ */
+template <class State, size_t N> class FieldTable {
+  public:
+    static_assert(N >= 2, "N must be at least 2");
+    using Base = typename State::Base;
+
+    static constexpr size_t DIM = State::size();
+
+    /// @brief Distance between neighbouring grid points along axis k, in the table
+    static constexpr size_t stride(size_t k) {
+        size_t points = 1;
+        for (size_t i = 0; i < k; i++)
+            points *= N;
+        return points;
+    }
+    static constexpr size_t POINTS = stride(DIM);
+
+    FieldTable() = default;
+    FieldTable(const State &min, const State &max) { set_bounds(min, max); }
+
+    /// @brief Sets the box covered by the grid, and empties it.
+    void set_bounds(const State &new_min, const State &new_max) {
+        min = new_min;
+        max = new_max;
+        for (size_t k = 0; k < DIM; k++) {
+            spacing[k] = (max[k] - min[k]) / static_cast<Base>(N - 1);
+            inv_spacing[k] = Base(1) / spacing[k];
+        }
+        invalidate();
+    }
+
+    /// @brief Empties the grid, e.g. when the sampled function changes.
+    void invalidate() { built = 0; }
+
+    /**
+     * @brief Samples `f` at the next `count` grid points.
+     * @return true once every point of the grid is sampled
+     */
+    template <class F> bool build(F &&f, size_t count = POINTS) {
+        for (; built < POINTS && count > 0; built++, count--) {
+            State x;
+            size_t index = built;
+            for (size_t k = 0; k < DIM; k++) {
+                x[k] = min[k] + static_cast<Base>(index % N) * spacing[k];
+                index /= N;
+            }
+            values[built] = f(x);
+        }
+        return is_built();
+    }
+
+    [[nodiscard]] bool is_built() const { return built == POINTS; }
+
+    /// @brief Grid points sampled so far, out of POINTS
+    [[nodiscard]] size_t get_progress() const { return built; }
+
+    [[nodiscard]] bool contains(const State &x) const {
+        bool inside = true;
+        for (size_t k = 0; k < DIM; k++)
+            inside &= x[k] >= min[k] && x[k] <= max[k];
+        return inside;
+    }
+
+    /// @brief Interpolated value at `x`; only once `is_built()`.
+    [[gnu::flatten]] State operator()(const State &x) const {
+        size_t index = 0;
+        std::array<Base, DIM> t;
+        for (size_t k = 0; k < DIM; k++) {
+            Base u = clamp((x[k] - min[k]) * inv_spacing[k], Base(0), Base(N - 1));
+            auto i = static_cast<size_t>(static_cast<int32_t>(u));
+            i = i < N - 2 ? i : N - 2;
+            t[k] = u - static_cast<Base>(i);
+            index += i * stride(k);
+        }
+        return blend<DIM - 1>(index, t);
+    }
+
+  private:
+    State min, max, spacing, inv_spacing;
+    /// Axis 0 varies fastest
+    std::array<State, POINTS> values;
+    size_t built = 0;
+
+    /// @brief Blends the 2^(K+1) grid points from `index` along the axes K to 0; unrolled at
+    /// compile time.
+    template <size_t K> State blend(size_t index, const std::array<Base, DIM> &t) const {
+        if constexpr (K == 0) {
+            return lerp(t[0], values[index], values[index + 1]);
+        } else {
+            return lerp(t[K], blend<K - 1>(index, t), blend<K - 1>(index + stride(K), t));
+        }
+    }
+};
+
+/**
+ * @brief Continuous model M whose gradient is read from a FieldTable sampling M's own gradient
+ * over a box, for models whose vector field costs more than a trilinear lookup.
+ *
+ * The parameters are M's, and may be changed in place (see `ChaosOsc::set_params()`): `update()`
+ * notices the change and rebuilds the table, `count` grid points per call, so that it can be
+ * called once per output block. Until the table is complete, and outside its box, the exact
+ * gradient is used. The Jacobian (for ROS2) stays the exact one.
+ *
+ * @tparam M 3D continuous model
+ * @tparam N grid points per axis: the table takes N^3 states
+ */
+template <class M, size_t N> class TabulatedModel : public M {
+  public:
+    using StateType = typename M::StateType;
+    using Time = typename M::Time;
+    using Params = typename M::Params;
+    using Table = FieldTable<StateType, N>;
+
+    TabulatedModel() = default;
+    TabulatedModel(const StateType &min, const StateType &max) { table.set_bounds(min, max); }
+
+    void set_bounds(const StateType &min, const StateType &max) { table.set_bounds(min, max); }
+
+    /**
+     * @brief Rebuilds the table if the parameters changed, sampling up to `count` grid points.
+     * Call it after changing the parameters and before the next steps.
+     * @return true once the table matches the current parameters
+     */
+    bool update(size_t count = Table::POINTS) {
+        const Params &params = *this;
+        if (table.get_progress() > 0 && std::memcmp(&params, &table_params, sizeof(Params)) != 0)
+            table.invalidate();
+        if (table.get_progress() == 0)
+            table_params = params;
+        return table.build([this](StateType x) { return M::gradient(x); }, count);
+    }
+
+    [[nodiscard]] bool is_tabulated() const { return table.is_built(); }
+
+    StateType gradient(StateType x) const override {
+        if (table.is_built() && table.contains(x))
+            return table(x);
+        return M::gradient(x);
+    }
+
+    StateType rk4_step(StateType x, const rk4_coeffs<Time> &c) const override {
+        return rk4_fused(*this, x, c);
+    }
+
+  private:
+    Table table;
+    Params table_params;
+};
+
+} // namespace math
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+
+#include "vecmath.hpp"
+
+namespace math {
+
+/**
+ * @brief Mean angular frequency of a model (rad per unit of model time), sampled uniformly
+ * over one of its parameters. Tables are generated by tools/gen_freq_tables.cpp.
+ */
+struct FreqTable {
+    float param_min, param_max;
+    const float *omega;
+    size_t size;
+
+    /// @brief Linear interpolation, clamped to the ends of the table; the first entry for a NaN
+    /// parameter.
+    [[nodiscard]] float lookup(float param) const {
+        float pos = (param - param_min) / (param_max - param_min) * static_cast<float>(size - 1);
+        // Written so that NaN compares false and lands on 0: converting it to size_t is undefined
+        pos = pos > 0.0f ? math::min(pos, static_cast<float>(size - 1)) : 0.0f;
+
+        auto i = math::min(static_cast<size_t>(pos), size - 2);
+        float frac = pos - static_cast<float>(i);
+        return omega[i] + frac * (omega[i + 1] - omega[i]);
+    }
+};
+
+/// @brief Frequency in Hz of a 1V/oct control voltage, `volts` octaves above `base_frequency`.
+inline float volts_to_frequency(float volts, float base_frequency) {
+    return base_frequency * exp2f(volts);
+}
+
+} // namespace math
@@ -0,0 +1,75 @@
+#pragma once
+
+// Generated by tools/gen_freq_tables.cpp, do not edit.
+
+#include "freq_table.hpp"
+#include "models.hpp"
+
+namespace math {
+
+/// Mean angular frequency of Chua vs alpha in [15, 19], smoothed
+inline constexpr float CHUA_OMEGA[] = {
+    5.1873f, 5.1743f, 5.1620f, 5.1501f, 5.1377f, 5.1255f, 5.1138f, 5.1016f,
+    5.0895f, 5.0779f, 5.0660f, 5.0539f, 5.0431f, 5.0355f, 5.0319f, 5.0298f,
+    5.0274f, 5.0241f, 5.0193f, 5.0152f, 5.0138f, 5.0191f, 5.0301f, 5.0430f,
+    5.0673f, 5.0954f, 5.1161f, 5.1451f, 5.1643f, 5.1553f, 5.1640f, 5.2095f,
+    5.2558f
+};
+inline constexpr FreqTable CHUA_FREQ_TABLE{15.0000f, 19.0000f, CHUA_OMEGA, 33};
+inline float intrinsic_omega(const Chua &m) {
+    return CHUA_FREQ_TABLE.lookup(m.alpha);
+}
+
+/// Mean angular frequency of Sprott vs a in [1.8, 2.4], smoothed
+inline constexpr float SPROTT_OMEGA[] = {
+    0.2031f, 0.2039f, 0.2062f, 0.2132f, 0.2253f, 0.2414f, 0.2614f, 0.2761f,
+    0.2812f, 0.2923f, 0.3133f, 0.3254f, 0.3272f, 0.3284f, 0.3297f, 0.3308f,
+    0.3319f, 0.3330f, 0.3341f, 0.3351f, 0.3354f, 0.3254f, 0.3053f, 0.2953f,
+    0.2955f, 0.2964f, 0.2976f, 0.2983f, 0.2989f, 0.3000f, 0.3022f, 0.3038f,
+    0.3041f
+};
+inline constexpr FreqTable SPROTT_FREQ_TABLE{1.8000f, 2.4000f, SPROTT_OMEGA, 33};
+inline float intrinsic_omega(const Sprott &m) {
+    return SPROTT_FREQ_TABLE.lookup(m.a);
+}
+
+/// Mean angular frequency of Rossler vs c in [4, 12], smoothed
+inline constexpr float ROSSLER_OMEGA[] = {
+    1.0850f, 1.0823f, 1.0800f, 1.0790f, 1.0786f, 1.0778f, 1.0765f, 1.0747f,
+    1.0731f, 1.0719f, 1.0700f, 1.0677f, 1.0655f, 1.0639f, 1.0633f, 1.0631f,
+    1.0629f, 1.0628f, 1.0629f, 1.0629f, 1.0629f, 1.0621f, 1.0601f, 1.0554f,
+    1.0355f, 1.0018f, 0.9807f, 0.9767f, 0.9734f, 0.9672f, 0.9628f, 0.9621f,
+    0.9660f
+};
+inline constexpr FreqTable ROSSLER_FREQ_TABLE{4.0000f, 12.0000f, ROSSLER_OMEGA, 33};
+inline float intrinsic_omega(const Rossler &m) {
+    return ROSSLER_FREQ_TABLE.lookup(m.c);
+}
+
+/// Mean angular frequency of Halvorsen vs a in [1.3, 2.1], smoothed
+inline constexpr float HALVORSEN_OMEGA[] = {
+    4.1945f, 4.1862f, 4.1834f, 4.1832f, 4.1831f, 4.1831f, 4.1831f, 4.1865f,
+    4.1931f, 4.1946f, 4.1908f, 4.1691f, 4.1002f, 4.0115f, 3.9611f, 3.9505f,
+    3.9628f, 4.0065f, 4.0801f, 4.1454f, 4.1684f, 4.1636f, 4.1352f, 4.0722f,
+    3.9883f, 3.8936f, 3.7861f, 3.6620f, 3.5163f, 3.3405f, 3.1194f, 2.8166f,
+    2.4209f
+};
+inline constexpr FreqTable HALVORSEN_FREQ_TABLE{1.3000f, 2.1000f, HALVORSEN_OMEGA, 33};
+inline float intrinsic_omega(const Halvorsen &m) {
+    return HALVORSEN_FREQ_TABLE.lookup(m.a);
+}
+
+/// Mean angular frequency of Lorentz vs rho in [25, 60], smoothed
+inline constexpr float LORENTZ_OMEGA[] = {
+    7.6528f, 7.8921f, 8.1239f, 8.3464f, 8.5594f, 8.7663f, 8.9696f, 9.1686f,
+    9.3623f, 9.5545f, 9.7398f, 9.9160f, 10.0934f, 10.2713f, 10.4494f, 10.6267f,
+    10.7964f, 10.9586f, 11.1175f, 11.2740f, 11.4258f, 11.5739f, 11.7211f, 11.8671f,
+    12.0083f, 12.1422f, 12.2745f, 12.4110f, 12.5471f, 12.6803f, 12.8100f, 12.9332f,
+    13.0558f
+};
+inline constexpr FreqTable LORENTZ_FREQ_TABLE{25.0000f, 60.0000f, LORENTZ_OMEGA, 33};
+inline float intrinsic_omega(const Lorentz &m) {
+    return LORENTZ_FREQ_TABLE.lookup(m.rho);
+}
+
+} // namespace math
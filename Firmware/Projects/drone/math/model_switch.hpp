@@ -0,0 +1,118 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+
+#include "vecmath.hpp"
+
+/**
+ * @brief Seamless switching between chaotic oscillators.
+ *
+ * Selecting a new oscillator goes through two phases, each with a bounded cost per block:
+ * - PREROLL: the incoming oscillator is stepped in the background, at most
+ *   `preroll_steps_per_block` steps per block, so that its transient dies out before it is
+ *   heard. Oscillators that already reached their attractor (warm) skip this phase.
+ * - CROSSFADE: both oscillators are stepped and their outputs are linearly crossfaded.
+ *
+ * A block therefore never costs more than `max(size + preroll_steps_per_block, 2 * size)` steps.
+ * Selections requested during a switch are applied once the switch is over.
+ *
+ * @tparam N number of oscillators
+ */
+template <size_t N> class ModelSwitch {
+  public:
+    enum class Phase { STEADY, PREROLL, CROSSFADE };
+
+    ModelSwitch(size_t initial_model, size_t preroll_steps, size_t preroll_steps_per_block,
+                size_t crossfade_samples)
+        : active(initial_model), incoming(initial_model), requested(initial_model),
+          preroll_steps(preroll_steps), preroll_steps_per_block(preroll_steps_per_block),
+          fade_increment(1.0f / static_cast<float>(crossfade_samples)) {
+        warm.fill(false);
+    }
+
+    /// @brief Requests a switch to another oscillator.
+    void select(size_t model) { requested = model; }
+
+    /**
+     * @brief Makes an oscillator active at once, without preroll nor crossfade, and considers
+     * all oscillators warm: for states restored from a previous session, already on their
+     * attractors.
+     */
+    void resume(size_t model) {
+        active = incoming = requested = model;
+        phase = Phase::STEADY;
+        warm.fill(true);
+    }
+
+    /// @brief Forces the oscillator to be prerolled again before it is next selected
+    /// (e.g. after its state has been reset).
+    void invalidate(size_t model) { warm[model] = false; }
+
+    [[nodiscard]] Phase get_phase() const { return phase; }
+    [[nodiscard]] size_t get_active() const { return active; }
+
+    /**
+     * @brief Generates one block of output.
+     *
+     * @param step callable `T(size_t model)` advancing an oscillator by one output sample and
+     *        returning its normalized output
+     */
+    template <class T, class StepFn> void process(T *out, size_t size, StepFn &&step) {
+        if (phase == Phase::STEADY && requested != active) {
+            incoming = requested;
+            preroll_left = warm[incoming] ? 0 : preroll_steps;
+            phase = Phase::PREROLL;
+        }
+
+        for (size_t i = 0; i < size; i++) {
+            T value = step(active);
+
+            if (phase == Phase::CROSSFADE) {
+                T next = step(incoming);
+                fade += fade_increment;
+
+                if (fade >= 1.0f) {
+                    active = incoming;
+                    phase = Phase::STEADY;
+                    value = next;
+                } else {
+                    value = math::lerp(fade, value, next);
+                }
+            }
+
+            out[i] = value;
+        }
+
+        // the crossfade starts on the next block, so that a block never pays for both phases
+        if (phase == Phase::PREROLL) {
+            size_t steps = math::min(preroll_left, preroll_steps_per_block);
+
+            for (size_t k = 0; k < steps; k++) {
+                step(incoming);
+            }
+            preroll_left -= steps;
+
+            if (preroll_left == 0) {
+                warm[incoming] = true;
+                fade = 0.0f;
+                phase = Phase::CROSSFADE;
+            }
+        }
+
+        warm[active] = true;
+    }
+
+  private:
+    Phase phase = Phase::STEADY;
+    size_t active, incoming, requested;
+
+    size_t preroll_steps, preroll_steps_per_block;
+    size_t preroll_left = 0;
+
+    float fade = 0.0f;
+    float fade_increment;
+
+    /// Oscillators which already reached their attractor
+    std::array<bool, N> warm;
+};
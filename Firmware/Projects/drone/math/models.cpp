@@ -14,62 +14,115 @@ namespace math {
 
     // Chua
     vec3f Chua::gradient(vec3f pos) const {
-        float x = pos.x(), y = pos.y(), z = pos.z();
-        return {
-            alpha * (y - x - chua_diode(x)),
-            x - y + z,
-            -beta * y,
-        };
+        return field(pos);
     }
-    
-    float Chua::chua_diode(float x) const {
-        return m1 * x + 0.5f * (m0 - m1) * (fabs(x + 1) - fabs(x - 1));
+
+    mat3f Chua::jacobian(vec3f pos) const {
+        // the diode is piecewise linear: slope m0 inside [-1, 1], m1 outside
+        float slope = fabsf(pos.x()) < 1.0f ? m0 : m1;
+        mat3f j;
+        j[0] = vec3f{-alpha * (1.0f + slope), alpha, 0.0f};
+        j[1] = vec3f{1.0f, -1.0f, 1.0f};
+        j[2] = vec3f{0.0f, -beta, 0.0f};
+        return j;
+    }
+
+    [[gnu::flatten]] vec3f Chua::rk4_step(vec3f pos, const rk4_coeffs<float> &coeffs) const {
+        return rk4_fused(*this, pos, coeffs);
     }
 
     // Sprott
     vec3f Sprott::gradient(vec3f pos) const {
+        return field(pos);
+    }
+
+    mat3f Sprott::jacobian(vec3f pos) const {
         float x = pos.x(), y = pos.y(), z = pos.z();
-        return {
-            y + a*x*y + x*z,
-            1 - b*x*x + y*z,
-            x - x*x - y*y,
-        };
+        mat3f j;
+        j[0] = vec3f{a*y + z, 1 + a*x, x};
+        j[1] = vec3f{-2*b*x, z, y};
+        j[2] = vec3f{1 - 2*x, -2*y, 0.0f};
+        return j;
+    }
+
+    [[gnu::flatten]] vec3f Sprott::rk4_step(vec3f pos, const rk4_coeffs<float> &coeffs) const {
+        return rk4_fused(*this, pos, coeffs);
     }
      
     vec3f Lorentz::gradient(vec<3, float> pos) const {
-        return {
-            sigma * (pos.y() - pos.x()),
-            pos.x() * (rho - pos.z()) - pos.y(),
-            pos.x() * pos.y() - beta * pos.z()
-        };
+        return field(pos);
+    }
+
+    mat3f Lorentz::jacobian(vec3f pos) const {
+        float x = pos.x(), y = pos.y(), z = pos.z();
+        mat3f j;
+        j[0] = vec3f{-sigma, sigma, 0.0f};
+        j[1] = vec3f{rho - z, -1.0f, -x};
+        j[2] = vec3f{y, x, -beta};
+        return j;
+    }
+
+    [[gnu::flatten]] vec3f Lorentz::rk4_step(vec3f pos, const rk4_coeffs<float> &coeffs) const {
+        return rk4_fused(*this, pos, coeffs);
     }
 
     vec2f Ikeda::step(vec2f pos) const {
-        float r2 = sqrt(pos.x()) + sqrt(pos.y());
+        float r2 = pos.x() * pos.x() + pos.y() * pos.y();
         float theta = k - p / (1 + r2);
+        float s, c;
+        fast::sincos(theta, s, c);
         return {
-            1 + u * (pos.x()*cosf(theta) - pos.y()*sinf(theta)),
-            u * (pos.x()*sinf(theta) + pos.y()*cosf(theta))
+            1 + u * (pos.x()*c - pos.y()*s),
+            u * (pos.x()*s + pos.y()*c)
         };
     }
 
-    // Rössler
-    vec3f Rossler::gradient(vec3f pos) const {
-        float x = pos.x(), y = pos.y(), z = pos.z();
+    vec4f Crypto::step(vec4f pos) const {
+        float x1 = pos.x(), x2 = pos.y(), x3 = pos.z(), x4 = pos.w();
+        float s2, c2;
+        fast::sincos(x2, s2, c2);
+        float s3 = fast::sin(x3);
         return {
-            -y - z,
-            x + a*y,
-            b + z*(x - c),
+            a * c2 + s3,
+            x1 * (b * s2 - c2),
+            c * x1 + s3,
+            fast::sin(x1 * x3 + x2 + x4),
         };
     }
 
+    // Rössler
+    vec3f Rossler::gradient(vec3f pos) const {
+        return field(pos);
+    }
+
+    mat3f Rossler::jacobian(vec3f pos) const {
+        float x = pos.x(), z = pos.z();
+        mat3f j;
+        j[0] = vec3f{0.0f, -1.0f, -1.0f};
+        j[1] = vec3f{1.0f, a, 0.0f};
+        j[2] = vec3f{z, 0.0f, x - c};
+        return j;
+    }
+
+    [[gnu::flatten]] vec3f Rossler::rk4_step(vec3f pos, const rk4_coeffs<float> &coeffs) const {
+        return rk4_fused(*this, pos, coeffs);
+    }
+
     // Halvorsen
     vec3f Halvorsen::gradient(vec3f pos) const {
+        return field(pos);
+    }
+
+    mat3f Halvorsen::jacobian(vec3f pos) const {
         float x = pos.x(), y = pos.y(), z = pos.z();
-        return {
-            -a*x - 4*(y + z) - y*y,
-            -a*y - 4*(z + x) - z*z,
-            -a*z - 4*(x + y) - x*x
-        };
+        mat3f j;
+        j[0] = vec3f{-a, -4 - 2*y, -4.0f};
+        j[1] = vec3f{-4.0f, -a, -4 - 2*z};
+        j[2] = vec3f{-4 - 2*x, -4.0f, -a};
+        return j;
+    }
+
+    [[gnu::flatten]] vec3f Halvorsen::rk4_step(vec3f pos, const rk4_coeffs<float> &coeffs) const {
+        return rk4_fused(*this, pos, coeffs);
     }
 }
\ No newline at end of file
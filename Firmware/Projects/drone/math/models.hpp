@@ -1,7 +1,9 @@
 #pragma once
 
+#include <cmath>
 #include <functional>
 
+#include "fastmath.hpp"
 #include "vecmath.hpp"
 
 namespace math {
@@ -23,6 +25,96 @@ vec<N, float> rk4(vec<N, float> x, std::function<vec<N, float>(vec<N, float>)> d
     return x + dt * (k1 + 2.0f * k2 + 2.0f * k3 + k4) / 6.0f;
 }
 
+/**
+ * @brief Coefficients of a Runge-Kutta 4 step, computed once per time step.
+ */
+template <class Time> struct rk4_coeffs {
+    Time dt, half_dt, sixth_dt;
+
+    rk4_coeffs() : rk4_coeffs(0) {}
+    explicit rk4_coeffs(Time dt) : dt(dt), half_dt(dt / 2), sixth_dt(dt / 6) {}
+};
+
+/**
+ * @brief Fused Runge-Kutta 4 step for a concrete model.
+ *
+ * Unlike `rk4()`, the gradient is called statically (no std::function nor virtual dispatch) and
+ * each stage is evaluated in a single pass through expression templates, with the coefficients
+ * precomputed. Instantiated where `M::gradient()` is defined, the whole step compiles into one
+ * kernel which keeps the state in registers.
+ */
+template <class M>
+typename M::StateType rk4_fused(const M &model, typename M::StateType x,
+                                const rk4_coeffs<typename M::Time> &c) {
+    using T = typename M::StateType;
+    using Time = typename M::Time;
+
+    T k1 = model.M::gradient(x);
+    T k2 = model.M::gradient(lazy(x) + c.half_dt * lazy(k1));
+    T k3 = model.M::gradient(lazy(x) + c.half_dt * lazy(k2));
+    T k4 = model.M::gradient(lazy(x) + c.dt * lazy(k3));
+
+    return lazy(x) + c.sixth_dt * (lazy(k1) + lazy(k4) + Time(2) * (lazy(k2) + lazy(k3)));
+}
+
+/**
+ * @brief Integration method used by `DiscretizedModel`.
+ */
+enum class Integrator {
+    /// Explicit Runge-Kutta 4: 4 gradient evaluations per step, stable only for small dt
+    RK4,
+    /// Linearly implicit Rosenbrock method of order 2 (ROS2, L-stable): 2 gradient and
+    /// 1 Jacobian evaluations per step. At matched error it takes more evaluations than RK4 for
+    /// every model of the engine, up to the stiffest bounded Chua settings: only the host tools
+    /// use it (see tools/ros2_bench.cpp)
+    ROS2,
+};
+
+/**
+ * @brief Coefficients of a ROS2 step, computed once per time step.
+ */
+template <class Time> struct ros2_coeffs {
+    /// @brief gamma = 1 + 1/sqrt(2)
+    static constexpr Time GAMMA = Time(1.7071067811865476);
+
+    Time dt, gamma_dt, k1_dt, k2_dt;
+
+    ros2_coeffs() : ros2_coeffs(0) {}
+    explicit ros2_coeffs(Time dt)
+        : dt(dt), gamma_dt(GAMMA * dt), k1_dt(Time(1.5) * dt), k2_dt(Time(0.5) * dt) {}
+};
+
+/**
+ * @brief Rosenbrock (ROS2) step for a 3D model providing `gradient()` and `jacobian()`.
+ *
+ *     W = I - gamma dt J(x)
+ *     W k1 = f(x)
+ *     W k2 = f(x + dt k1) - 2 k1
+ *     x' = x + 3/2 dt k1 + 1/2 dt k2
+ *
+ * W is inverted once per step, with the closed-form 3x3 `inverse()`: other sizes would need a
+ * linear solver.
+ */
+template <class M>
+typename M::StateType ros2_step(const M &model, typename M::StateType x,
+                                const ros2_coeffs<typename M::Time> &c) {
+    using T = typename M::StateType;
+    using Time = typename M::Time;
+    static_assert(T::size() == 3, "ros2_step() only supports 3D models");
+
+    mat<3, Time> w = model.jacobian(x);
+    for (size_t i = 0; i < 3; i++) {
+        w[i] = w[i] * -c.gamma_dt;
+        w[i][i] += Time(1);
+    }
+    mat<3, Time> w_inv = inverse(w);
+
+    T k1 = w_inv * model.gradient(x);
+    T k2 = w_inv * (model.gradient(lazy(x) + c.dt * lazy(k1)) + Time(-2) * k1);
+
+    return lazy(x) + c.k1_dt * lazy(k1) + c.k2_dt * lazy(k2);
+}
+
 /**
  * @brief Discrete chaotic model interface
  * Discrete models extend this class, providing an implementation for `step()`.
@@ -76,10 +168,39 @@ template <class T> class ContinuousModel {
     /**
      * @brief Integrates `gradient()` using Runge-Kutta 4 by default
      */
-    virtual T step(T state, Time dt) const {
+    virtual T step(T state, Time dt) const { return rk4_step(state, rk4_coeffs<Time>(dt)); }
+
+    /**
+     * @brief Runge-Kutta 4 step with precomputed coefficients.
+     *
+     * The default implementation goes through `rk4()`; models override it with `rk4_fused()`.
+     */
+    virtual T rk4_step(T state, const rk4_coeffs<Time> &c) const {
         auto grad = [this](T state) { return this->gradient(state); };
 
-        return rk4<T::size()>(state, grad, dt);
+        return rk4<T::size()>(state, grad, c.dt);
+    }
+
+    /**
+     * @brief Jacobian of `gradient()`, needed by implicit integrators.
+     *
+     * The default implementation uses central differences; models override it analytically.
+     */
+    virtual mat<T::size(), Time> jacobian(T state) const {
+        constexpr Time h = Time(1e-3);
+        mat<T::size(), Time> res;
+
+        for (size_t j = 0; j < T::size(); j++) {
+            T forward = state, backward = state;
+            forward[j] += h;
+            backward[j] -= h;
+            T column = (gradient(forward) - gradient(backward)) / (2 * h);
+
+            for (size_t i = 0; i < T::size(); i++) {
+                res[i][j] = column[i];
+            }
+        }
+        return res;
     }
 };
 
@@ -90,77 +211,212 @@ template <class M> class DiscretizedModel : public DiscreteModel<typename M::Sta
 
     M model;
     Time dt;
+    Integrator integrator = Integrator::RK4;
 
     DiscretizedModel(const M &model, Time dt) : model(model), dt(dt) {}
 
     // Calls the underlying continuous model with a certain dt
-    StateType step(StateType state) const override { return model.step(state, dt); }
+    StateType step(StateType state) const override {
+        // the coefficients are only recomputed when dt changes
+        if (integrator == Integrator::ROS2) {
+            if (ros2.dt != dt) {
+                ros2 = ros2_coeffs<Time>(dt);
+            }
+            return ros2_step(model, state, ros2);
+        }
+
+        if (coeffs.dt != dt) {
+            coeffs = rk4_coeffs<Time>(dt);
+        }
+        return model.rk4_step(state, coeffs);
+    }
+
+  private:
+    mutable rk4_coeffs<Time> coeffs;
+    mutable ros2_coeffs<Time> ros2;
 };
 
 // -- Discrete oscillators --
 
+// Parameters are kept in trivially-copyable structs, which the models inherit: a snapshot of
+// the parameters can be passed around (e.g. between interrupts) without copying whole models,
+// and applied alone (see `ChaosOsc::set_params()`).
+
+struct HenonParams {
+    float a = 1.14;
+    float b = 0.3;
+};
+
 /**
  * Henon oscillator (discrete, 2D)
  * Useful initial conditions: (x0, y0) = (0.1, 0.3)
  */
-class Henon : public DiscreteModel<vec2f> {
+class Henon : public DiscreteModel<vec2f>, public HenonParams {
   public:
-    float a = 1.14;
-    float b = 0.3;
+    using Params = HenonParams;
 
     vec2f step(vec2f state) const override;
 };
 
-class Ikeda : public DiscreteModel<vec2f> {
-  public:
+struct IkedaParams {
     float u = 0.9;
     float k = 0.4;
     float p = 6.0;
+};
+
+class Ikeda : public DiscreteModel<vec2f>, public IkedaParams {
+  public:
+    using Params = IkedaParams;
 
     vec2f step(vec2f) const override;
 };
 
+struct CryptoParams {
+    float a = 1.3f, b = 2.0f, c = 1.2f;
+};
+
+/**
+ * Drive map of the 4D chaotic cryptosystem of Simulation/four_dim_crypto (discrete, 4D).
+ * Bounded for any initial condition: |x1| <= a + 1, |x3| <= c (a + 1) + 1, |x4| <= 1 and
+ * |x2| <= (b + 1) |x1|. Useful initial conditions: (0.2, 0.2, 0.2, 0.2)
+ */
+class Crypto : public DiscreteModel<vec4f>, public CryptoParams {
+  public:
+    using Params = CryptoParams;
+
+    vec4f step(vec4f) const override;
+};
+
 // -- Continuous oscillators --
 
+struct ChuaParams {
+    float alpha = 18.39f, beta = 39.0f, m0 = -1.143, m1 = -0.714;
+};
+
 /**
  * Chua oscillator (continuous, 3D)
  * Useful initial conditions (x0, y0, z0) = (0.1, 0, 0)
  */
-class Chua : public ContinuousModel<vec3f> {
+class Chua : public ContinuousModel<vec3f>, public ChuaParams {
   public:
-    float alpha = 18.39f, beta = 39.0f, m0 = -1.143, m1 = -0.714;
+    using Params = ChuaParams;
 
-    float chua_diode(float x) const;
+    template <class S> S chua_diode(S x) const;
+    template <class S> vec<3, S> field(vec<3, S> state) const;
     vec3f gradient(vec3f state) const override;
+    mat3f jacobian(vec3f state) const override;
+    vec3f rk4_step(vec3f state, const rk4_coeffs<float> &c) const override;
 };
 
-class Sprott : public ContinuousModel<vec3f> {
-  public:
+struct SprottParams {
     float a = 2.07, b = 1.79;
+};
 
+class Sprott : public ContinuousModel<vec3f>, public SprottParams {
+  public:
+    using Params = SprottParams;
+
+    template <class S> vec<3, S> field(vec<3, S>) const;
     vec3f gradient(vec3f) const override;
+    mat3f jacobian(vec3f) const override;
+    vec3f rk4_step(vec3f, const rk4_coeffs<float> &) const override;
 };
 
-class Rossler : public ContinuousModel<vec3f> {
-  public:
+struct RosslerParams {
     float a = 0.2, b = 0.2, c = 5.7;
+};
+
+class Rossler : public ContinuousModel<vec3f>, public RosslerParams {
+  public:
+    using Params = RosslerParams;
 
+    template <class S> vec<3, S> field(vec<3, S>) const;
     vec3f gradient(vec3f) const override;
+    mat3f jacobian(vec3f) const override;
+    vec3f rk4_step(vec3f, const rk4_coeffs<float> &) const override;
 };
 
-class Halvorsen : public ContinuousModel<vec3f> {
-  public:
+struct HalvorsenParams {
     float a = 1.89;
+};
+
+class Halvorsen : public ContinuousModel<vec3f>, public HalvorsenParams {
+  public:
+    using Params = HalvorsenParams;
 
+    template <class S> vec<3, S> field(vec<3, S>) const;
     vec3f gradient(vec3f) const override;
+    mat3f jacobian(vec3f) const override;
+    vec3f rk4_step(vec3f, const rk4_coeffs<float> &) const override;
 };
 
-class Lorentz : public ContinuousModel<vec3f> {
-  public:
-    float rho = 10;
+struct LorentzParams {
+    float rho = 28;
     float sigma = 10;
     float beta = 8.f / 3.f;
+};
 
+class Lorentz : public ContinuousModel<vec3f>, public LorentzParams {
+  public:
+    using Params = LorentzParams;
+
+    template <class S> vec<3, S> field(vec<3, S>) const;
     vec3f gradient(vec3f) const override;
+    mat3f jacobian(vec3f) const override;
+    vec3f rk4_step(vec3f, const rk4_coeffs<float> &) const override;
 };
+
+// -- Vector fields --
+// Templated on the scalar type, so that they can also be evaluated on dual numbers
+// (see dual.hpp); `gradient()` evaluates them on floats.
+
+template <class S> S Chua::chua_diode(S x) const {
+    // (|x + 1| - |x - 1|) / 2 == clamp(x, -1, 1), without the two absolute values
+    return m1 * x + (m0 - m1) * clamp(x, S(-1), S(1));
+}
+
+template <class S> vec<3, S> Chua::field(vec<3, S> pos) const {
+    S x = pos.x(), y = pos.y(), z = pos.z();
+    return {
+        alpha * (y - x - chua_diode(x)),
+        x - y + z,
+        -beta * y,
+    };
+}
+
+template <class S> vec<3, S> Sprott::field(vec<3, S> pos) const {
+    S x = pos.x(), y = pos.y(), z = pos.z();
+    return {
+        y + a * x * y + x * z,
+        1 - b * x * x + y * z,
+        x - x * x - y * y,
+    };
+}
+
+template <class S> vec<3, S> Rossler::field(vec<3, S> pos) const {
+    S x = pos.x(), y = pos.y(), z = pos.z();
+    return {
+        -y - z,
+        x + a * y,
+        b + z * (x - c),
+    };
+}
+
+template <class S> vec<3, S> Halvorsen::field(vec<3, S> pos) const {
+    S x = pos.x(), y = pos.y(), z = pos.z();
+    return {
+        -a * x - 4 * (y + z) - y * y,
+        -a * y - 4 * (z + x) - z * z,
+        -a * z - 4 * (x + y) - x * x,
+    };
+}
+
+template <class S> vec<3, S> Lorentz::field(vec<3, S> pos) const {
+    S x = pos.x(), y = pos.y(), z = pos.z();
+    return {
+        sigma * (y - x),
+        x * (rho - z) - y,
+        x * y - beta * z,
+    };
+}
 } // namespace math
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "models.hpp"
+#include "vecmath.hpp"
+
+namespace math {
+
+/**
+ * @brief One directed link of a CoupledNetwork: adds
+ *     gain * (x_from[from_axis] - x_to[to_axis])
+ * to component `to_axis` of the vector field of node `to`. With `from_axis == to_axis` and a
+ * large enough gain, the response node `to` synchronizes onto the drive node `from`; links both
+ * ways give diffusive (mutual) coupling.
+ */
+struct Coupling {
+    uint8_t from, to;
+    uint8_t from_axis, to_axis;
+    float gain;
+};
+
+/**
+ * @brief Nodes of the same continuous model, each with its own parameters, integrated together
+ * with Runge-Kutta 4 and coupled through a sparse list of links.
+ *
+ * Every stage of the step evaluates the vector fields of all the nodes, then adds the coupling
+ * terms from the stage states, so the coupled system is integrated as a whole with the accuracy
+ * of RK4. The vector fields are evaluated inline through the `field()` templates of the models.
+ *
+ * All the nodes share the model type: the stages of different models (e.g. a Rossler driving a
+ * Lorentz) cannot be interleaved, and the oscillators of the engine (KhaosOscillators) are not
+ * nodes. On the host, at -O2, a step of 2 to 16 nodes takes 0.9 to 1.1 times the fused kernels
+ * of the models (`rk4_step()`) without links, 1.1 to 1.3 times with a drive-response chain, and
+ * 1.4 to 1.6 times with a mutual ring (see tools/coupled_network_bench.cpp): each link costs
+ * about as much as a third of a Rossler field. Running `rk4_step()` node by node with the links
+ * added inside its stages was slower, as the link axes, known only at run time, force the node
+ * states out of registers.
+ *
+ * @tparam M continuous model defining `field()` (all those of models.hpp)
+ * @tparam N maximum number of nodes
+ * @tparam MAX_COUPLINGS maximum number of links
+ */
+template <class M, size_t N, size_t MAX_COUPLINGS = 2 * N> class CoupledNetwork {
+  public:
+    static_assert(N <= 256, "nodes are indexed by uint8_t");
+    using State = typename M::StateType;
+    using Time = typename M::Time;
+
+    /// @param size number of active nodes, at most N
+    explicit CoupledNetwork(size_t size = N) : size(size < N ? size : N) {}
+
+    [[nodiscard]] size_t get_size() const { return size; }
+
+    M &model(size_t node) { return models[node]; }
+    [[nodiscard]] const M &model(size_t node) const { return models[node]; }
+
+    State &state(size_t node) { return states[node]; }
+    [[nodiscard]] const State &state(size_t node) const { return states[node]; }
+
+    /// @return false if the link refers to an inactive node or axis, or the list is full
+    bool add_coupling(const Coupling &coupling) {
+        if (num_couplings == MAX_COUPLINGS || coupling.from >= size || coupling.to >= size ||
+            coupling.from_axis >= State::size() || coupling.to_axis >= State::size()) {
+            return false;
+        }
+        couplings[num_couplings++] = coupling;
+        return true;
+    }
+
+    void clear_couplings() { num_couplings = 0; }
+
+    [[nodiscard]] size_t get_num_couplings() const { return num_couplings; }
+
+    /// @brief Advances every node by `dt`.
+    [[gnu::flatten]] void step(const rk4_coeffs<Time> &c) {
+        derivatives(states, k1);
+        for (size_t i = 0; i < size; i++)
+            stage[i] = lazy(states[i]) + c.half_dt * lazy(k1[i]);
+        derivatives(stage, k2);
+        for (size_t i = 0; i < size; i++)
+            stage[i] = lazy(states[i]) + c.half_dt * lazy(k2[i]);
+        derivatives(stage, k3);
+        for (size_t i = 0; i < size; i++)
+            stage[i] = lazy(states[i]) + c.dt * lazy(k3[i]);
+        derivatives(stage, k4);
+
+        for (size_t i = 0; i < size; i++) {
+            states[i] = lazy(states[i]) +
+                        c.sixth_dt * (lazy(k1[i]) + lazy(k4[i]) + Time(2) * (lazy(k2[i]) +
+                                                                                lazy(k3[i])));
+        }
+    }
+
+    /// @brief Distance between the states of two nodes: 0 once a response is synchronized.
+    [[nodiscard]] Time sync_error(size_t a, size_t b) const {
+        State d = states[a] - states[b];
+        return sqrtf(dot(d, d));
+    }
+
+  private:
+    size_t size;
+    std::array<M, N> models{};
+    std::array<State, N> states{};
+    std::array<Coupling, MAX_COUPLINGS> couplings{};
+    size_t num_couplings = 0;
+
+    /// Stage states and slopes
+    std::array<State, N> stage, k1, k2, k3, k4;
+
+    void derivatives(const std::array<State, N> &x, std::array<State, N> &dx) const {
+        for (size_t i = 0; i < size; i++)
+            dx[i] = models[i].field(x[i]);
+        for (size_t l = 0; l < num_couplings; l++) {
+            const Coupling &link = couplings[l];
+            dx[link.to][link.to_axis] +=
+                link.gain * (x[link.from][link.from_axis] - x[link.to][link.to_axis]);
+        }
+    }
+};
+
+} // namespace math
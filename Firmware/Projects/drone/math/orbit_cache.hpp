@@ -0,0 +1,211 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "section.hpp"
+#include "vecmath.hpp"
+
+namespace math {
+
+struct OrbitCacheConfig {
+    /// Poincaré section whose return map is matched
+    SectionConfig section;
+    /// Crossings one period apart must be closer than this fraction of the distance the
+    /// trajectory moves in one sample there: the error of the crossing interpolation, and the
+    /// phase error of playback, scale with that step
+    float tolerance = 0.0f;
+    /// ...and the orbit must reach this far from its crossing point: rejects the slow spiral of
+    /// a trajectory converging onto a fixed point
+    float min_extent = 0.0f;
+    /// Periods matched in a row before the orbit is cached
+    uint32_t confirm_periods = 3;
+};
+
+/**
+ * @brief Detects a stable periodic orbit in a sampled trajectory and plays it back instead of
+ * integrating it.
+ *
+ * Integrated samples are fed to `record()`, which keeps the last SIZE samples and the states at
+ * the crossings of a Poincaré section. Once every crossing of the last `confirm_periods` periods
+ * comes back within `tolerance` sample steps of the crossing one period (of up to MAX_PERIOD
+ * crossings) earlier, the samples of the last period become a wavetable: `play()` then returns
+ * one sample per call, linearly interpolated at the fractional period, for the cost of a lerp.
+ * Orbits longer than the history are not cached.
+ *
+ * A trajectory converging onto an orbit through a negative multiplier alternates around it, so
+ * it repeats twice the period before it repeats the period itself: when the crossings also
+ * repeat a divisor of the period within one sample step, the shorter period is cached.
+ *
+ * The cache does not know the model: whoever changes its parameters or time scale, or moves its
+ * state, must call `reset()`, and integration resumes from `get_state()`.
+ *
+ * @tparam State vector type of the trajectory
+ * @tparam SIZE samples of history, a power of two: the longest period which can be cached
+ * @tparam MAX_PERIOD crossings per period at most (period-doubled orbits)
+ */
+template <class State, size_t SIZE, size_t MAX_PERIOD = 4> class OrbitCache {
+  public:
+    static_assert((SIZE & (SIZE - 1)) == 0, "SIZE must be a power of two");
+
+    OrbitCache() = default;
+    explicit OrbitCache(const OrbitCacheConfig &config)
+        : config(config), detector(config.section) {}
+
+    /// @brief Forgets the history and stops playing.
+    void reset() {
+        detector.reset();
+        count = 0;
+        crossings = 0;
+        playing = false;
+    }
+
+    [[nodiscard]] bool is_playing() const { return playing; }
+
+    /// @brief Period of the cached orbit, in samples (0 if none)
+    [[nodiscard]] float get_period() const { return playing ? period : 0.0f; }
+
+    /**
+     * @brief Feeds the next integrated sample.
+     * @return true if a periodic orbit has just been cached: the next samples come from `play()`
+     */
+    bool record(const State &state) {
+        history[count & MASK] = state;
+        count++;
+
+        float position = detector.process(state);
+        if (position < 0.0f || count < 2)
+            return false;
+
+        // The crossing lies between the previous sample and this one
+        const State &before = history[(count - 2) & MASK];
+        Crossing &crossing = ring[crossings % RING_SIZE];
+        crossing.sample = count - 2;
+        crossing.offset = position;
+        crossing.state = lerp(position, before, state);
+        crossing.step_sq = distance_sq(before, state);
+        crossings++;
+
+        return match();
+    }
+
+    /// @brief Next sample of the cached orbit; only while `is_playing()`.
+    State play() {
+        phase += 1.0f;
+        if (phase >= period)
+            phase -= period;
+        return sample(phase);
+    }
+
+    /// @brief State at the current playback position, to resume integrating from it.
+    [[nodiscard]] State get_state() const { return sample(phase); }
+
+  private:
+    static constexpr size_t MASK = SIZE - 1;
+
+    struct Crossing {
+        /// Index of the sample before the crossing, and position of the crossing after it
+        uint32_t sample;
+        float offset;
+        State state;
+        /// Squared distance between these two samples
+        float step_sq;
+    };
+
+    /// Enough crossings to confirm up to 7 periods of MAX_PERIOD crossings
+    static constexpr size_t RING_SIZE = 8 * MAX_PERIOD + 1;
+
+    OrbitCacheConfig config;
+    SectionDetector<State> detector;
+
+    std::array<State, SIZE> history;
+    uint32_t count = 0;
+
+    std::array<Crossing, RING_SIZE> ring;
+    uint32_t crossings = 0;
+
+    bool playing = false;
+    /// Start of the cached period: first history sample and offset of the crossing after it
+    uint32_t start = 0;
+    float start_offset = 0.0f;
+    float period = 0.0f;
+    /// Playback position from the start of the period, in samples
+    float phase = 0.0f;
+
+    const Crossing &crossing(uint32_t back) const {
+        return ring[(crossings - 1 - back) % RING_SIZE];
+    }
+
+    static float distance_sq(const State &a, const State &b) {
+        State d = a - b;
+        return dot(d, d);
+    }
+
+    /// @brief Whether the last `needed` crossings repeat every `p` crossings, within
+    /// `tolerance_sq` times the squared sample step.
+    bool repeats(uint32_t p, uint32_t needed, float tolerance_sq) const {
+        for (uint32_t k = 0; k + p < needed; k++) {
+            const Crossing &c = crossing(k);
+            if (!(distance_sq(c.state, crossing(k + p).state) < tolerance_sq * c.step_sq))
+                return false;
+        }
+        return true;
+    }
+
+    /// @brief Looks for the shortest period that the last crossings repeat.
+    bool match() {
+        const float tolerance_sq = config.tolerance * config.tolerance;
+
+        for (uint32_t p = 1; p <= MAX_PERIOD; p++) {
+            uint32_t needed = p * (config.confirm_periods + 1);
+            if (needed > crossings || needed > RING_SIZE)
+                break;
+            if (!repeats(p, needed, tolerance_sq))
+                continue;
+
+            for (uint32_t q = 1; q < p; q++) {
+                if (p % q == 0 && repeats(q, needed, 1.0f)) {
+                    p = q;
+                    break;
+                }
+            }
+
+            const Crossing &first = crossing(p), &last = crossing(0);
+            float samples = static_cast<float>(last.sample - first.sample) + last.offset -
+                            first.offset;
+            // The period and the two samples around it must still be in the history
+            if (count - first.sample > SIZE || samples < 2.0f || !extends(first, last.sample))
+                continue;
+
+            start = first.sample;
+            start_offset = first.offset;
+            period = samples;
+            // The last sample recorded lies 1 - offset after the last crossing
+            phase = 1.0f - last.offset;
+            playing = true;
+            return true;
+        }
+        return false;
+    }
+
+    /// @brief Whether the orbit from `first` reaches `min_extent` before sample `end`.
+    bool extends(const Crossing &first, uint32_t end) const {
+        const float extent_sq = config.min_extent * config.min_extent;
+        for (uint32_t i = first.sample + 1; i <= end; i++) {
+            if (distance_sq(history[i & MASK], first.state) >= extent_sq)
+                return true;
+        }
+        return false;
+    }
+
+    State sample(float position) const {
+        float time = start_offset + position;
+        auto index = static_cast<uint32_t>(time);
+        float fraction = time - static_cast<float>(index);
+        uint32_t i = start + index;
+        return lerp(fraction, history[i & MASK], history[(i + 1) & MASK]);
+    }
+};
+
+} // namespace math
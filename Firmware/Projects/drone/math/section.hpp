@@ -0,0 +1,105 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+namespace math {
+
+enum class SectionDirection : uint8_t { RISING, FALLING, BOTH };
+
+/// @brief Axis-aligned Poincaré section: the plane `state[axis] == level`.
+struct SectionConfig {
+    size_t axis = 0;
+    float level = 0.0f;
+    SectionDirection direction = SectionDirection::RISING;
+    /// @brief After a crossing, the trajectory must move this far from the plane before another
+    /// crossing is counted: rejects chatter around the plane.
+    float hysteresis = 0.0f;
+};
+
+/**
+ * @brief Detects the crossings of a Poincaré section by a sampled trajectory.
+ *
+ * The crossing instant is located between two samples by inverse quadratic interpolation of the
+ * distance from the plane through the last three samples, falling back to linear interpolation,
+ * which is also used until three samples have been seen since the last reset.
+ * In the common case (no crossing, detector armed) a sample costs a subtraction and a few
+ * compares.
+ */
+template <class State> class SectionDetector {
+  public:
+    SectionDetector() = default;
+    explicit SectionDetector(const SectionConfig &config) : config(config) {}
+
+    void reset() {
+        primed = false;
+        samples = 0;
+    }
+
+    /**
+     * @brief Feeds the next sample.
+     * @return position of the crossing between the previous sample (0) and this one (1),
+     *         or a negative value if the section has not been crossed
+     */
+    float process(const State &state) {
+        float value = state[config.axis] - config.level;
+        float before = previous, earlier = before_previous;
+        before_previous = previous;
+        previous = value;
+        if (samples < 3)
+            samples++;
+
+        bool above = value > 0.0f;
+        if (above == side || !primed) {
+            if (!armed && fabsf(value) > config.hysteresis)
+                armed = true;
+            side = above;
+            primed = true;
+            return -1.0f;
+        }
+
+        side = above;
+        if (!armed || (config.direction == SectionDirection::RISING && !above) ||
+            (config.direction == SectionDirection::FALLING && above)) {
+            return -1.0f;
+        }
+
+        armed = config.hysteresis <= 0.0f;
+        return samples < 3 ? before / (before - value) : locate(earlier, before, value);
+    }
+
+  private:
+    SectionConfig config;
+    float previous = 0.0f, before_previous = 0.0f;
+    bool side = false, armed = true, primed = false;
+    /// Samples seen since the last reset, up to 3
+    uint8_t samples = 0;
+
+    /// @brief Root in [0, 1] of the parabola through (-1, v0), (0, v1), (1, v2), with v1 and v2
+    /// of opposite signs.
+    static float locate(float v0, float v1, float v2) {
+        float linear = v1 / (v1 - v2);
+
+        // p(t) = a t^2 + b t + v1
+        float a = 0.5f * (v2 + v0) - v1;
+        float b = 0.5f * (v2 - v0);
+        if (fabsf(a) < 1e-6f * (fabsf(b) + fabsf(v1)))
+            return linear;
+
+        float discriminant = b * b - 4.0f * a * v1;
+        if (discriminant < 0.0f)
+            return linear;
+
+        // Numerically stable roots; keep the one inside the interval
+        float q = -0.5f * (b + copysignf(sqrtf(discriminant), b));
+        float t1 = q / a, t2 = v1 / q;
+        if (t1 >= 0.0f && t1 <= 1.0f)
+            return t1;
+        if (t2 >= 0.0f && t2 <= 1.0f)
+            return t2;
+        return linear;
+    }
+};
+
+} // namespace math
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+
+#include "vecmath.hpp"
+
+namespace math {
+
+/**
+ * @brief Initial states of a model, for the cells of a uniform grid over one of its parameters
+ * (the others at their defaults). Tables are generated by tools/gen_seed_tables.cpp. In a
+ * verified cell, the model stays on an attractor (neither diverges nor collapses onto a fixed
+ * point) from each seed, across the whole cell. The other cells, where no attractor was found,
+ * hold the seeds of the closest verified cell: they still bring back a diverged state, but the
+ * model may settle on a fixed point from them.
+ */
+struct SeedTable {
+    static constexpr size_t SEEDS_PER_CELL = 4;
+
+    float param_min, param_max;
+    const vec3f (*seeds)[SEEDS_PER_CELL];
+    const bool *verified;
+    size_t cells;
+
+    /// @brief Cell containing `param`, clamped to the ends of the table.
+    [[nodiscard]] size_t cell(float param) const {
+        float pos = (param - param_min) / (param_max - param_min) * static_cast<float>(cells);
+        pos = clamp(pos, 0.0f, static_cast<float>(cells - 1));
+        return static_cast<size_t>(pos);
+    }
+
+    /// @brief Seeds of the cell containing `param`.
+    [[nodiscard]] const vec3f *lookup(float param) const { return seeds[cell(param)]; }
+
+    /// @brief Whether the model keeps an attractor from the seeds of the cell containing `param`.
+    [[nodiscard]] bool is_verified(float param) const { return verified[cell(param)]; }
+};
+
+} // namespace math
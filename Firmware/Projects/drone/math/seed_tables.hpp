@@ -0,0 +1,485 @@
+#pragma once
+
+// Generated by tools/gen_seed_tables.cpp, do not edit.
+
+#include "models.hpp"
+#include "seed_table.hpp"
+
+namespace math {
+
+/// Seeds of Chua vs alpha in [15, 19]
+inline constexpr vec3f CHUA_SEEDS[][SeedTable::SEEDS_PER_CELL] = {
+    // alpha in [15, 15.25]: 82% attractor, 18% diverged, 0% fixed point
+    {{1.4941f, 0.3221f, -0.7267f},
+     {1.6670f, 0.3329f, -1.2070f},
+     {2.1268f, 0.1975f, -3.3791f},
+     {-2.1284f, -0.1822f, 3.4558f}},
+    // alpha in [15.25, 15.5]: 73% attractor, 27% diverged, 0% fixed point
+    {{-1.6010f, 0.2185f, 3.2617f},
+     {-0.5999f, -0.1614f, -0.9180f},
+     {2.0633f, 0.0544f, -3.7970f},
+     {1.9213f, -0.0608f, -3.7894f}},
+    // alpha in [15.5, 15.75]: 68% attractor, 32% diverged, 0% fixed point
+    {{-0.3158f, 0.0502f, -1.2442f},
+     {-0.3418f, 0.1196f, -1.1000f},
+     {-0.6477f, -0.1868f, -0.7905f},
+     {-0.3165f, 0.0327f, -1.2619f}},
+    // alpha in [15.75, 16]: 70% attractor, 30% diverged, 0% fixed point
+    {{0.3372f, -0.1433f, 1.0277f},
+     {1.3398f, -0.2927f, -2.5978f},
+     {-0.6674f, -0.1997f, -0.7098f},
+     {-0.7712f, -0.2232f, -0.5381f}},
+    // alpha in [16, 16.25]: 64% attractor, 36% diverged, 0% fixed point
+    {{-0.3632f, -0.0980f, -1.1658f},
+     {-1.8068f, 0.1158f, 3.6237f},
+     {0.2618f, -0.0620f, 1.2438f},
+     {-0.3585f, -0.0954f, -1.1731f}},
+    // alpha in [16.25, 16.5]: 57% attractor, 43% diverged, 0% fixed point
+    {{0.2324f, -0.0283f, 1.2864f},
+     {0.2579f, -0.1042f, 1.1594f},
+     {1.4461f, -0.2562f, -2.8961f},
+     {-1.1080f, 0.3295f, 1.8682f}},
+    // alpha in [16.5, 16.75]: 56% attractor, 44% diverged, 0% fixed point
+    {{-0.4559f, -0.1188f, -1.0080f},
+     {1.3166f, -0.2804f, -2.5116f},
+     {1.0052f, -0.3414f, -1.5227f},
+     {-0.4328f, 0.2560f, -0.4532f}},
+    // alpha in [16.75, 17]: 55% attractor, 45% diverged, 0% fixed point
+    {{-2.1796f, -0.1763f, 3.4664f},
+     {0.9139f, 0.2764f, -0.1769f},
+     {2.0014f, 0.1826f, -3.0321f},
+     {-2.1697f, -0.1476f, 3.5864f}},
+    // alpha in [17, 17.25]: 50% attractor, 50% diverged, 0% fixed point
+    {{0.8854f, 0.2728f, -0.2561f},
+     {0.8621f, -0.3527f, -1.0996f},
+     {-0.5507f, 0.0664f, -0.7874f},
+     {-1.2598f, 0.3111f, 2.4739f}},
+    // alpha in [17.25, 17.5]: 43% attractor, 57% diverged, 0% fixed point
+    {{2.1889f, 0.1573f, -3.5015f},
+     {1.5139f, 0.2837f, -1.3554f},
+     {-1.0979f, -0.1723f, -0.3314f},
+     {-0.7067f, -0.0839f, -0.7558f}},
+    // alpha in [17.5, 17.75]: 44% attractor, 56% diverged, 0% fixed point
+    {{-0.6728f, 0.3426f, 0.5633f},
+     {1.8097f, 0.2611f, -1.1619f},
+     {-0.0571f, 0.1908f, 0.9613f},
+     {-2.1484f, -0.2775f, 2.6213f}},
+    // alpha in [17.75, 18]: 45% attractor, 55% diverged, 0% fixed point
+    {{-2.0106f, -0.3085f, 1.9051f},
+     {-1.4791f, 0.1153f, 2.3368f},
+     {0.6988f, -0.1466f, 0.2964f},
+     {-1.7519f, -0.3130f, 1.2013f}},
+    // alpha in [18, 18.25]: 41% attractor, 59% diverged, 0% fixed point
+    {{0.7004f, -0.1429f, 0.3049f},
+     {1.7136f, 0.0681f, -1.9584f},
+     {1.3100f, 0.2744f, -0.9088f},
+     {-1.9377f, -0.2508f, 1.6902f}},
+    // alpha in [18.25, 18.5]: 30% attractor, 70% diverged, 0% fixed point
+    {{1.6460f, 0.2347f, -0.6206f},
+     {-1.5638f, -0.0771f, 1.5548f},
+     {0.6887f, -0.3456f, -0.7020f},
+     {0.5712f, 0.0368f, -1.1124f}},
+    // alpha in [18.5, 18.75]: 35% attractor, 65% diverged, 0% fixed point
+    {{-0.7335f, -0.0703f, -0.2184f},
+     {-0.5957f, -0.0055f, 1.8268f},
+     {-2.1703f, -0.2352f, 2.7821f},
+     {-1.1924f, -0.0527f, -0.1355f}},
+    // alpha in [18.75, 19]: 34% attractor, 66% diverged, 0% fixed point
+    {{1.8770f, 0.0070f, -3.2780f},
+     {0.7553f, 0.0781f, -0.8135f},
+     {1.5230f, 0.1298f, -0.7261f},
+     {1.2453f, 0.0929f, 0.1268f}},
+};
+inline constexpr bool CHUA_VERIFIED[] = {
+    true, true, true, true, true, true, true, true,
+    true, true, true, true, true, true, true, true};
+inline constexpr SeedTable CHUA_SEED_TABLE{15.0000f, 19.0000f, CHUA_SEEDS,
+    CHUA_VERIFIED, 16};
+inline const vec3f *model_seeds(const Chua &m) {
+    return CHUA_SEED_TABLE.lookup(m.alpha);
+}
+inline bool model_seeds_verified(const Chua &m) {
+    return CHUA_SEED_TABLE.is_verified(m.alpha);
+}
+
+/// Seeds of Sprott vs a in [1.8, 2.4]
+inline constexpr vec3f SPROTT_SEEDS[][SeedTable::SEEDS_PER_CELL] = {
+    // a in [1.8, 1.837]: 83% attractor, 0% diverged, 17% fixed point
+    {{0.1599f, 0.5826f, -1.2840f},
+     {0.5883f, 0.3545f, -1.1481f},
+     {0.4634f, -0.4038f, 1.5424f},
+     {0.2651f, -1.7585f, -0.0270f}},
+    // a in [1.837, 1.875]: 89% attractor, 0% diverged, 11% fixed point
+    {{-0.3768f, -0.0322f, 1.1485f},
+     {0.5295f, 0.3798f, -1.3565f},
+     {0.5750f, 0.3597f, -1.1960f},
+     {0.7556f, 0.1089f, -0.3262f}},
+    // a in [1.875, 1.913]: 91% attractor, 0% diverged, 9% fixed point
+    {{0.4311f, 0.4068f, -1.6510f},
+     {0.3023f, -0.4402f, 1.7336f},
+     {0.6365f, -0.3644f, 1.1439f},
+     {0.7631f, -0.0748f, 0.2254f}},
+    // a in [1.913, 1.95]: 90% attractor, 0% diverged, 10% fixed point
+    {{0.6357f, -0.3194f, 1.0469f},
+     {0.5927f, 0.3465f, -1.1474f},
+     {0.7039f, -0.2241f, 0.7099f},
+     {0.6993f, 0.2312f, -0.7344f}},
+    // a in [1.95, 1.987]: 88% attractor, 0% diverged, 12% fixed point
+    {{0.6456f, 0.2926f, -0.9786f},
+     {0.6245f, -0.3130f, 1.0601f},
+     {0.6643f, -0.2754f, 0.9039f},
+     {0.5572f, -0.3598f, 1.2887f}},
+    // a in [1.987, 2.025]: 92% attractor, 0% diverged, 8% fixed point
+    {{0.6615f, -0.2764f, 0.9202f},
+     {0.5280f, -0.3715f, 1.3912f},
+     {0.7629f, 0.0604f, -0.1769f},
+     {0.7156f, 0.2019f, -0.6513f}},
+    // a in [2.025, 2.062]: 89% attractor, 0% diverged, 11% fixed point
+    {{0.5820f, 0.5437f, -1.2692f},
+     {0.7420f, -0.1887f, 0.5320f},
+     {0.7667f, 0.0333f, -0.1053f},
+     {0.2944f, -0.7890f, 1.0725f}},
+    // a in [2.062, 2.1]: 92% attractor, 0% diverged, 8% fixed point
+    {{0.5712f, 0.3477f, -1.2319f},
+     {0.7586f, -0.0864f, 0.2781f},
+     {0.7594f, 0.0614f, -0.1838f},
+     {0.7087f, 0.2106f, -0.6963f}},
+    // a in [2.1, 2.138]: 93% attractor, 0% diverged, 7% fixed point
+    {{0.5724f, -0.3444f, 1.2641f},
+     {0.5863f, 0.3133f, -1.1011f},
+     {0.7538f, -0.0597f, 0.1980f},
+     {0.6622f, 0.2758f, -0.9643f}},
+    // a in [2.138, 2.175]: 91% attractor, 0% diverged, 9% fixed point
+    {{0.4970f, -0.3958f, 1.3936f},
+     {-0.3362f, -0.6489f, -0.6028f},
+     {0.7132f, 0.2496f, -1.2290f},
+     {0.7872f, -0.2160f, 0.6252f}},
+    // a in [2.175, 2.213]: 95% attractor, 0% diverged, 5% fixed point
+    {{0.5485f, -0.3467f, 1.1369f},
+     {0.6126f, 0.2280f, -1.1390f},
+     {0.8100f, 0.2121f, -1.4102f},
+     {0.7679f, 0.0399f, -0.1238f}},
+    // a in [2.213, 2.25]: 95% attractor, 0% diverged, 5% fixed point
+    {{0.6523f, 0.2507f, -1.2287f},
+     {0.5681f, 0.2695f, -0.8672f},
+     {0.7402f, -0.1424f, 0.4587f},
+     {0.6728f, 0.2426f, -0.8474f}},
+    // a in [2.25, 2.288]: 96% attractor, 0% diverged, 4% fixed point
+    {{0.2097f, 0.3634f, -2.5271f},
+     {0.7455f, -0.0716f, 0.2620f},
+     {0.5155f, -0.3670f, 1.4706f},
+     {0.6760f, 0.2493f, -0.9144f}},
+    // a in [2.288, 2.325]: 95% attractor, 0% diverged, 5% fixed point
+    {{0.7650f, -0.0067f, 0.0328f},
+     {0.7748f, 0.0865f, -0.2575f},
+     {0.6351f, -0.3963f, 1.1626f},
+     {0.2054f, 0.3605f, -2.5568f}},
+    // a in [2.325, 2.363]: 95% attractor, 0% diverged, 5% fixed point
+    {{0.6461f, -0.2873f, 1.0304f},
+     {0.6167f, 0.3038f, -1.1450f},
+     {0.5831f, 0.2744f, -1.0635f},
+     {0.6109f, 0.3092f, -1.1727f}},
+    // a in [2.363, 2.4]: 96% attractor, 0% diverged, 4% fixed point
+    {{-0.0040f, 0.6422f, -1.2122f},
+     {0.7545f, 0.0681f, -0.2293f},
+     {0.7751f, -0.0316f, 0.1106f},
+     {0.6767f, 0.2839f, -0.9328f}},
+};
+inline constexpr bool SPROTT_VERIFIED[] = {
+    true, true, true, true, true, true, true, true,
+    true, true, true, true, true, true, true, true};
+inline constexpr SeedTable SPROTT_SEED_TABLE{1.8000f, 2.4000f, SPROTT_SEEDS,
+    SPROTT_VERIFIED, 16};
+inline const vec3f *model_seeds(const Sprott &m) {
+    return SPROTT_SEED_TABLE.lookup(m.a);
+}
+inline bool model_seeds_verified(const Sprott &m) {
+    return SPROTT_SEED_TABLE.is_verified(m.a);
+}
+
+/// Seeds of Rossler vs c in [4, 12]
+inline constexpr vec3f ROSSLER_SEEDS[][SeedTable::SEEDS_PER_CELL] = {
+    // c in [4, 4.5]: 59% attractor, 41% diverged, 0% fixed point
+    {{-5.8104f, 3.1654f, 0.0208f},
+     {-3.0469f, -1.8743f, 0.0268f},
+     {1.0777f, -4.2622f, 0.0494f},
+     {-3.3133f, 1.9063f, 0.0499f}},
+    // c in [4.5, 5]: 59% attractor, 41% diverged, 0% fixed point
+    {{7.6466f, -1.5287f, 0.8139f},
+     {4.2322f, -7.4996f, 0.0783f},
+     {4.0745f, -1.8199f, 0.1151f},
+     {0.7005f, -8.9371f, 0.0371f}},
+    // c in [5, 5.5]: 68% attractor, 32% diverged, 0% fixed point
+    {{-5.3642f, 0.4112f, 0.0190f},
+     {3.8458f, -1.2630f, 0.0931f},
+     {-4.7466f, -2.6424f, 0.0196f},
+     {5.9543f, -4.1638f, 0.1461f}},
+    // c in [5.5, 6]: 69% attractor, 31% diverged, 0% fixed point
+    {{0.4148f, 6.6731f, 0.0795f},
+     {3.4299f, -3.8029f, 0.0601f},
+     {-8.4842f, -0.4211f, 0.0141f},
+     {-4.6848f, -4.0362f, 0.0186f}},
+    // c in [6, 6.5]: 72% attractor, 28% diverged, 0% fixed point
+    {{-7.7868f, -0.5967f, 0.0142f},
+     {7.7801f, 2.6855f, 10.9959f},
+     {-2.6489f, 8.5390f, 0.0418f},
+     {5.1490f, 5.7204f, 1.1813f}},
+    // c in [6.5, 7]: 75% attractor, 25% diverged, 0% fixed point
+    {{0.2730f, 2.8603f, 0.0333f},
+     {0.9944f, -4.1433f, 0.0315f},
+     {-0.7270f, 9.1595f, 0.0831f},
+     {-8.6579f, 1.8830f, 0.0131f}},
+    // c in [7, 7.5]: 79% attractor, 21% diverged, 0% fixed point
+    {{7.5856f, -7.5423f, 0.0955f},
+     {1.6385f, -2.8206f, 0.0330f},
+     {2.8226f, -5.8283f, 0.0371f},
+     {-6.5443f, -7.5777f, 0.0140f}},
+    // c in [7.5, 8]: 83% attractor, 17% diverged, 0% fixed point
+    {{4.0748f, -13.2540f, 0.0359f},
+     {-7.2064f, 3.9348f, 0.0137f},
+     {5.5901f, -3.4771f, 0.0622f},
+     {4.9305f, -3.4928f, 0.0535f}},
+    // c in [8, 8.5]: 82% attractor, 18% diverged, 0% fixed point
+    {{-1.9006f, -0.5594f, 0.0196f},
+     {3.0016f, 5.1166f, 0.0477f},
+     {-1.0837f, 0.1858f, 0.0946f},
+     {-0.9675f, -0.4421f, 0.0257f}},
+    // c in [8.5, 9]: 78% attractor, 22% diverged, 0% fixed point
+    {{5.2787f, 4.3589f, 0.0753f},
+     {-2.1024f, -8.8737f, 0.0173f},
+     {1.7168f, 0.2498f, 0.0285f},
+     {8.8601f, -7.7826f, 0.0873f}},
+    // c in [9, 9.5]: 80% attractor, 20% diverged, 0% fixed point
+    {{-1.7126f, 0.8963f, 0.0185f},
+     {-9.0951f, 10.0033f, 0.0113f},
+     {2.9532f, 7.1010f, 0.0414f},
+     {13.6520f, -12.2059f, 0.2403f}},
+    // c in [9.5, 10]: 86% attractor, 14% diverged, 0% fixed point
+    {{-1.1310f, -16.7591f, 0.0165f},
+     {0.0127f, -0.4251f, 0.0205f},
+     {-0.6615f, 1.5334f, 0.0195f},
+     {4.6207f, 9.2056f, 0.0900f}},
+    // c in [10, 10.5]: 84% attractor, 16% diverged, 0% fixed point
+    {{11.7915f, -3.6118f, 0.1873f},
+     {1.2698f, -4.6469f, 0.0212f},
+     {-4.8868f, -14.3469f, 0.0125f},
+     {0.4696f, 0.0487f, 0.0205f}},
+    // c in [10.5, 11]: 85% attractor, 15% diverged, 0% fixed point
+    {{18.3253f, -3.9540f, 8.2064f},
+     {-16.7030f, -2.8280f, 0.0073f},
+     {-4.6545f, 0.1762f, 0.0130f},
+     {-4.3861f, 2.0360f, 0.0134f}},
+    // c in [11, 11.5]: 84% attractor, 16% diverged, 0% fixed point
+    {{2.7822f, 9.8330f, 0.0293f},
+     {19.3285f, -13.8961f, 0.8678f},
+     {6.6243f, 11.4950f, 0.3013f},
+     {1.4893f, -4.3919f, 0.0197f}},
+    // c in [11.5, 12]: 82% attractor, 18% diverged, 0% fixed point
+    {{-2.7922f, 2.8142f, 0.0140f},
+     {6.0261f, 12.4698f, 1.6740f},
+     {0.2186f, -18.0259f, 0.0156f},
+     {-5.6528f, -0.1692f, 0.0115f}},
+};
+inline constexpr bool ROSSLER_VERIFIED[] = {
+    true, true, true, true, true, true, true, true,
+    true, true, true, true, true, true, true, true};
+inline constexpr SeedTable ROSSLER_SEED_TABLE{4.0000f, 12.0000f, ROSSLER_SEEDS,
+    ROSSLER_VERIFIED, 16};
+inline const vec3f *model_seeds(const Rossler &m) {
+    return ROSSLER_SEED_TABLE.lookup(m.c);
+}
+inline bool model_seeds_verified(const Rossler &m) {
+    return ROSSLER_SEED_TABLE.is_verified(m.c);
+}
+
+/// Seeds of Halvorsen vs a in [1.3, 2.1]
+inline constexpr vec3f HALVORSEN_SEEDS[][SeedTable::SEEDS_PER_CELL] = {
+    // a in [1.3, 1.35]: 21% attractor, 79% diverged, 0% fixed point
+    {{3.3688f, -3.8232f, -2.6574f},
+     {-5.1943f, -0.8197f, -4.0230f},
+     {0.0875f, 0.7161f, -5.3985f},
+     {3.4340f, -3.8825f, -2.5741f}},
+    // a in [1.35, 1.4]: 17% attractor, 83% diverged, 0% fixed point
+    {{-7.2573f, -5.7421f, 4.6747f},
+     {-2.6168f, 0.7914f, -8.2953f},
+     {-9.7426f, -2.0908f, -2.4712f},
+     {-7.5891f, 4.4856f, -9.7823f}},
+    // a in [1.4, 1.45]: 20% attractor, 80% diverged, 0% fixed point
+    {{-5.8611f, -10.6870f, -2.2788f},
+     {1.0146f, -11.0005f, -5.5155f},
+     {-12.2881f, -3.8393f, -4.4654f},
+     {-1.4308f, -0.2271f, -5.7343f}},
+    // a in [1.45, 1.5]: 25% attractor, 75% diverged, 0% fixed point
+    {{-5.2600f, 4.6908f, -4.2760f},
+     {0.3085f, -6.5957f, -3.8493f},
+     {5.1678f, -5.7236f, -5.8908f},
+     {-6.3902f, 4.3734f, -4.5435f}},
+    // a in [1.5, 1.55]: 21% attractor, 79% diverged, 0% fixed point
+    {{-7.3365f, 5.8265f, -5.8744f},
+     {-1.1688f, -12.3218f, -5.2688f},
+     {-7.9938f, 2.3287f, -12.5810f},
+     {-0.3091f, -7.2618f, -6.0202f}},
+    // a in [1.55, 1.6]: 22% attractor, 78% diverged, 0% fixed point
+    {{2.8004f, -6.8540f, -3.6334f},
+     {-4.2383f, 3.4321f, -2.6848f},
+     {-9.6052f, 5.4845f, -10.5778f},
+     {-3.9137f, -6.7309f, 1.4136f}},
+    // a in [1.6, 1.65]: 24% attractor, 76% diverged, 0% fixed point
+    {{-6.5559f, -0.1522f, -12.9913f},
+     {-5.8061f, 3.9053f, -1.6893f},
+     {1.8487f, 0.0716f, -5.0004f},
+     {-4.8240f, -1.1865f, -7.4635f}},
+    // a in [1.65, 1.7]: 23% attractor, 77% diverged, 0% fixed point
+    {{-10.2151f, -3.2912f, -1.2483f},
+     {-2.1124f, 2.2985f, -5.3704f},
+     {-2.3653f, 2.3604f, -5.4579f},
+     {-8.6094f, -9.4005f, 6.2847f}},
+    // a in [1.7, 1.75]: 26% attractor, 74% diverged, 0% fixed point
+    {{-4.8615f, -1.3017f, 1.9021f},
+     {-5.2276f, 4.5065f, -3.1921f},
+     {-3.0413f, -9.5099f, -1.8414f},
+     {0.9765f, 0.9266f, -4.3960f}},
+    // a in [1.75, 1.8]: 28% attractor, 72% diverged, 0% fixed point
+    {{-8.2400f, 6.1197f, -7.2530f},
+     {3.1020f, -1.5379f, -4.3266f},
+     {-4.7584f, -10.6172f, -2.4723f},
+     {6.3852f, -7.1313f, -8.8111f}},
+    // a in [1.8, 1.85]: 29% attractor, 71% diverged, 0% fixed point
+    {{0.5198f, -4.5799f, -0.6168f},
+     {-2.1044f, -4.3340f, -10.0893f},
+     {-7.6230f, -8.7682f, 6.2863f},
+     {1.9191f, -0.1926f, -4.0917f}},
+    // a in [1.85, 1.9]: 29% attractor, 71% diverged, 0% fixed point
+    {{0.4627f, -6.2871f, -5.3258f},
+     {-4.0462f, 1.8776f, -0.0173f},
+     {-5.8512f, -3.4988f, 0.6791f},
+     {-4.0621f, 1.9354f, -0.0525f}},
+    // a in [1.9, 1.95]: 30% attractor, 70% diverged, 0% fixed point
+    {{-5.9942f, -6.9331f, 0.0819f},
+     {-3.9826f, -2.1210f, -11.3044f},
+     {-4.3618f, -0.6923f, 0.9882f},
+     {-5.2981f, -8.5460f, -0.8236f}},
+    // a in [1.95, 2]: 24% attractor, 76% diverged, 0% fixed point
+    {{-3.9219f, 1.0300f, -5.6901f},
+     {-1.9845f, 1.2482f, -4.8819f},
+     {4.8733f, -2.8074f, -6.1676f},
+     {3.0601f, -11.7471f, -8.0087f}},
+    // a in [2, 2.05]: 33% attractor, 67% diverged, 0% fixed point
+    {{-11.4103f, -8.3502f, 3.7094f},
+     {-1.3795f, 1.6111f, -4.3986f},
+     {-5.6098f, 4.2894f, -1.9891f},
+     {-5.4292f, -7.2422f, 0.0499f}},
+    // a in [2.05, 2.1]: 32% attractor, 68% diverged, 0% fixed point
+    {{-8.5310f, 4.1626f, -11.0646f},
+     {-11.6256f, -5.6040f, 0.1186f},
+     {-3.7426f, 1.1135f, 1.0212f},
+     {-4.2272f, -1.4154f, 2.0100f}},
+};
+inline constexpr bool HALVORSEN_VERIFIED[] = {
+    true, true, true, true, true, true, true, true,
+    true, true, true, true, true, true, true, true};
+inline constexpr SeedTable HALVORSEN_SEED_TABLE{1.3000f, 2.1000f, HALVORSEN_SEEDS,
+    HALVORSEN_VERIFIED, 16};
+inline const vec3f *model_seeds(const Halvorsen &m) {
+    return HALVORSEN_SEED_TABLE.lookup(m.a);
+}
+inline bool model_seeds_verified(const Halvorsen &m) {
+    return HALVORSEN_SEED_TABLE.is_verified(m.a);
+}
+
+/// Seeds of Lorentz vs rho in [25, 60]
+inline constexpr vec3f LORENTZ_SEEDS[][SeedTable::SEEDS_PER_CELL] = {
+    // rho in [25, 27.19]: 100% attractor, 0% diverged, 0% fixed point
+    {{-7.6204f, -0.6352f, 31.8983f},
+     {7.3627f, 0.3666f, 31.6914f},
+     {5.7763f, 8.1705f, 18.7719f},
+     {-10.3269f, -17.2044f, 16.5530f}},
+    // rho in [27.19, 29.38]: 100% attractor, 0% diverged, 0% fixed point
+    {{16.6447f, 19.7697f, 35.5394f},
+     {12.7273f, 10.9441f, 34.6036f},
+     {-1.0228f, -1.8076f, 13.6206f},
+     {-4.3340f, -5.6276f, 19.5232f}},
+    // rho in [29.38, 31.56]: 100% attractor, 0% diverged, 0% fixed point
+    {{-1.5356f, -1.7930f, 19.0931f},
+     {11.4416f, 19.7720f, 20.0634f},
+     {-17.0618f, -19.4477f, 38.9456f},
+     {11.0765f, 17.7925f, 22.4594f}},
+    // rho in [31.56, 33.75]: 100% attractor, 0% diverged, 0% fixed point
+    {{1.7633f, 3.5915f, 8.8260f},
+     {2.6965f, 4.6299f, 20.3532f},
+     {-0.0129f, -1.1799f, 22.9750f},
+     {6.9831f, 10.5859f, 22.3282f}},
+    // rho in [33.75, 35.94]: 100% attractor, 0% diverged, 0% fixed point
+    {{1.8153f, 2.8442f, 19.1620f},
+     {-3.7770f, -9.8277f, 33.9166f},
+     {11.7294f, 11.1468f, 37.6414f},
+     {-1.8996f, -3.8774f, 24.5036f}},
+    // rho in [35.94, 38.12]: 100% attractor, 0% diverged, 0% fixed point
+    {{-3.4947f, -3.0876f, 28.5362f},
+     {1.2507f, 2.8484f, 24.8241f},
+     {-2.2356f, -5.2858f, 29.1987f},
+     {8.1078f, 12.8338f, 26.7972f}},
+    // rho in [38.12, 40.31]: 100% attractor, 0% diverged, 0% fixed point
+    {{8.8642f, 13.4303f, 29.5359f},
+     {14.4033f, 19.7807f, 38.7373f},
+     {-0.4269f, -0.0372f, 24.5426f},
+     {-13.0799f, -19.2107f, 35.2990f}},
+    // rho in [40.31, 42.5]: 100% attractor, 0% diverged, 0% fixed point
+    {{-11.3550f, -8.4199f, 44.8450f},
+     {13.8789f, 7.5182f, 51.0378f},
+     {-4.0387f, -4.7410f, 30.2283f},
+     {-0.9767f, -4.6118f, 33.6891f}},
+    // rho in [42.5, 44.69]: 100% attractor, 0% diverged, 0% fixed point
+    {{8.0613f, 0.8710f, 46.2728f},
+     {-14.4974f, -22.3966f, 39.2755f},
+     {12.9173f, 7.2133f, 51.0260f},
+     {-3.1892f, -6.0046f, 26.1856f}},
+    // rho in [44.69, 46.88]: 100% attractor, 0% diverged, 0% fixed point
+    {{9.8490f, 12.7571f, 39.4609f},
+     {13.1586f, 25.8361f, 29.5598f},
+     {9.2748f, 19.4123f, 22.4267f},
+     {0.4254f, -4.2070f, 38.9860f}},
+    // rho in [46.88, 49.06]: 100% attractor, 0% diverged, 0% fixed point
+    {{4.9191f, 1.5988f, 42.5836f},
+     {12.3909f, 21.3098f, 37.1500f},
+     {-5.6018f, -12.0569f, 20.5920f},
+     {-8.8015f, -17.1696f, 27.9316f}},
+    // rho in [49.06, 51.25]: 100% attractor, 0% diverged, 0% fixed point
+    {{-7.5185f, -5.4105f, 45.9053f},
+     {2.7467f, 1.6162f, 38.3376f},
+     {0.2011f, 6.0959f, 43.3971f},
+     {1.6554f, -5.0378f, 45.3716f}},
+    // rho in [51.25, 53.44]: 100% attractor, 0% diverged, 0% fixed point
+    {{7.3977f, -4.4992f, 55.9817f},
+     {-1.5267f, -3.9816f, 35.8376f},
+     {2.5298f, 4.9818f, 27.0391f},
+     {-2.0545f, -4.6283f, 20.1480f}},
+    // rho in [53.44, 55.62]: 100% attractor, 0% diverged, 0% fixed point
+    {{5.2980f, 1.1457f, 48.9072f},
+     {-14.0622f, -15.8730f, 56.6975f},
+     {-4.4882f, -9.7638f, 25.7367f},
+     {5.7143f, 8.2691f, 39.3617f}},
+    // rho in [55.62, 57.81]: 100% attractor, 0% diverged, 0% fixed point
+    {{-8.7636f, 2.0081f, 60.1069f},
+     {-15.1720f, -22.1313f, 53.3738f},
+     {10.2087f, 2.6148f, 59.5450f},
+     {-20.9732f, -31.6382f, 61.6436f}},
+    // rho in [57.81, 60]: 100% attractor, 0% diverged, 0% fixed point
+    {{-0.5189f, -1.2269f, 24.1309f},
+     {4.2663f, 9.5555f, 27.0395f},
+     {-0.3265f, -7.1164f, 50.4603f},
+     {-5.7030f, -5.7845f, 47.1787f}},
+};
+inline constexpr bool LORENTZ_VERIFIED[] = {
+    true, true, true, true, true, true, true, true,
+    true, true, true, true, true, true, true, true};
+inline constexpr SeedTable LORENTZ_SEED_TABLE{25.0000f, 60.0000f, LORENTZ_SEEDS,
+    LORENTZ_VERIFIED, 16};
+inline const vec3f *model_seeds(const Lorentz &m) {
+    return LORENTZ_SEED_TABLE.lookup(m.rho);
+}
+inline bool model_seeds_verified(const Lorentz &m) {
+    return LORENTZ_SEED_TABLE.is_verified(m.rho);
+}
+
+} // namespace math
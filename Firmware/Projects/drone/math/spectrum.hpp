@@ -0,0 +1,156 @@
+#pragma once
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+
+namespace math {
+
+/// @brief Summary of an averaged power spectrum, all frequencies in Hz
+struct SpectrumStats {
+    /// @brief Frequency of the strongest bin (DC excluded)
+    float dominant = 0.0f;
+    /// @brief Power-weighted mean frequency
+    float centroid = 0.0f;
+    /// @brief Power-weighted standard deviation around the centroid
+    float bandwidth = 0.0f;
+    /// @brief Number of frames averaged so far
+    size_t frames = 0;
+};
+
+/**
+ * @brief Streaming Welch power spectrum estimator.
+ *
+ * Samples are pushed in blocks of any size; every `N / 2` samples a Hann-windowed frame of the
+ * last `N` samples is transformed and its power spectrum is added to the running average.
+ * The frame mean is removed before windowing, so that the offset of the attractor does not
+ * leak into the lowest bins. Memory is fixed at construction: a few arrays of `N` floats.
+ *
+ * @tparam N frame length, must be a power of two
+ */
+template <size_t N> class WelchAnalyzer {
+    static_assert(N >= 4 && (N & (N - 1)) == 0, "WelchAnalyzer frame length must be a power of two");
+
+  public:
+    static constexpr size_t BINS = N / 2 + 1;
+    static constexpr size_t HOP = N / 2;
+
+    explicit WelchAnalyzer(float sampling_frequency) : sampling_frequency(sampling_frequency) {
+        constexpr double TWO_PI = 6.283185307179586;
+        for (size_t i = 0; i < N; i++)
+            window[i] = static_cast<float>(0.5 - 0.5 * std::cos(TWO_PI * i / N));
+        for (size_t i = 0; i < N / 2; i++) {
+            twiddle_re[i] = static_cast<float>(std::cos(TWO_PI * i / N));
+            twiddle_im[i] = static_cast<float>(-std::sin(TWO_PI * i / N));
+        }
+        reset();
+    }
+
+    void reset() {
+        fill = 0;
+        frames = 0;
+        power.fill(0.0f);
+    }
+
+    void push(const float *samples, size_t size) {
+        for (size_t i = 0; i < size; i++) {
+            frame[fill++] = samples[i];
+            if (fill == N) {
+                analyze_frame();
+                // 50% overlap: keep the second half as the start of the next frame
+                for (size_t k = 0; k < HOP; k++)
+                    frame[k] = frame[k + HOP];
+                fill = HOP;
+            }
+        }
+    }
+
+    /// @brief Frequency of bin `k`, in Hz.
+    [[nodiscard]] float bin_frequency(size_t k) const {
+        return static_cast<float>(k) * sampling_frequency / N;
+    }
+
+    /// @brief Averaged power of bin `k`, in arbitrary units.
+    [[nodiscard]] float bin_power(size_t k) const {
+        return frames ? static_cast<float>(power[k] / frames) : 0.0f;
+    }
+
+    [[nodiscard]] SpectrumStats stats() const {
+        SpectrumStats result;
+        result.frames = frames;
+
+        double total = 0.0, weighted = 0.0, peak = 0.0;
+        for (size_t k = 1; k < BINS; k++) {
+            total += power[k];
+            weighted += power[k] * bin_frequency(k);
+            if (power[k] > peak) {
+                peak = power[k];
+                result.dominant = bin_frequency(k);
+            }
+        }
+        if (total <= 0.0)
+            return result;
+
+        double centroid = weighted / total;
+        double spread = 0.0;
+        for (size_t k = 1; k < BINS; k++) {
+            double d = bin_frequency(k) - centroid;
+            spread += power[k] * d * d;
+        }
+
+        result.centroid = static_cast<float>(centroid);
+        result.bandwidth = static_cast<float>(std::sqrt(spread / total));
+        return result;
+    }
+
+  private:
+    float sampling_frequency;
+    size_t fill;
+    size_t frames;
+
+    std::array<float, N> frame;
+    std::array<float, N> window;
+    std::array<float, N / 2> twiddle_re, twiddle_im;
+    std::array<float, N> re, im;
+    std::array<double, BINS> power;
+
+    void analyze_frame() {
+        float mean = 0.0f;
+        for (size_t i = 0; i < N; i++)
+            mean += frame[i];
+        mean /= N;
+
+        // Windowed copy in bit-reversed order
+        for (size_t i = 0, j = 0; i < N; i++) {
+            re[j] = (frame[i] - mean) * window[i];
+            im[j] = 0.0f;
+            size_t bit = N >> 1;
+            for (; j & bit; bit >>= 1)
+                j ^= bit;
+            j |= bit;
+        }
+
+        // Iterative radix-2 FFT
+        for (size_t len = 2; len <= N; len <<= 1) {
+            size_t half = len / 2, stride = N / len;
+            for (size_t start = 0; start < N; start += len) {
+                for (size_t k = 0; k < half; k++) {
+                    float wr = twiddle_re[k * stride], wi = twiddle_im[k * stride];
+                    size_t a = start + k, b = a + half;
+                    float tr = re[b] * wr - im[b] * wi;
+                    float ti = re[b] * wi + im[b] * wr;
+                    re[b] = re[a] - tr;
+                    im[b] = im[a] - ti;
+                    re[a] += tr;
+                    im[a] += ti;
+                }
+            }
+        }
+
+        for (size_t k = 0; k < BINS; k++)
+            power[k] += static_cast<double>(re[k]) * re[k] + static_cast<double>(im[k]) * im[k];
+        frames++;
+    }
+};
+
+} // namespace math
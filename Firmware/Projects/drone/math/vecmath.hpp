@@ -1,10 +1,13 @@
 #pragma once
 
+#include <cmath>
 #include <cstdint>
 #include <initializer_list>
 #include <type_traits> // std::enable_if
 #include <utility>
 
+#include "fastmath.hpp"
+
 namespace math {
 
     constexpr double PI = 3.1415926535897932385;
@@ -13,22 +16,27 @@ namespace math {
     // generic math
 
     template<class T>
-    inline T max(T x, T y) {
+    constexpr T max(T x, T y) {
         return x >= y ? x : y;
     }
 
     template<class T>
-    inline T min(T x, T y) {
+    constexpr T min(T x, T y) {
         return x <= y ? x : y;
     }
 
+    // A single conditional expression, which compiles to conditional selects (VSEL on FPv5,
+    // MINSS/MAXSS on x86) instead of branches; also usable on other ordered scalars such as
+    // dual numbers.
     template <typename T>
     T clamp(T x, T min, T max) {
-        static_assert(std::is_arithmetic<T>::value, "clamp requires a numeric type");
+        return x < min ? min : (x > max ? max : x);
+    }
 
-        if (x < min) return min;
-        if (x > max) return max;
-        return x;
+    /// false for NaN and Inf: states of diverging models, which must not reach a fixed-point or
+    /// integer conversion
+    inline bool is_finite(float x) {
+        return std::isfinite(x);
     }
 
     namespace _internal {
@@ -113,7 +121,7 @@ namespace math {
             return res;
         }
 
-        vec operator-(vec that) {
+        vec operator-(vec that) const {
             return operator+(-that);
         }
 
@@ -142,6 +150,9 @@ namespace math {
         }
 
         vec normalized() const {
+            if constexpr (std::is_same<T, float>::value) {
+                return *this * fast::rsqrt(length_sq());
+            }
             return *this / length();
         }
     };
@@ -180,6 +191,63 @@ namespace math {
         return acc;
     }
 
+    template<class T>
+    vec<3, T> cross(vec<3, T> a, vec<3, T> b) {
+        return {
+            a.y()*b.z() - a.z()*b.y(),
+            a.z()*b.x() - a.x()*b.z(),
+            a.x()*b.y() - a.y()*b.x(),
+        };
+    }
+
+    /**
+     * @brief Square matrix, stored as an array of row vectors.
+     */
+    template<size_t N, class T>
+    struct mat {
+        vec<N, T> r[N];
+
+        static mat identity() {
+            mat res;
+            for (size_t i = 0; i < N; i++) {
+                for (size_t j = 0; j < N; j++) {
+                    res.r[i][j] = i == j ? T(1) : T(0);
+                }
+            }
+            return res;
+        }
+
+        vec<N, T>& operator[](size_t i) {
+            return r[i];
+        }
+
+        const vec<N, T>& operator[](size_t i) const {
+            return r[i];
+        }
+
+        vec<N, T> operator*(vec<N, T> v) const {
+            vec<N, T> res;
+            for (size_t i = 0; i < N; i++) {
+                res[i] = dot(r[i], v);
+            }
+            return res;
+        }
+
+        mat operator*(const mat& that) const {
+            mat res;
+            for (size_t i = 0; i < N; i++) {
+                for (size_t j = 0; j < N; j++) {
+                    T acc(0);
+                    for (size_t k = 0; k < N; k++) {
+                        acc += r[i][k] * that.r[k][j];
+                    }
+                    res.r[i][j] = acc;
+                }
+            }
+            return res;
+        }
+    };
+
 
     template<size_t N, class T>
     struct point : public _internal::raw_vec<N, T> {
@@ -221,6 +289,70 @@ namespace math {
         }
     };
 
+    /**
+     * @brief Lazily evaluated vector expression.
+     *
+     * Sums and scalings of `lazy(v)` build an expression tree instead of temporary vectors;
+     * the whole expression is evaluated component by component, in a single loop, when it is
+     * converted to a vec.
+     */
+    template<size_t N, class T, class E>
+    struct vec_expr {
+        E e;
+
+        T operator[](size_t i) const {
+            return e[i];
+        }
+
+        operator vec<N, T>() const {
+            vec<N, T> res;
+            for (size_t i = 0; i < N; i++) {
+                res[i] = e[i];
+            }
+            return res;
+        }
+    };
+
+    namespace _internal {
+        template<size_t N, class T>
+        struct expr_ref {
+            const vec<N, T>& v;
+            T operator[](size_t i) const { return v[i]; }
+        };
+
+        template<class A, class B>
+        struct expr_add {
+            A a;
+            B b;
+            auto operator[](size_t i) const { return a[i] + b[i]; }
+        };
+
+        template<class T, class A>
+        struct expr_scale {
+            T s;
+            A a;
+            auto operator[](size_t i) const { return s * a[i]; }
+        };
+    };
+
+    /// @brief Wraps a vector into an expression; it must outlive the expression.
+    template<size_t N, class T>
+    vec_expr<N, T, _internal::expr_ref<N, T>> lazy(const vec<N, T>& v) {
+        return {{v}};
+    }
+
+    template<size_t N, class T, class A, class B>
+    vec_expr<N, T, _internal::expr_add<vec_expr<N, T, A>, vec_expr<N, T, B>>>
+    operator+(vec_expr<N, T, A> a, vec_expr<N, T, B> b) {
+        return {{a, b}};
+    }
+
+    template<size_t N, class T, class A>
+    vec_expr<N, T, _internal::expr_scale<T, vec_expr<N, T, A>>>
+    operator*(T s, vec_expr<N, T, A> a) {
+        return {{s, a}};
+    }
+
     // Useful type definitions
 
     using vec2i = vec<2, uint32_t>;
@@ -237,6 +369,23 @@ namespace math {
     using point4i = point<4, uint32_t>;
     using point4f = point<4, float>;
 
+    /// @brief Inverse of a 3x3 matrix (adjugate over determinant); the matrix must be invertible.
+    template<class T>
+    mat<3, T> inverse(const mat<3, T>& m) {
+        // the columns of the adjugate are cross products of the rows
+        vec<3, T> c0 = cross(m[1], m[2]), c1 = cross(m[2], m[0]), c2 = cross(m[0], m[1]);
+        T inv_det = T(1) / dot(m[0], c0);
+
+        mat<3, T> res;
+        for (size_t i = 0; i < 3; i++) {
+            res[i] = vec<3, T>{c0[i], c1[i], c2[i]} * inv_det;
+        }
+        return res;
+    }
+
+    using mat2f = mat<2, float>;
+    using mat3f = mat<3, float>;
+
     // Other math
 
     template<size_t N, class T>
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Lock-free single-producer single-consumer ring buffer.
+ *
+ * The producer (e.g. an interrupt callback) never blocks nor waits for the consumer:
+ * when the buffer is full, new elements are dropped and counted.
+ * Only one "process" may push and only one "process" may pop at any time.
+ *
+ * @tparam N capacity of the buffer, must be a power of two
+ */
+template <typename T, size_t N> class RingBuf {
+    static_assert(N > 0 && (N & (N - 1)) == 0, "RingBuf capacity must be a power of two");
+
+public:
+    /// @brief Appends an element (producer side).
+    /// @return false if the buffer was full and the element has been dropped
+    bool push(const T &value) {
+        size_t head = _head.load(std::memory_order_relaxed);
+        // acquire: the consumer is done reading the slots it released
+        size_t tail = _tail.load(std::memory_order_acquire);
+
+        if (head - tail == N) {
+            // only the producer writes this counter
+            _dropped.store(_dropped.load(std::memory_order_relaxed) + 1,
+                           std::memory_order_relaxed);
+            return false;
+        }
+
+        _data[head & (N - 1)] = value;
+
+        // release: the element is visible before the new head
+        _head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// @brief Moves up to `max_count` elements to `out`, oldest first (consumer side).
+    /// @return number of elements copied
+    size_t pop(T *out, size_t max_count) {
+        size_t tail = _tail.load(std::memory_order_relaxed);
+        // acquire: see the elements published by the producer
+        size_t head = _head.load(std::memory_order_acquire);
+
+        size_t count = head - tail;
+        if (count > max_count) {
+            count = max_count;
+        }
+
+        for (size_t i = 0; i < count; i++) {
+            out[i] = _data[(tail + i) & (N - 1)];
+        }
+
+        // release: the slots can be overwritten only after they have been read
+        _tail.store(tail + count, std::memory_order_release);
+        return count;
+    }
+
+    /// @brief Number of elements waiting to be popped (approximate if called by the producer).
+    size_t size() const {
+        return _head.load(std::memory_order_acquire) - _tail.load(std::memory_order_acquire);
+    }
+
+    static constexpr size_t capacity() { return N; }
+
+    /// @brief Number of elements dropped because the buffer was full.
+    uint32_t dropped() const { return _dropped.load(std::memory_order_relaxed); }
+
+private:
+    T _data[N];
+    // free-running indices: wrap-around of size_t is harmless since N divides 2^k
+    std::atomic<size_t> _head{0}, _tail{0};
+    std::atomic<uint32_t> _dropped{0};
+};
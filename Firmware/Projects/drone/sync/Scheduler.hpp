@@ -0,0 +1,184 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Tickless cooperative scheduler for the main loop.
+ *
+ * Tasks run to completion, one at a time, in main. A task becomes ready when its period elapses
+ * or when an interrupt callback signals it; among ready tasks, the one with the earliest
+ * deadline runs first. When no task is ready the scheduler sleeps until the next interrupt.
+ * Each task records its runs, deadline misses and CPU time.
+ *
+ * Times are in microseconds and wrap around every 2^32 us (about 71 minutes): they are only
+ * compared through differences, so tasks may not have periods or deadlines above 2^31 us.
+ *
+ * @tparam Clock provides `uint32_t now()` and `void sleep(ready, wake_time)`, which returns
+ *         immediately if `ready()` is true, else waits for an interrupt (or simulates one on the
+ *         host) without missing a signal raised between the check and the wait; `wake_time` is
+ *         the next periodic release, which the wait may use as a timeout
+ * @tparam N maximum number of tasks
+ */
+template <class Clock, size_t N> class Scheduler {
+public:
+    using Function = void (*)(void *data);
+
+    struct Stats {
+        uint32_t runs = 0;
+        /// Runs which completed after their deadline
+        uint32_t misses = 0;
+        /// Periodic releases skipped because the task was still late from the previous ones
+        uint32_t skipped = 0;
+        uint64_t cpu_time = 0;
+        uint32_t max_time = 0;
+        /// Longest delay between the release of the task and the end of its run
+        uint32_t max_response = 0;
+    };
+
+    explicit Scheduler(Clock &clock) : _clock(clock) {}
+
+    /**
+     * @brief Adds a task, first released now.
+     * @param period between periodic releases; 0 for a task only released by `signal()`
+     * @param deadline relative to each release
+     * @return index of the task, or N if the scheduler is full
+     */
+    size_t add(const char *name, Function function, void *data, uint32_t period,
+               uint32_t deadline) {
+        if (_count == N)
+            return N;
+
+        Task &task = _tasks[_count];
+        task.name = name;
+        task.function = function;
+        task.data = data;
+        task.period = period;
+        task.deadline = deadline;
+        task.next_release = _clock.now();
+        return _count++;
+    }
+
+    /// @brief Releases a task; safe to call from interrupt callbacks.
+    void signal(size_t task) { _tasks[task].signaled.store(true, std::memory_order_release); }
+
+    /**
+     * @brief Runs the ready task with the earliest deadline, or sleeps until an interrupt if no
+     * task is ready.
+     */
+    void run_once() {
+        uint32_t now = _clock.now();
+        Task *next = nullptr;
+
+        for (size_t i = 0; i < _count; i++) {
+            Task &task = _tasks[i];
+            release(task, now);
+            if (task.pending && (!next || before(task.release + task.deadline,
+                                                 next->release + next->deadline))) {
+                next = &task;
+            }
+        }
+
+        if (!next) {
+            uint32_t start = now;
+            _clock.sleep([this] { return any_signaled(); }, next_release(now));
+            _idle_time += _clock.now() - start;
+            return;
+        }
+
+        next->pending = false;
+        uint32_t start = _clock.now();
+        next->function(next->data);
+        uint32_t end = _clock.now();
+
+        Stats &stats = next->stats;
+        uint32_t elapsed = end - start;
+        uint32_t response = end - next->release;
+        stats.runs++;
+        stats.cpu_time += elapsed;
+        if (elapsed > stats.max_time)
+            stats.max_time = elapsed;
+        if (response > stats.max_response)
+            stats.max_response = response;
+        if (response > next->deadline)
+            stats.misses++;
+    }
+
+    size_t size() const { return _count; }
+    const char *name(size_t task) const { return _tasks[task].name; }
+    const Stats &stats(size_t task) const { return _tasks[task].stats; }
+
+    /// @brief Time spent sleeping so far
+    uint64_t idle_time() const { return _idle_time; }
+
+private:
+    struct Task {
+        const char *name = nullptr;
+        Function function = nullptr;
+        void *data = nullptr;
+        uint32_t period = 0;
+        uint32_t deadline = 0;
+
+        /// Next periodic release
+        uint32_t next_release = 0;
+        /// Release of the pending run
+        uint32_t release = 0;
+        bool pending = false;
+        std::atomic_bool signaled{false};
+
+        Stats stats;
+    };
+
+    Clock &_clock;
+    Task _tasks[N];
+    size_t _count = 0;
+    uint64_t _idle_time = 0;
+
+    static bool before(uint32_t a, uint32_t b) { return static_cast<int32_t>(a - b) < 0; }
+
+    /// @brief Turns elapsed periods and signals into a pending run.
+    void release(Task &task, uint32_t now) {
+        bool released = false;
+
+        if (task.period != 0 && !before(now, task.next_release)) {
+            uint32_t release = task.next_release;
+            task.next_release += task.period;
+            // Too late for more releases: skip them rather than running the task back to back
+            if (!before(now, task.next_release)) {
+                uint32_t late = now - task.next_release;
+                task.stats.skipped += late / task.period + 1;
+                task.next_release += (late / task.period + 1) * task.period;
+            }
+            if (!task.pending)
+                task.release = release;
+            released = true;
+        }
+
+        if (task.signaled.exchange(false, std::memory_order_acquire)) {
+            if (!task.pending && !released)
+                task.release = now;
+            released = true;
+        }
+
+        task.pending |= released;
+    }
+
+    bool any_signaled() const {
+        for (size_t i = 0; i < _count; i++) {
+            if (_tasks[i].signaled.load(std::memory_order_relaxed))
+                return true;
+        }
+        return false;
+    }
+
+    /// @brief Earliest periodic release after `now`, or about 2^31 us after `now` if there is none.
+    uint32_t next_release(uint32_t now) const {
+        uint32_t next = now + (1u << 31) - 1;
+        for (size_t i = 0; i < _count; i++) {
+            if (_tasks[i].period != 0 && before(_tasks[i].next_release, next))
+                next = _tasks[i].next_release;
+        }
+        return next;
+    }
+};
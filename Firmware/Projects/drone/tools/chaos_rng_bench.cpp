@@ -0,0 +1,202 @@
+/*
+ * Host tool: statistical checks and throughput of the chaotic random generator
+ * (math/chaos_rng.hpp) on the 4D Crypto map, against std::mt19937.
+ *
+ * Build (from Firmware/Projects/drone):
+ *   g++ -std=gnu++17 -O2 tools/chaos_rng_bench.cpp math/models.cpp -o chaos_rng_bench
+ *
+ * Checks, on the whitened output of several seeds, and for reference on the raw extracted bits
+ * and on std::mt19937 (only the whitened output must pass):
+ *  - monobit: proportion of ones, as a normal deviate;
+ *  - runs: number of runs of identical bits, as a normal deviate (NIST SP 800-22, 2.3);
+ *  - bytes: chi-square of the byte frequencies, 255 degrees of freedom, as a normal deviate;
+ *  - serial: lag-1 correlation of uniform samples, times sqrt(n);
+ *  - mean and variance of uniform samples, as normal deviates.
+ * Deviates beyond 4.5 (p < 1e-5) fail. The map itself is checked for cycles in float precision
+ * over CYCLE_ITERATIONS iterations (Brent's algorithm), which the Weyl sequence of the whitening
+ * would mask otherwise. Exits with a non-zero status if a check fails.
+ * Host timings only give an idea of the relative cost: measure on the target.
+ */
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "../math/chaos_rng.hpp"
+#include "../math/models.hpp"
+
+using math::vec4f;
+using Rng = math::ChaosRng<math::Crypto>;
+
+constexpr size_t WORDS = 1 << 22;
+constexpr size_t CYCLE_ITERATIONS = size_t(1) << 26;
+constexpr double MAX_DEVIATE = 4.5;
+const vec4f INITIAL{0.2f, 0.2f, 0.2f, 0.2f};
+
+static bool failed = false;
+
+struct Deviates {
+    double monobit, runs, bytes, serial, mean, variance;
+};
+
+static Deviates analyze(const std::vector<uint32_t> &words) {
+    const double bits = 32.0 * words.size();
+    double ones = 0.0, runs = 1.0;
+    std::vector<double> bytes(256, 0.0);
+    uint32_t previous_bit = words[0] & 1u;
+    for (uint32_t w : words) {
+        ones += __builtin_popcount(w);
+        // A run ends wherever two consecutive bits differ, within the word and across words
+        uint32_t first = w & 1u;
+        runs += (first != previous_bit) + __builtin_popcount((w ^ (w >> 1)) & 0x7FFFFFFFu);
+        previous_bit = w >> 31;
+        for (int k = 0; k < 4; k++)
+            bytes[(w >> (8 * k)) & 0xFFu]++;
+    }
+
+    Deviates d;
+    d.monobit = (2.0 * ones - bits) / std::sqrt(bits);
+    double pi = ones / bits;
+    double spread = pi * (1.0 - pi);
+    d.runs = (runs - 2.0 * bits * spread) / (2.0 * std::sqrt(2.0 * bits) * spread);
+
+    double expected = 4.0 * words.size() / 256.0, chi2 = 0.0;
+    for (double count : bytes)
+        chi2 += (count - expected) * (count - expected) / expected;
+    d.bytes = (chi2 - 255.0) / std::sqrt(2.0 * 255.0);
+
+    // Uniform samples as produced by ChaosRng::uniform()
+    const double n = static_cast<double>(words.size());
+    double sum = 0.0, sum_sq = 0.0, lag = 0.0, last = 0.0;
+    for (size_t i = 0; i < words.size(); i++) {
+        double u = static_cast<double>(words[i] >> 8) * 0x1p-24 - 0.5;
+        sum += u;
+        sum_sq += u * u;
+        if (i > 0)
+            lag += u * last;
+        last = u;
+    }
+    d.mean = sum / n / std::sqrt(1.0 / 12.0 / n);
+    // Variance of u^2 for u uniform in [-1/2, 1/2): 1/80 - 1/144
+    d.variance = (sum_sq / n - 1.0 / 12.0) / std::sqrt((1.0 / 80.0 - 1.0 / 144.0) / n);
+    d.serial = lag / (n - 1.0) * 12.0 * std::sqrt(n - 1.0);
+    return d;
+}
+
+static void report(const char *name, const Deviates &d, bool must_pass) {
+    const double all[] = {d.monobit, d.runs, d.bytes, d.serial, d.mean, d.variance};
+    bool ok = true;
+    for (double deviate : all)
+        ok &= std::isfinite(deviate) && std::fabs(deviate) < MAX_DEVIATE;
+    failed |= must_pass && !ok;
+    std::printf("%-22s %9.2f %9.2f %9.2f %9.2f %9.2f %9.2f  %s\n", name, d.monobit, d.runs,
+                d.bytes, d.serial, d.mean, d.variance,
+                ok ? "ok" : (must_pass ? "FAIL" : "fails"));
+}
+
+/// The 16 low mantissa bits of the components, packed as ChaosRng does, without whitening
+static std::vector<uint32_t> raw_words(size_t count) {
+    math::Crypto map;
+    vec4f x = INITIAL;
+    for (size_t i = 0; i < Rng::WARMUP; i++)
+        x = map.step(x);
+
+    std::vector<uint32_t> words;
+    while (words.size() < count) {
+        x = map.step(x);
+        uint32_t bits[4];
+        std::memcpy(bits, &x, sizeof(bits));
+        words.push_back((bits[0] & 0xFFFFu) | (bits[1] & 0xFFFFu) << 16);
+        words.push_back((bits[2] & 0xFFFFu) | (bits[3] & 0xFFFFu) << 16);
+    }
+    return words;
+}
+
+/// @brief Length of the cycle the float map falls into from `x`, or 0 if none is found
+static size_t cycle_length(vec4f x) {
+    auto same = [](const vec4f &a, const vec4f &b) { return std::memcmp(&a, &b, sizeof(a)) == 0; };
+    math::Crypto map;
+    vec4f tortoise = x, hare = map.step(x);
+    size_t power = 1, length = 1;
+    for (size_t i = 0; i < CYCLE_ITERATIONS; i++) {
+        if (same(tortoise, hare))
+            return length;
+        if (power == length) {
+            tortoise = hare;
+            power *= 2;
+            length = 0;
+        }
+        hare = map.step(hare);
+        length++;
+    }
+    return 0;
+}
+
+template <class F> static double ns_per_call(size_t calls, F &&f) {
+    auto start = std::chrono::steady_clock::now();
+    uint32_t acc = 0;
+    for (size_t i = 0; i < calls; i++)
+        acc ^= f();
+    auto end = std::chrono::steady_clock::now();
+    volatile uint32_t sink = acc;
+    (void)sink;
+    return std::chrono::duration<double, std::nano>(end - start).count() / calls;
+}
+
+int main() {
+    std::printf("%-22s %9s %9s %9s %9s %9s %9s\n", "deviates", "monobit", "runs", "bytes",
+                "serial", "mean", "variance");
+
+    std::vector<uint32_t> words(WORDS);
+    for (uint32_t seed : {0u, 1u, 2u, 12345u}) {
+        Rng rng(math::Crypto{}, INITIAL, seed);
+        rng.fill(words.data(), words.size());
+        char name[32];
+        std::snprintf(name, sizeof(name), "chaos, seed %u", seed);
+        report(name, analyze(words), true);
+    }
+    report("raw map bits", analyze(raw_words(WORDS)), false);
+
+    std::mt19937 mt(5489u);
+    for (uint32_t &w : words)
+        w = mt();
+    report("std::mt19937", analyze(words), false);
+
+    // Seeds next to each other must give unrelated sequences
+    Rng a(math::Crypto{}, INITIAL, 7), b(math::Crypto{}, INITIAL, 8);
+    for (uint32_t &w : words)
+        w = a() ^ b();
+    report("seeds 7 ^ 8", analyze(words), true);
+
+    for (float start : {0.2f, -0.7f, 1.1f}) {
+        size_t length = cycle_length(vec4f{start, 0.2f, 0.2f, 0.2f});
+        if (length > 0)
+            std::printf("float map from x1 = %g: cycle of %zu iterations\n", start, length);
+        else
+            std::printf("float map from x1 = %g: no cycle within %zu iterations\n", start,
+                        CYCLE_ITERATIONS);
+    }
+
+    // -- Throughput --
+    constexpr size_t CALLS = 20000000;
+    Rng rng(math::Crypto{}, INITIAL, 1);
+    std::mt19937 reference(5489u);
+    double chaos_ns = ns_per_call(CALLS, [&] { return rng(); });
+    double mt_ns = ns_per_call(CALLS, [&] { return reference(); });
+    double uniform_ns = ns_per_call(CALLS, [&] {
+        float u = rng.uniform();
+        uint32_t bits;
+        std::memcpy(&bits, &u, sizeof(bits));
+        return bits;
+    });
+    std::printf("\n%-16s %10s %12s\n", "generator", "ns/word", "Mbit/s");
+    std::printf("%-16s %10.2f %12.1f\n", "chaos (Crypto)", chaos_ns, 32e3 / chaos_ns);
+    std::printf("%-16s %10.2f %12.1f\n", "std::mt19937", mt_ns, 32e3 / mt_ns);
+    std::printf("chaos uniform(): %.2f ns per sample\n", uniform_ns);
+
+    std::printf("\n%s\n", failed ? "FAIL" : "ok");
+    return failed ? 1 : 0;
+}
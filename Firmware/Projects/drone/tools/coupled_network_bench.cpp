@@ -0,0 +1,174 @@
+/*
+ * Host tool: cost and synchronization of coupled oscillator networks (math/network.hpp).
+ *
+ * Build (from Firmware/Projects/drone):
+ *   g++ -std=gnu++17 -O2 -fno-tree-slp-vectorize tools/coupled_network_bench.cpp math/models.cpp \
+ *       -o coupled_network_bench
+ *
+ * Cost, for 2 to 16 Rossler nodes (default parameters, RK4 at the default dt): ns per node and
+ * step of the uncoupled nodes stepped one by one with the fused kernel, of the network without
+ * links, with an x-x drive-response chain (one link per node) and with a mutual x-x ring (two
+ * links per node), and their ratios to the fused steps. The four cases are timed in turns, and
+ * the best of TIMED_RUNS runs is kept.
+ *
+ * Synchronization, on a drive-response chain 0 -> 1 -> ... -> N-1 linking x into x: each
+ * response starts from a different seed, and the distance between the last node and the drive,
+ * relative to the extent of the attractor, is averaged over MEASURE_TIME after TRANSIENT_TIME,
+ * for several gains:
+ *  - identical nodes: the error drops to rounding within the window of gains where the
+ *    synchronized state is stable. For Rossler coupled through x, the window is bounded on both
+ *    sides: above it, the responses leave the drive again, and may escape the attractor;
+ *  - responses whose c parameter is off by MISMATCH: the error stays small but finite (partial
+ *    synchronization), the responses follow the drive without copying it.
+ * Exits with a non-zero status if identical nodes do not synchronize at CHECKED_GAIN, or if the
+ * network without links costs more than MAX_UNCOUPLED_COST times the fused steps.
+ * Host timings only give an idea of the relative cost: measure on the target.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "../math/models.hpp"
+#include "../math/network.hpp"
+#include "../math/seed_tables.hpp"
+
+using math::vec3f;
+using Net = math::CoupledNetwork<math::Rossler, 16>;
+
+constexpr float TRANSIENT_TIME = 500.0f;
+constexpr float MEASURE_TIME = 200.0f;
+constexpr float MISMATCH = 0.02f;
+constexpr size_t TIMED_STEPS = 5000;
+constexpr size_t TIMED_RUNS = 100;
+/// Cost of the network without links, relative to the fused steps of the nodes
+constexpr double MAX_UNCOUPLED_COST = 1.15;
+/// Relative error below which the responses count as synchronized, at CHECKED_GAIN
+constexpr double SYNC_ERROR = 1e-4;
+constexpr float CHECKED_GAIN = 1.0f;
+
+static void seed(Net &net) {
+    const vec3f *seeds = math::model_seeds(math::Rossler{});
+    for (size_t i = 0; i < net.get_size(); i++) {
+        // Distinct starts, beyond the four seeds of the cell
+        float offset = 0.37f * static_cast<float>(i / math::SeedTable::SEEDS_PER_CELL);
+        net.state(i) = seeds[i % math::SeedTable::SEEDS_PER_CELL] + vec3f{offset, -offset, 0.0f};
+    }
+}
+
+template <class F> static double ns_per_node_step(size_t nodes, F &&step) {
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < TIMED_STEPS; i++)
+        step();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / TIMED_STEPS / nodes;
+}
+
+/// @return whether the network without links is within MAX_UNCOUPLED_COST of the fused steps
+static bool cost(size_t nodes) {
+    const math::rk4_coeffs<float> coeffs(math::DEFAULT_DT);
+
+    Net uncoupled(nodes), chain(nodes), ring(nodes);
+    seed(uncoupled);
+    seed(chain);
+    seed(ring);
+    for (size_t i = 1; i < nodes; i++)
+        chain.add_coupling({static_cast<uint8_t>(i - 1), static_cast<uint8_t>(i), 0, 0, 1.0f});
+    for (size_t i = 0; i < nodes; i++) {
+        auto a = static_cast<uint8_t>(i), b = static_cast<uint8_t>((i + 1) % nodes);
+        ring.add_coupling({a, b, 0, 0, 0.1f});
+        ring.add_coupling({b, a, 0, 0, 0.1f});
+    }
+    std::vector<vec3f> states(nodes);
+    for (size_t i = 0; i < nodes; i++)
+        states[i] = uncoupled.state(i);
+    const math::Rossler model;
+
+    // The best run is the least disturbed by the host
+    double fused_ns = INFINITY, uncoupled_ns = INFINITY, chain_ns = INFINITY, ring_ns = INFINITY;
+    for (size_t r = 0; r < TIMED_RUNS; r++) {
+        fused_ns = std::min(fused_ns, ns_per_node_step(nodes, [&] {
+            for (vec3f &x : states)
+                x = model.rk4_step(x, coeffs);
+        }));
+        uncoupled_ns = std::min(uncoupled_ns,
+                                ns_per_node_step(nodes, [&] { uncoupled.step(coeffs); }));
+        chain_ns = std::min(chain_ns, ns_per_node_step(nodes, [&] { chain.step(coeffs); }));
+        ring_ns = std::min(ring_ns, ns_per_node_step(nodes, [&] { ring.step(coeffs); }));
+    }
+
+    // Keep the results alive
+    volatile float sink = states[0].x() + uncoupled.state(0).x() + chain.state(0).x() +
+                          ring.state(0).x();
+    (void)sink;
+    bool ok = uncoupled_ns / fused_ns < MAX_UNCOUPLED_COST;
+    std::printf("%5zu %9.1f %9.1f %9.1f %9.1f %9.2f %9.2f %9.2f  %s\n", nodes, fused_ns,
+                uncoupled_ns, chain_ns, ring_ns, uncoupled_ns / fused_ns, chain_ns / fused_ns,
+                ring_ns / fused_ns, ok ? "ok" : "FAIL");
+    return ok;
+}
+
+/// @brief Mean distance between the last node of a chain and the drive, relative to the extent
+static double chain_error(size_t nodes, float gain, float mismatch) {
+    const math::rk4_coeffs<float> coeffs(math::DEFAULT_DT);
+    Net net(nodes);
+    seed(net);
+    for (size_t i = 1; i < nodes; i++) {
+        net.model(i).c *= 1.0f + mismatch;
+        net.add_coupling({static_cast<uint8_t>(i - 1), static_cast<uint8_t>(i), 0, 0, gain});
+    }
+
+    const auto transient = static_cast<size_t>(TRANSIENT_TIME / math::DEFAULT_DT);
+    const auto measure = static_cast<size_t>(MEASURE_TIME / math::DEFAULT_DT);
+    for (size_t i = 0; i < transient; i++)
+        net.step(coeffs);
+
+    double error = 0.0;
+    vec3f low = net.state(0), high = net.state(0);
+    for (size_t i = 0; i < measure; i++) {
+        net.step(coeffs);
+        error += net.sync_error(0, nodes - 1);
+        for (size_t k = 0; k < 3; k++) {
+            low[k] = std::min(low[k], net.state(0)[k]);
+            high[k] = std::max(high[k], net.state(0)[k]);
+        }
+    }
+    vec3f extent = high - low;
+    return error / measure / std::sqrt(math::dot(extent, extent));
+}
+
+int main() {
+    std::printf("ns per node and step, and relative to the fused steps\n");
+    std::printf("%5s %9s %9s %9s %9s %9s %9s %9s\n", "nodes", "fused", "network", "x chain",
+                "x ring", "network", "chain", "ring");
+    bool failed = false;
+    for (size_t nodes : {2, 4, 8, 16})
+        failed |= !cost(nodes);
+
+    const float gains[] = {0.0f, 0.1f, 0.3f, 1.0f, 3.0f, 10.0f};
+    std::printf("\nrelative error of the last node of a drive-response chain (x into x)\n");
+    std::printf("%5s %-10s", "nodes", "responses");
+    for (float gain : gains)
+        std::printf("   k = %-5g", gain);
+    std::printf("\n");
+    for (size_t nodes : {2, 4, 16}) {
+        for (float mismatch : {0.0f, MISMATCH}) {
+            std::printf("%5zu %-10s", nodes, mismatch == 0.0f ? "identical" : "mismatched");
+            for (float gain : gains) {
+                double error = chain_error(nodes, gain, mismatch);
+                if (std::isfinite(error))
+                    std::printf(" %11.2e", error);
+                else
+                    std::printf(" %11s", "diverged");
+                if (gain == CHECKED_GAIN)
+                    failed |= mismatch == 0.0f && !(error < SYNC_ERROR);
+            }
+            std::printf("\n");
+        }
+    }
+
+    std::printf("\n%s\n", failed ? "FAIL" : "ok");
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,140 @@
+/*
+ * Host tool: checks and benchmarks the CV conditioning chain (math/cic.hpp) with synthetic
+ * signals, using the same configuration as the firmware.
+ *
+ * Build (from Firmware/Projects/drone):
+ *   g++ -std=gnu++17 -O2 tools/cv_filter_check.cpp -o cv_filter_check
+ *
+ * Checks, with a non-zero exit status on failure:
+ *  - DC gain: a constant input comes out unchanged;
+ *  - noise: a constant input with white noise (ADC noise) settles and then stops changing;
+ *  - step: a full-scale step is tracked within the CIC delay;
+ *  - ramp: a slow ramp (knob turned) is tracked within the hysteresis plus the CIC delay.
+ * Then times the chain per acquired sample. Host timings only give an idea of the cost.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "../math/cic.hpp"
+
+// Keep in sync with drone.cpp
+constexpr uint32_t CONTROL_SAMPLE_RATE = 4000;
+constexpr size_t CV_FILTER_ORDER = 2;
+constexpr uint32_t CV_DECIMATION = 32;
+constexpr uint16_t CV_HYSTERESIS = 128;
+
+using Filter = math::CvFilter<CV_FILTER_ORDER, CV_DECIMATION>;
+
+static bool failed = false;
+
+static void report(const char *name, bool ok, const char *format, double value) {
+    failed |= !ok;
+    std::printf("%-10s ", name);
+    std::printf(format, value);
+    std::printf("  %s\n", ok ? "ok" : "FAIL");
+}
+
+static uint16_t quantize(double value) {
+    return static_cast<uint16_t>(std::clamp(std::lround(value), 0l, 65535l));
+}
+
+int main() {
+    std::mt19937 rng(1234);
+
+    // DC gain, over the whole range
+    {
+        int worst = 0;
+        for (uint32_t value = 0; value <= 65535; value += 257) {
+            math::CicDecimator<CV_FILTER_ORDER, CV_DECIMATION> cic;
+            for (uint32_t i = 0; i < 4 * CV_DECIMATION; i++)
+                cic.process(static_cast<uint16_t>(value));
+            worst = std::max(worst, std::abs(static_cast<int>(cic.get()) - static_cast<int>(value)));
+        }
+        report("dc", worst == 0, "max error %.0f LSB", worst);
+    }
+
+    // Noise: 200 LSB rms (about 12 effective bits), 10 s
+    {
+        std::normal_distribution<double> noise(0.0, 200.0);
+        Filter filter(CV_HYSTERESIS);
+        filter.reset(30000);
+        size_t changes = 0, late_changes = 0;
+        double raw_min = 65535, raw_max = 0, min = 65535, max = 0;
+        for (uint32_t i = 0; i < 10 * CONTROL_SAMPLE_RATE; i++) {
+            uint16_t raw = quantize(30000 + noise(rng));
+            raw_min = std::min<double>(raw_min, raw), raw_max = std::max<double>(raw_max, raw);
+            if (filter.process(raw)) {
+                changes++;
+                late_changes += i > CONTROL_SAMPLE_RATE;
+            }
+            min = std::min<double>(min, filter.get()), max = std::max<double>(max, filter.get());
+        }
+        std::printf("noise      input range %.0f LSB, output range %.0f LSB, %zu changes\n",
+                    raw_max - raw_min, max - min, changes);
+        report("noise", late_changes < 10, "%.0f changes after the first second", late_changes);
+    }
+
+    // Step from 0 to full scale
+    {
+        Filter filter(CV_HYSTERESIS);
+        filter.reset(0);
+        uint32_t settled = 0;
+        for (uint32_t i = 0; i < CONTROL_SAMPLE_RATE && !settled; i++) {
+            filter.process(65535);
+            if (filter.get() >= 65535 - CV_HYSTERESIS)
+                settled = i + 1;
+        }
+        // The CIC response ends ORDER * RATIO samples after the step, plus up to one output period
+        uint32_t bound = (CV_FILTER_ORDER + 1) * CV_DECIMATION;
+        std::printf("step       settled after %u samples (%.2f ms)\n", settled,
+                    1000.0 * settled / CONTROL_SAMPLE_RATE);
+        report("step", settled && settled <= bound, "bound %.0f samples", bound);
+    }
+
+    // Ramp over the full range in 2 s
+    {
+        Filter filter(CV_HYSTERESIS);
+        filter.reset(0);
+        const double slope = 65535.0 / (2 * CONTROL_SAMPLE_RATE);
+        double worst = 0;
+        for (uint32_t i = 0; i < 2 * CONTROL_SAMPLE_RATE; i++) {
+            double value = slope * i;
+            filter.process(quantize(value));
+            if (i > 2 * CV_DECIMATION)
+                worst = std::max(worst, std::fabs(filter.get() - value));
+        }
+        // Delay of the CIC and of the decimation, plus the hysteresis
+        double bound = slope * (math::CicDecimator<CV_FILTER_ORDER, CV_DECIMATION>::DELAY + 2 * CV_DECIMATION) + CV_HYSTERESIS;
+        std::printf("ramp       max tracking error %.0f LSB\n", worst);
+        report("ramp", worst <= bound, "bound %.0f LSB", bound);
+    }
+
+    // Cost per acquired sample
+    {
+        std::vector<uint16_t> input(1 << 20);
+        std::uniform_int_distribution<int> values(0, 65535);
+        for (auto &value : input)
+            value = static_cast<uint16_t>(values(rng));
+
+        Filter filter(CV_HYSTERESIS);
+        uint32_t changes = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (int rep = 0; rep < 20; rep++) {
+            for (uint16_t value : input)
+                changes += filter.process(value);
+        }
+        double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() -
+                                                              start)
+                        .count() /
+                    (20.0 * input.size());
+        std::printf("cost       %.2f ns per sample (%u changes)\n", ns, changes);
+    }
+
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,143 @@
+/*
+ * Host tool: throughput of the plot projections (display/projection.hpp) against the display
+ * budget of the firmware.
+ *
+ * Build (from Firmware/Projects/drone):
+ *   g++ -std=gnu++17 -O2 tools/display_bench.cpp math/models.cpp -o display_bench
+ *
+ * A Rossler trajectory, normalized to [-1, 1] as the firmware feeds the display, is projected
+ * onto the x/y plane and through the rotating 3D view, whose projection is rebuilt every frame.
+ * Reported: points per millisecond of each projection, the cost of the per-frame view update,
+ * and the share of the frame period (at DISPLAY_REFRESH_RATE) taken by a full trajectory buffer.
+ * The drawing of the segments, the phosphor decay and the I2C transfer are not covered.
+ * Exits with a non-zero status if a full buffer takes more than MAX_FRAME_SHARE of the frame, or
+ * if a NaN or infinite state is not rejected by the projections.
+ * Host timings only give an idea of the relative cost: measure on the target.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <vector>
+
+#include "../display/projection.hpp"
+#include "../math/models.hpp"
+
+using math::vec3f;
+
+// Keep in sync with drone.cpp and display/Display.hpp
+constexpr unsigned DISPLAY_REFRESH_RATE = 30;
+constexpr size_t TRAJECTORY_BUFFER_SIZE = 128;
+constexpr float VIEW_ROTATION_STEP = 0.02f;
+constexpr float VIEW_TILT = 1.0f;
+
+constexpr size_t POINTS = 1 << 16;
+constexpr size_t REPEATS = 200;
+constexpr double MAX_FRAME_SHARE = 0.01;
+
+/// @brief Normalized Rossler trajectory, as fed to the display
+static std::vector<vec3f> trajectory() {
+    // Bounds of the engine (engine/model_data.hpp)
+    const vec3f low{-9.104f, -10.789f, 0.013f}, high{11.431f, 7.839f, 22.838f};
+    math::DiscretizedModel<math::Rossler> model({}, math::DEFAULT_DT);
+    vec3f x{1.0f, 1.0f, 1.0f};
+    std::vector<vec3f> points(POINTS);
+    for (vec3f &p : points) {
+        for (size_t i = 0; i < 10; i++)
+            x = model.step(x);
+        for (size_t k = 0; k < 3; k++)
+            p[k] = 2.0f * (x[k] - low[k]) / (high[k] - low[k]) - 1.0f;
+    }
+    return points;
+}
+
+/// @brief ns per call of `f(point)` over the trajectory
+template <class F> static double ns_per_point(const std::vector<vec3f> &points, F &&f) {
+    int sink = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t r = 0; r < REPEATS; r++) {
+        for (const vec3f &p : points)
+            sink += f(p);
+    }
+    auto end = std::chrono::steady_clock::now();
+    volatile int keep = sink;
+    (void)keep;
+    return std::chrono::duration<double, std::nano>(end - start).count() / (REPEATS * POINTS);
+}
+
+int main() {
+    const std::vector<vec3f> points = trajectory();
+
+    // Normalized borders, as set by the firmware
+    plot_projection_t plane;
+    float scale = (PLOT_SIZE - 1) / 2.0f;
+    plane.sx = plane.sy = scale * (1 << PLOT_FRAC_BITS);
+    plane.ox = plane.oy = static_cast<int32_t>(plane.sx);
+
+    float c = cosf(VIEW_ROTATION_STEP), s = sinf(VIEW_ROTATION_STEP);
+    math::mat3f rotation = math::mat3f::identity(), rotation_step, tilt;
+    rotation_step[0] = vec3f{c, -s, 0.0f};
+    rotation_step[1] = vec3f{s, c, 0.0f};
+    rotation_step[2] = vec3f{0.0f, 0.0f, 1.0f};
+    c = cosf(VIEW_TILT);
+    s = sinf(VIEW_TILT);
+    tilt[0] = vec3f{1.0f, 0.0f, 0.0f};
+    tilt[1] = vec3f{0.0f, c, -s};
+    tilt[2] = vec3f{0.0f, s, c};
+    const vec3f center{0.0f, 0.0f, 0.0f};
+    const float view_scale = scale / sqrtf(3.0f) * (1 << PLOT_FRAC_BITS);
+    view_projection_t view = MakeViewProjection(rotation, tilt, center, view_scale);
+
+    double plane_ns = ns_per_point(points, [&](const vec3f &p) {
+        int x = 0, y = 0;
+        ProjectPlane(plane, p, x, y);
+        return x + y;
+    });
+    double view_ns = ns_per_point(points, [&](const vec3f &p) {
+        int x = 0, y = 0;
+        ProjectView(view, p, x, y);
+        return x + y;
+    });
+
+    // Per frame: one rotation step and a new projection
+    constexpr size_t FRAMES = 1000000;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < FRAMES; i++) {
+        rotation = rotation_step * rotation;
+        view = MakeViewProjection(rotation, tilt, center, view_scale);
+    }
+    auto end = std::chrono::steady_clock::now();
+    double update_ns = std::chrono::duration<double, std::nano>(end - start).count() / FRAMES;
+    volatile int32_t keep = view.ox;
+    (void)keep;
+
+    const double frame_ns = 1e9 / DISPLAY_REFRESH_RATE;
+    double worst_ns = std::max(plane_ns, view_ns) * TRAJECTORY_BUFFER_SIZE + update_ns;
+    double share = worst_ns / frame_ns;
+
+    std::printf("%-12s %10s %14s\n", "projection", "ns/point", "points/ms");
+    std::printf("%-12s %10.2f %14.0f\n", "x/y plane", plane_ns, 1e6 / plane_ns);
+    std::printf("%-12s %10.2f %14.0f\n", "3D view", view_ns, 1e6 / view_ns);
+    std::printf("view update: %.1f ns per frame\n", update_ns);
+    std::printf("full buffer (%zu points) + update: %.2f us, %.4f%% of the %.1f ms frame\n",
+                TRAJECTORY_BUFFER_SIZE, worst_ns / 1e3, 100.0 * share, frame_ns / 1e6);
+
+    // Diverged states must be rejected before the (undefined) conversion to fixed point
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    const float inf = std::numeric_limits<float>::infinity();
+    bool rejected = true;
+    for (const vec3f &p : {vec3f{nan, 0.0f, 0.0f}, vec3f{0.0f, inf, 0.0f},
+                           vec3f{0.0f, 0.0f, -inf}}) {
+        int x = -1, y = -1;
+        rejected &= !ProjectView(view, p, x, y) && x == -1 && y == -1;
+        // The plane ignores z
+        rejected &= !ProjectPlane(plane, p, x, y) == (p.z() == 0.0f);
+    }
+    std::printf("non-finite states rejected: %s\n", rejected ? "ok" : "FAIL");
+
+    bool ok = share < MAX_FRAME_SHARE && rejected;
+    std::printf("\n%s\n", ok ? "ok" : "FAIL");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,114 @@
+/*
+ * Host tool: replays synthetic quadrature waveforms through the encoder decoder
+ * (hardware/quadrature.hpp), sampled at the firmware control rate.
+ *
+ * Build (from Firmware/Projects/drone):
+ *   g++ -std=gnu++17 -O2 tools/encoder_check.cpp -o encoder_check
+ *
+ * For each turn rate, the encoder is turned a whole number of detents in each direction, with
+ * and without contact bounce (the changing line reads random levels for a while after each
+ * edge), and the decoded detents are compared with the expected ones. Exits with a non-zero
+ * status if steps are missed at rates the sampling is specified for. Then shows how many
+ * detents the acceleration needs to sweep the parameter range at each rate.
+ */
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+#include "../hardware/quadrature.hpp"
+
+// Keep in sync with drone.cpp
+constexpr uint32_t CONTROL_SAMPLE_RATE = 4000;
+constexpr EncoderAcceleration ENCODER_ACCELERATION{CONTROL_SAMPLE_RATE * 60 / 1000,
+                                                   CONTROL_SAMPLE_RATE * 6 / 1000, 32};
+constexpr int32_t STEP = 1024 / 32; // PARAM_RESOLUTION / ROTARY_ENCODER_RESOLUTION
+constexpr int32_t RANGE = 65535;
+
+/// Levels of (A, B) over one cycle, clockwise, starting at rest
+constexpr uint8_t CYCLE[4] = {0b11, 0b01, 0b00, 0b10};
+
+/// Turn rates the sampling must decode without loss, in detents per second: four transitions
+/// per detent, each held for more than two samples
+constexpr double MAX_SPECIFIED_RATE = CONTROL_SAMPLE_RATE / 8.0;
+
+struct Result {
+    int32_t detents = 0;
+    int32_t steps = 0;
+    uint32_t invalid = 0;
+};
+
+/**
+ * @brief Turns the encoder `detents` detents (negative: counterclockwise) at `rate` detents per
+ * second, from rest, and decodes it.
+ * @param bounce time after each edge during which the changing line bounces, in seconds
+ */
+static Result turn(int32_t detents, double rate, double bounce, std::mt19937 &rng,
+                   const EncoderAcceleration &acceleration = {1, 1, 1}) {
+    EncoderCounter counter(acceleration);
+    std::bernoulli_distribution coin(0.5);
+    // Random phase between the start of the turn and the sampling clock
+    double offset = std::uniform_real_distribution<double>(0.0, 1.0)(rng) / CONTROL_SAMPLE_RATE;
+
+    const int32_t direction = detents < 0 ? -1 : 1;
+    const int64_t quarters = 4 * static_cast<int64_t>(std::abs(detents));
+    const double quarter_time = 1.0 / (4.0 * rate);
+    // Rest a little at the end, for the last bounces
+    const double duration = quarters * quarter_time + bounce + 0.01;
+
+    Result result;
+    for (uint32_t tick = 0; tick * (1.0 / CONTROL_SAMPLE_RATE) < duration; tick++) {
+        double t = tick * (1.0 / CONTROL_SAMPLE_RATE) + offset;
+        // Edge q happens at q * quarter_time, q = 1..quarters
+        int64_t q = std::min<int64_t>(static_cast<int64_t>(std::floor(t / quarter_time)), quarters);
+        uint8_t state = CYCLE[(direction * q) & 3];
+
+        if (q > 0 && t - q * quarter_time < bounce) {
+            uint8_t changed = state ^ CYCLE[(direction * (q - 1)) & 3];
+            if (coin(rng))
+                state ^= changed;
+        }
+
+        bool a = state >> 1 & 1, b = state & 1;
+        counter.process(a, b, tick);
+    }
+
+    result.steps = counter.read_increment();
+    result.detents = result.steps; // without acceleration, one step per detent
+    result.invalid = counter.get_invalid();
+    return result;
+}
+
+int main() {
+    std::mt19937 rng(42);
+    bool failed = false;
+
+    std::printf("decoding, 200 detents each way, sampled at %u Hz\n", CONTROL_SAMPLE_RATE);
+    std::printf("%12s %10s %14s %10s %14s %10s\n", "detents/s", "bounce", "clockwise",
+                "invalid", "counterclock.", "invalid");
+    for (double rate : {5.0, 50.0, 200.0, 400.0, 500.0, 800.0, 1000.0, 1500.0}) {
+        for (double bounce : {0.0, 0.2e-3}) {
+            Result cw = turn(200, rate, bounce, rng);
+            Result ccw = turn(-200, rate, bounce, rng);
+            bool ok = cw.detents == 200 && ccw.detents == -200;
+            bool specified = rate <= MAX_SPECIFIED_RATE && bounce * 4 * rate < 0.5;
+            if (specified && !ok)
+                failed = true;
+            std::printf("%12.0f %8.1fms %14d %10u %14d %10u  %s\n", rate, bounce * 1e3, cw.detents,
+                        cw.invalid, ccw.detents, ccw.invalid,
+                        ok ? "ok" : (specified ? "FAIL" : "(beyond spec)"));
+        }
+    }
+
+    std::printf("\nacceleration: steps of %d per detent, range %d\n", STEP, RANGE);
+    std::printf("%12s %14s %20s\n", "detents/s", "steps/detent", "detents for range");
+    for (double rate : {5.0, 15.0, 30.0, 60.0, 100.0, 170.0, 300.0}) {
+        Result r = turn(100, rate, 0.0, rng, ENCODER_ACCELERATION);
+        double per_detent = r.steps / 100.0;
+        std::printf("%12.0f %14.2f %20.0f\n", rate, per_detent,
+                    std::ceil(RANGE / (per_detent * STEP)));
+    }
+
+    return failed ? 1 : 0;
+}
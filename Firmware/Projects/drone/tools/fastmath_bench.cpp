@@ -0,0 +1,102 @@
+/*
+ * Host tool: accuracy check and benchmark of math/fastmath.hpp against libm.
+ *
+ * Build (from Firmware/Projects/drone):
+ *   g++ -std=gnu++17 -O2 tools/fastmath_bench.cpp math/models.cpp -o fastmath_bench
+ *
+ * Prints the measured error of every approximation next to its documented bound and exits with
+ * a non-zero status if a bound is exceeded, then times each function against its libm
+ * counterpart, and the Chua diode as a clamp against its two-abs formulation (both cost about the
+ * same on the host). Host timings only give an idea of the relative cost: measure on the target.
+ */
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "../math/fastmath.hpp"
+#include "../math/models.hpp"
+
+namespace fast = math::fast;
+
+static bool failed = false;
+
+static void report(const char *name, double error, double bound) {
+    bool ok = error <= bound;
+    failed |= !ok;
+    std::printf("%-28s error %.3e  bound %.1e  %s\n", name, error, bound, ok ? "ok" : "FAIL");
+}
+
+template <class F> static double time_ns(const std::vector<float> &inputs, F &&f) {
+    volatile float sink = 0.0f;
+    float acc = 0.0f;
+    auto start = std::chrono::steady_clock::now();
+    for (int rep = 0; rep < 20; rep++) {
+        for (float x : inputs)
+            acc += f(x);
+    }
+    auto end = std::chrono::steady_clock::now();
+    sink = acc;
+    (void)sink;
+    return std::chrono::duration<double, std::nano>(end - start).count() / (20.0 * inputs.size());
+}
+
+int main() {
+    // -- Accuracy --
+    double sin_err = 0.0, cos_err = 0.0;
+    for (double x = -1000.0; x <= 1000.0; x += 1e-3) {
+        float s, c;
+        fast::sincos(static_cast<float>(x), s, c);
+        double xf = static_cast<float>(x);
+        sin_err = std::fmax(sin_err, std::fabs(s - std::sin(xf)));
+        cos_err = std::fmax(cos_err, std::fabs(c - std::cos(xf)));
+    }
+    report("sincos: sin, |x| < 1000", sin_err, 1.2e-7);
+    report("sincos: cos, |x| < 1000", cos_err, 1.2e-7);
+
+    double rsqrt_err = 0.0;
+    for (double x = 1e-30; x < 1e30; x *= 1.0001) {
+        float xf = static_cast<float>(x);
+        double exact = 1.0 / std::sqrt(static_cast<double>(xf));
+        rsqrt_err = std::fmax(rsqrt_err, std::fabs(fast::rsqrt(xf) - exact) / exact);
+    }
+    report("rsqrt (relative)", rsqrt_err, 4.8e-6);
+
+    // Chua diode through clamp vs the original two-abs formulation
+    math::Chua chua;
+    double diode_err = 0.0;
+    for (float x = -5.0f; x <= 5.0f; x += 1e-4f) {
+        float reference = chua.m1 * x + 0.5f * (chua.m0 - chua.m1) * (std::fabs(x + 1) - std::fabs(x - 1));
+        diode_err = std::fmax(diode_err, std::fabs(chua.chua_diode(x) - reference));
+    }
+    report("Chua diode (absolute)", diode_err, 1e-6);
+
+    // -- Speed --
+    std::vector<float> angles, positives;
+    for (int i = 0; i < 100000; i++) {
+        angles.push_back(-20.0f + 40.0f * i / 100000);
+        positives.push_back(1e-3f + 100.0f * i / 100000);
+    }
+
+    std::printf("\n%-12s %10s %10s\n", "function", "libm ns", "fast ns");
+    std::printf("%-12s %10.2f %10.2f\n", "sin", time_ns(angles, [](float x) { return sinf(x); }),
+                time_ns(angles, [](float x) { return fast::sin(x); }));
+    std::printf("%-12s %10.2f %10.2f\n", "sincos",
+                time_ns(angles, [](float x) { return sinf(x) + cosf(x); }),
+                time_ns(angles, [](float x) {
+                    float s, c;
+                    fast::sincos(x, s, c);
+                    return s + c;
+                }));
+    std::printf("%-12s %10.2f %10.2f\n", "rsqrt",
+                time_ns(positives, [](float x) { return 1.0f / sqrtf(x); }),
+                time_ns(positives, [](float x) { return fast::rsqrt(x); }));
+    std::printf("%-12s %10.2f %10.2f\n", "chua_diode",
+                time_ns(angles, [&](float x) {
+                    return chua.m1 * x + 0.5f * (chua.m0 - chua.m1) * (fabsf(x + 1) - fabsf(x - 1));
+                }),
+                time_ns(angles, [&](float x) { return chua.chua_diode(x); }));
+
+    return failed ? 1 : 0;
+}
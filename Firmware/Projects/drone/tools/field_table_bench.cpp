@@ -0,0 +1,204 @@
+/*
+ * Host tool: accuracy and cost of tabulated vector fields (math/field_table.hpp) against the
+ * exact ones, for each grid size.
+ *
+ * Build (from Firmware/Projects/drone):
+ *   g++ -std=gnu++17 -O2 tools/field_table_bench.cpp engine/khaos_engine.cpp math/models.cpp \
+ *       -o field_table_bench
+ *
+ * For every continuous model (default parameters, RK4 at the default dt), the table covers the
+ * model's MODEL_BOUNDS widened by a quarter on each side, and the trajectory starts from its
+ * first seed. The Ikeda map, a 2D discrete model, is tabulated the same way with a bilinear
+ * table of the map itself. Columns:
+ *  - memory of the table, and host time to build it;
+ *  - field error: RMS error of the tabulated field along the exact trajectory, relative to the
+ *    RMS of the field;
+ *  - shadow: steps until the tabulated trajectory drifts away from the exact one by 1 % of the
+ *    box (both are chaotic, so they always separate eventually);
+ *  - extent error: largest difference between the extents of the two trajectories over
+ *    STEPS steps, relative to the exact extent: whether the tabulated attractor keeps its shape;
+ *  - ns per step (or map iteration), exact and tabulated.
+ * A trilinear table reproduces fields which are linear in each coordinate (Rossler, Lorentz) up to
+ * rounding, at any grid size; the cheap polynomial fields of the engine cost less to evaluate
+ * than a lookup, so tabulating them only pays off for more expensive fields (see Ikeda).
+ * Host timings only give an idea of the relative cost: measure on the target, where the tables
+ * compete for the caches.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <memory>
+
+#include "../engine/khaos_engine.hpp"
+#include "../math/field_table.hpp"
+#include "../math/models.hpp"
+
+using math::vec2f;
+using math::vec3f;
+
+constexpr size_t STEPS = 200000;
+constexpr size_t TIMED_STEPS = 2000000;
+
+template <class State> static float norm(const State &v) { return std::sqrt(math::dot(v, v)); }
+
+/// Extents of a trajectory
+template <class State> struct Extent {
+    State min, max;
+
+    explicit Extent(const State &x) : min(x), max(x) {}
+
+    void add(const State &x) {
+        for (size_t k = 0; k < State::size(); k++) {
+            min[k] = std::min(min[k], x[k]);
+            max[k] = std::max(max[k], x[k]);
+        }
+    }
+
+    /// Largest relative difference of the extents along an axis
+    float error(const Extent &exact) const {
+        float error = 0.0f;
+        for (size_t k = 0; k < State::size(); k++) {
+            float range = exact.max[k] - exact.min[k];
+            error = std::max({error, std::fabs(max[k] - exact.max[k]) / range,
+                              std::fabs(min[k] - exact.min[k]) / range});
+        }
+        return error;
+    }
+};
+
+/// ns per call of `step`, iterated from `x`
+template <class State, class F> static double time_ns(State x, F &&step) {
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < TIMED_STEPS; i++)
+        x = step(x);
+    auto end = std::chrono::steady_clock::now();
+    volatile float sink = x[0];
+    (void)sink;
+    return std::chrono::duration<double, std::nano>(end - start).count() / TIMED_STEPS;
+}
+
+static void print_header(const char *name) {
+    std::printf("\n%s\n%6s %10s %9s %11s %9s %8s %9s %9s\n", name, "grid", "memory", "build",
+                "field err", "shadow", "extent", "exact ns", "table ns");
+}
+
+static void print_row(size_t n, size_t bytes, double build_ms, double field_error, size_t shadow,
+                      float extent_error, double exact_ns, double table_ns) {
+    std::printf("%6zu %7.1f KiB %6.2f ms %11.2e %9zu %7.2f%% %9.1f %9.1f\n", n, bytes / 1024.0,
+                build_ms, field_error, shadow, 100.0f * extent_error, exact_ns, table_ns);
+}
+
+/// Runs the exact and tabulated versions of a continuous model side by side
+template <class M, size_t N> static void bench_continuous(const ModelBounds &bounds, vec3f seed) {
+    vec3f margin = 0.25f * (bounds.max - bounds.min);
+    auto tabulated = std::make_unique<math::TabulatedModel<M, N>>(bounds.min - margin,
+                                                                  bounds.max + margin);
+    auto start = std::chrono::steady_clock::now();
+    tabulated->update();
+    auto end = std::chrono::steady_clock::now();
+    double build_ms = std::chrono::duration<double, std::milli>(end - start).count();
+
+    // Same parameters; the calls through `tabulated` are virtual, and would reach its table
+    const M exact;
+    const math::rk4_coeffs<float> coeffs(math::DEFAULT_DT);
+    const float tolerance = 0.01f * norm(vec3f(bounds.max - bounds.min));
+
+    vec3f x = seed, y = seed;
+    Extent<vec3f> exact_extent(x), table_extent(y);
+    double error_sq = 0.0, field_sq = 0.0;
+    size_t shadow = 0;
+    bool shadowing = true;
+    for (size_t i = 0; i < STEPS; i++) {
+        vec3f field = exact.gradient(x);
+        vec3f error = tabulated->gradient(x) - field;
+        error_sq += math::dot(error, error);
+        field_sq += math::dot(field, field);
+
+        x = exact.rk4_step(x, coeffs);
+        y = tabulated->rk4_step(y, coeffs);
+        exact_extent.add(x);
+        table_extent.add(y);
+        shadowing &= norm(vec3f(x - y)) < tolerance;
+        shadow += shadowing;
+    }
+
+    double exact_ns = time_ns(seed, [&](vec3f s) { return exact.rk4_step(s, coeffs); });
+    double table_ns = time_ns(seed, [&](vec3f s) { return tabulated->rk4_step(s, coeffs); });
+    print_row(N, sizeof(typename math::TabulatedModel<M, N>::Table), build_ms,
+              std::sqrt(error_sq / field_sq), shadow, table_extent.error(exact_extent), exact_ns,
+              table_ns);
+}
+
+template <class M> static void bench_model(const char *name, KhaosModelData::SelectedModel model) {
+    print_header(name);
+    const ModelBounds &bounds = MODEL_BOUNDS[model];
+    vec3f seed = math::model_seeds(M{})[0];
+    bench_continuous<M, 8>(bounds, seed);
+    bench_continuous<M, 16>(bounds, seed);
+    bench_continuous<M, 32>(bounds, seed);
+    bench_continuous<M, 64>(bounds, seed);
+}
+
+/// Bilinear table of the Ikeda map over the box of its attractor
+template <size_t N> static void bench_ikeda(const math::Ikeda &ikeda, vec2f min, vec2f max) {
+    using Table = math::FieldTable<vec2f, N>;
+    vec2f margin = 0.25f * (max - min);
+    auto table = std::make_unique<Table>(min - margin, max + margin);
+    auto start = std::chrono::steady_clock::now();
+    table->build([&](vec2f x) { return ikeda.step(x); });
+    auto end = std::chrono::steady_clock::now();
+    double build_ms = std::chrono::duration<double, std::milli>(end - start).count();
+
+    auto tabulated = [&](vec2f x) { return table->contains(x) ? (*table)(x) : ikeda.step(x); };
+    const float tolerance = 0.01f * norm(vec2f(max - min));
+
+    vec2f x{0.1f, 0.1f}, y = x;
+    Extent<vec2f> exact_extent(x), table_extent(y);
+    double error_sq = 0.0, map_sq = 0.0;
+    size_t shadow = 0;
+    bool shadowing = true;
+    for (size_t i = 0; i < STEPS; i++) {
+        vec2f next = ikeda.step(x);
+        vec2f error = tabulated(x) - next;
+        error_sq += math::dot(error, error);
+        map_sq += math::dot(next, next);
+
+        x = next;
+        y = tabulated(y);
+        exact_extent.add(x);
+        table_extent.add(y);
+        shadowing &= norm(vec2f(x - y)) < tolerance;
+        shadow += shadowing;
+    }
+
+    double exact_ns = time_ns(vec2f{0.1f, 0.1f}, [&](vec2f s) { return ikeda.step(s); });
+    double table_ns = time_ns(vec2f{0.1f, 0.1f}, tabulated);
+    print_row(N, sizeof(Table), build_ms, std::sqrt(error_sq / map_sq), shadow,
+              table_extent.error(exact_extent), exact_ns, table_ns);
+}
+
+int main() {
+    bench_model<math::Chua>("Chua", KhaosModelData::CHUA);
+    bench_model<math::Sprott>("Sprott", KhaosModelData::SPROTT);
+    bench_model<math::Rossler>("Rossler", KhaosModelData::ROSSLER);
+    bench_model<math::Halvorsen>("Halvorsen", KhaosModelData::HALVORSEN);
+    bench_model<math::Lorentz>("Lorentz", KhaosModelData::LORENTZ);
+
+    // The box of the Ikeda attractor, past its transient
+    math::Ikeda ikeda;
+    vec2f x{0.1f, 0.1f};
+    for (size_t i = 0; i < 1000; i++)
+        x = ikeda.step(x);
+    Extent<vec2f> extent(x);
+    for (size_t i = 0; i < STEPS; i++) {
+        x = ikeda.step(x);
+        extent.add(x);
+    }
+    print_header("Ikeda (map, bilinear)");
+    bench_ikeda<64>(ikeda, extent.min, extent.max);
+    bench_ikeda<256>(ikeda, extent.min, extent.max);
+    bench_ikeda<1024>(ikeda, extent.min, extent.max);
+    return 0;
+}
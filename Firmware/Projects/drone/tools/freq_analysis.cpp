@@ -0,0 +1,108 @@
+/*
+ * Host tool: spectral characterization of the chaotic oscillators.
+ * C++ counterpart of Simulation/FreqAnalysis, for long renders without MATLAB.
+ *
+ * Build (from Firmware/Projects/drone):
+ *   g++ -std=gnu++17 -O2 -pthread tools/freq_analysis.cpp math/models.cpp -o freq_analysis
+ *
+ * Usage:
+ *   ./freq_analysis [seconds] [sampling_frequency]
+ *
+ * Every model is rendered for every frequency multiplier in a worker pool; the x output is fed
+ * block by block to a Welch analyzer and the dominant frequency, spectral centroid and bandwidth
+ * are printed, one line per job.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../math/chaos_osc.hpp"
+#include "../math/spectrum.hpp"
+
+constexpr size_t BLOCK_SIZE = 256;
+constexpr size_t FRAME_SIZE = 8192;
+/// @brief Initial transient discarded before analysis, in seconds
+constexpr float WARMUP_SECONDS = 1.0f;
+
+const float FREQ_MULTIPLIERS[] = {100.0f, 200.0f, 400.0f, 800.0f, 1600.0f};
+
+struct Job {
+    std::string model;
+    float freq_multiplier;
+    std::function<math::SpectrumStats(float, float, float)> run;
+    math::SpectrumStats result;
+};
+
+template <class M>
+math::SpectrumStats analyze(M model, math::vec3f seed, float sampling_frequency,
+                            float freq_multiplier, float seconds) {
+    // Keep every output sample a single integration step
+    float max_dt = std::max(math::DEFAULT_DT, freq_multiplier / sampling_frequency);
+    ChaosOsc<M> osc(model, seed, sampling_frequency, freq_multiplier, max_dt);
+    math::WelchAnalyzer<FRAME_SIZE> analyzer(sampling_frequency);
+
+    auto warmup = static_cast<size_t>(WARMUP_SECONDS * sampling_frequency);
+    for (size_t i = 0; i < warmup; i++)
+        osc.step();
+
+    auto blocks = static_cast<size_t>(seconds * sampling_frequency) / BLOCK_SIZE;
+    float block[BLOCK_SIZE];
+    for (size_t b = 0; b < blocks; b++) {
+        for (size_t i = 0; i < BLOCK_SIZE; i++)
+            block[i] = osc.step()[0];
+        analyzer.push(block, BLOCK_SIZE);
+    }
+
+    return analyzer.stats();
+}
+
+template <class M> void add_jobs(std::vector<Job> &jobs, const char *name, math::vec3f seed) {
+    for (float multiplier : FREQ_MULTIPLIERS) {
+        jobs.push_back({name, multiplier,
+                        [seed](float fs, float fm, float seconds) {
+                            return analyze(M{}, seed, fs, fm, seconds);
+                        },
+                        {}});
+    }
+}
+
+int main(int argc, char **argv) {
+    float seconds = argc > 1 ? std::strtof(argv[1], nullptr) : 60.0f;
+    float sampling_frequency = argc > 2 ? std::strtof(argv[2], nullptr) : 48000.0f;
+
+    std::vector<Job> jobs;
+    add_jobs<math::Chua>(jobs, "Chua", {-0.1761f, -0.1046f, -1.1139f});
+    add_jobs<math::Sprott>(jobs, "Sprott", {0.7169f, 0.2679f, -0.8065f});
+    add_jobs<math::Rossler>(jobs, "Rossler", {10.4794f, -1.0197f, 8.6062f});
+    add_jobs<math::Halvorsen>(jobs, "Halvorsen", {-4.5143f, -7.2574f, 5.7629f});
+    add_jobs<math::Lorentz>(jobs, "Lorentz", {1.0f, 1.0f, 1.0f});
+
+    std::atomic<size_t> next_job{0};
+    auto worker = [&]() {
+        for (size_t j; (j = next_job.fetch_add(1)) < jobs.size();)
+            jobs[j].result = jobs[j].run(sampling_frequency, jobs[j].freq_multiplier, seconds);
+    };
+
+    size_t num_workers = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<std::thread> workers;
+    for (size_t i = 0; i < num_workers; i++)
+        workers.emplace_back(worker);
+    for (auto &w : workers)
+        w.join();
+
+    std::printf("%-10s %8s %12s %12s %12s %7s\n", "model", "mult", "dominant Hz", "centroid Hz",
+                "bandwidth Hz", "frames");
+    for (const auto &job : jobs) {
+        std::printf("%-10s %8.1f %12.2f %12.2f %12.2f %7zu\n", job.model.c_str(),
+                    job.freq_multiplier, job.result.dominant, job.result.centroid,
+                    job.result.bandwidth, job.result.frames);
+    }
+
+    return 0;
+}
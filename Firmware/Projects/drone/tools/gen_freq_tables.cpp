@@ -0,0 +1,214 @@
+/*
+ * Host tool: generates math/freq_tables.hpp, the intrinsic-frequency tables of the models.
+ *
+ * Build and run (from Firmware/Projects/drone):
+ *   g++ -std=gnu++17 -O2 -pthread tools/gen_freq_tables.cpp math/models.cpp -o gen_freq_tables
+ *   ./gen_freq_tables > math/freq_tables.hpp
+ *
+ * For each table entry the model is integrated with the firmware step (RK4, dt = DEFAULT_DT)
+ * from each seed the engine uses at that parameter (math/seed_tables.hpp), and its mean angular
+ * frequency is taken as the Welch spectral peak of one state component, refined by parabolic
+ * interpolation. This is the frequency heard as the pitch of the output. Entries are computed in
+ * parallel.
+ *
+ * The models go through periodic windows, and some have coexisting attractors, so the raw
+ * measurements jump between neighbours. Each entry takes the median over its seeds, then the
+ * table is smoothed by a running median over MEDIAN_WIDTH entries, which drops isolated windows,
+ * and a [1 2 1] / 4 filter: pitch tracking follows the trend of the model rather than every
+ * window. The largest step between neighbours is printed on stderr.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "../math/models.hpp"
+#include "../math/seed_tables.hpp"
+#include "../math/spectrum.hpp"
+
+constexpr size_t TABLE_SIZE = 33;
+constexpr size_t BLOCK_SIZE = 256;
+constexpr size_t FRAME_SIZE = 16384;
+constexpr float WARMUP_TIME = 200.0f;
+constexpr float MEASURE_TIME = 20000.0f;
+constexpr size_t MEDIAN_WIDTH = 5;
+
+struct TableSpec {
+    const char *model;      // class name in math::
+    const char *param;      // tracked parameter
+    const char *name;       // table name
+    float param_min, param_max;
+    size_t component;       // state component whose spectral peak is measured
+    std::function<float(float, size_t)> measure;
+    std::vector<float> omega;
+};
+
+template <class M>
+float mean_angular_frequency(M model, math::vec3f state, size_t component) {
+    math::DiscretizedModel<M> discrete(model, math::DEFAULT_DT);
+
+    auto warmup = static_cast<size_t>(WARMUP_TIME / math::DEFAULT_DT);
+    auto blocks = static_cast<size_t>(MEASURE_TIME / math::DEFAULT_DT) / BLOCK_SIZE;
+
+    for (size_t i = 0; i < warmup; i++)
+        state = discrete.step(state);
+
+    // Sampled once per step: frequencies are in cycles per unit of model time
+    auto analyzer = std::make_unique<math::WelchAnalyzer<FRAME_SIZE>>(1.0f / math::DEFAULT_DT);
+    float block[BLOCK_SIZE];
+    for (size_t b = 0; b < blocks; b++) {
+        for (size_t i = 0; i < BLOCK_SIZE; i++) {
+            state = discrete.step(state);
+            block[i] = state[component];
+        }
+        analyzer->push(block, BLOCK_SIZE);
+    }
+
+    if (!std::isfinite(state[component]) || analyzer->stats().centroid <= 0.0f)
+        return NAN;
+
+    size_t peak = 1;
+    for (size_t k = 2; k + 1 < analyzer->BINS; k++) {
+        if (analyzer->bin_power(k) > analyzer->bin_power(peak))
+            peak = k;
+    }
+
+    // Parabolic interpolation of the log-power around the peak
+    float offset = 0.0f;
+    if (peak > 1) {
+        float a = std::log(analyzer->bin_power(peak - 1) + 1e-30f);
+        float b = std::log(analyzer->bin_power(peak) + 1e-30f);
+        float c = std::log(analyzer->bin_power(peak + 1) + 1e-30f);
+        float den = a - 2.0f * b + c;
+        if (den < 0.0f)
+            offset = 0.5f * (a - c) / den;
+    }
+
+    constexpr float TWO_PI = 6.28318530718f;
+    return TWO_PI * analyzer->bin_frequency(1) * (static_cast<float>(peak) + offset);
+}
+
+/// @brief Median of the finite values, NaN if there are none
+static float median(std::vector<float> values) {
+    values.erase(std::remove_if(values.begin(), values.end(),
+                                [](float v) { return !std::isfinite(v); }),
+                 values.end());
+    if (values.empty())
+        return NAN;
+    std::sort(values.begin(), values.end());
+    size_t n = values.size();
+    return n % 2 ? values[n / 2] : 0.5f * (values[n / 2 - 1] + values[n / 2]);
+}
+
+template <class M, class Set>
+TableSpec table(const char *model, const char *param, const char *name, float param_min,
+                float param_max, size_t component, Set set) {
+    return {model, param, name, param_min, param_max, component,
+            [=](float value, size_t c) {
+                M m;
+                set(m, value);
+                const math::vec3f *seeds = math::model_seeds(m);
+                std::vector<float> omega;
+                for (size_t i = 0; i < math::SeedTable::SEEDS_PER_CELL; i++)
+                    omega.push_back(mean_angular_frequency(m, seeds[i], c));
+                return median(omega);
+            },
+            std::vector<float>(TABLE_SIZE)};
+}
+
+/// @brief Running median over MEDIAN_WIDTH entries, then [1 2 1] / 4; windows shrink towards the
+/// ends, which are kept, so that a steep trend is not flattened there. Non-chaotic entries
+/// (collapsed or diverged) take the closest measured value first.
+static std::vector<float> smooth(std::vector<float> omega) {
+    size_t n = omega.size();
+    std::vector<float> measured = omega;
+    for (size_t i = 0; i < n; i++) {
+        for (size_t d = 1; !std::isfinite(omega[i]) && d < n; d++) {
+            if (i >= d && std::isfinite(measured[i - d]))
+                omega[i] = measured[i - d];
+            else if (i + d < n && std::isfinite(measured[i + d]))
+                omega[i] = measured[i + d];
+        }
+    }
+
+    std::vector<float> med(n), res(n);
+    for (size_t i = 0; i < n; i++) {
+        size_t half = std::min({MEDIAN_WIDTH / 2, i, n - 1 - i});
+        med[i] = median(std::vector<float>(omega.begin() + (i - half),
+                                           omega.begin() + (i + half + 1)));
+    }
+    res.front() = med.front();
+    res.back() = med.back();
+    for (size_t i = 1; i + 1 < n; i++)
+        res[i] = 0.25f * (med[i - 1] + 2.0f * med[i] + med[i + 1]);
+    return res;
+}
+
+int main() {
+    std::vector<TableSpec> tables;
+    tables.push_back(table<math::Chua>("Chua", "alpha", "CHUA", 15.0f, 19.0f, 1,
+                                       [](math::Chua &m, float v) { m.alpha = v; }));
+    tables.push_back(table<math::Sprott>("Sprott", "a", "SPROTT", 1.8f, 2.4f, 2,
+                                         [](math::Sprott &m, float v) { m.a = v; }));
+    tables.push_back(table<math::Rossler>("Rossler", "c", "ROSSLER", 4.0f, 12.0f, 0,
+                                          [](math::Rossler &m, float v) { m.c = v; }));
+    tables.push_back(table<math::Halvorsen>("Halvorsen", "a", "HALVORSEN", 1.3f, 2.1f, 0,
+                                            [](math::Halvorsen &m, float v) { m.a = v; }));
+    tables.push_back(table<math::Lorentz>("Lorentz", "rho", "LORENTZ", 25.0f, 60.0f, 2,
+                                          [](math::Lorentz &m, float v) { m.rho = v; }));
+
+    std::atomic<size_t> next_entry{0};
+    size_t num_entries = tables.size() * TABLE_SIZE;
+    auto worker = [&]() {
+        for (size_t e; (e = next_entry.fetch_add(1)) < num_entries;) {
+            TableSpec &t = tables[e / TABLE_SIZE];
+            size_t i = e % TABLE_SIZE;
+            float value = t.param_min + (t.param_max - t.param_min) * i / (TABLE_SIZE - 1);
+            t.omega[i] = t.measure(value, t.component);
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (size_t i = 0; i < std::max(1u, std::thread::hardware_concurrency()); i++)
+        workers.emplace_back(worker);
+    for (auto &w : workers)
+        w.join();
+
+    std::printf("#pragma once\n\n"
+                "// Generated by tools/gen_freq_tables.cpp, do not edit.\n\n"
+                "#include \"freq_table.hpp\"\n"
+                "#include \"models.hpp\"\n\n"
+                "namespace math {\n");
+
+    for (const auto &t : tables) {
+        std::vector<float> omega = smooth(t.omega);
+        float max_step = 0.0f;
+        for (size_t i = 0; i + 1 < TABLE_SIZE; i++)
+            max_step = std::max(max_step, std::fabs(omega[i + 1] / omega[i] - 1.0f));
+        std::fprintf(stderr, "%-10s largest step between neighbours: %.1f %%\n", t.model,
+                     100.0f * max_step);
+
+        std::printf("\n/// Mean angular frequency of %s vs %s in [%g, %g], smoothed\n", t.model,
+                    t.param, t.param_min, t.param_max);
+        std::printf("inline constexpr float %s_OMEGA[] = {", t.name);
+        for (size_t i = 0; i < TABLE_SIZE; i++) {
+            std::printf("%s%.4ff", i % 8 ? " " : "\n    ", omega[i]);
+            if (i + 1 < TABLE_SIZE)
+                std::printf(",");
+        }
+        std::printf("\n};\n");
+        std::printf("inline constexpr FreqTable %s_FREQ_TABLE{%.4ff, %.4ff, %s_OMEGA, %zu};\n",
+                    t.name, t.param_min, t.param_max, t.name, TABLE_SIZE);
+        std::printf("inline float intrinsic_omega(const %s &m) {\n"
+                    "    return %s_FREQ_TABLE.lookup(m.%s);\n}\n",
+                    t.model, t.name, t.param);
+    }
+
+    std::printf("\n} // namespace math\n");
+    return 0;
+}
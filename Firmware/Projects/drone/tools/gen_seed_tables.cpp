@@ -0,0 +1,265 @@
+/*
+ * Host tool: generates math/seed_tables.hpp, the verified initial states of the models.
+ *
+ * Build and run (from Firmware/Projects/drone):
+ *   g++ -std=gnu++17 -O2 -pthread tools/gen_seed_tables.cpp math/models.cpp -o gen_seed_tables
+ *   ./gen_seed_tables > math/seed_tables.hpp
+ *
+ * The range of one parameter of each model is divided in cells. In each cell, SAMPLES initial
+ * states drawn uniformly in the model's MODEL_BOUNDS, widened by half on each side, are
+ * integrated with the firmware step (RK4, dt = DEFAULT_DT) at the center of the cell, and each
+ * is classified as:
+ *  - diverged: non-finite, or escaped the sphere of the watchdog (engine/khaos_engine.hpp);
+ *  - fixed point: still, by the measure of the watchdog, at the end of the transient;
+ *  - attractor: still moving within the sphere.
+ * The end states of the trajectories reaching an attractor are the candidate seeds. A candidate
+ * is kept if the model, started from it, also stays on an attractor at both ends of the cell.
+ * Cells without enough verified seeds take those of the closest cell which has some, and are
+ * marked as not verified, so that the engine does not keep reseeding them. The basin
+ * fractions of each cell are written as comments, and a summary is printed on stderr.
+ * Cells are computed in parallel; the draws are seeded per cell, so the output is reproducible.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "../engine/model_data.hpp"
+#include "../math/models.hpp"
+#include "../math/seed_table.hpp"
+
+using math::vec3f;
+
+constexpr size_t CELLS = 16;
+constexpr size_t SAMPLES = 256;
+constexpr size_t SEEDS = math::SeedTable::SEEDS_PER_CELL;
+/// Model time integrated before classifying, and over which a state must keep moving
+constexpr float TRANSIENT_TIME = 200.0f;
+constexpr float CHECK_TIME = 50.0f;
+/// Model time between two motion checks, about one block of the firmware at nominal rate
+constexpr float CHECK_INTERVAL = 0.5f;
+
+enum class Outcome { ATTRACTOR, DIVERGED, FIXED_POINT };
+
+/// Escape and stillness criteria of the watchdog, for one model
+struct Criteria {
+    vec3f center;
+    float escape_radius_sq, min_motion_sq;
+};
+
+static Criteria criteria(const ModelBounds &bounds) {
+    vec3f half_diagonal = (bounds.max - bounds.min) / 2.0f;
+    float size_sq = math::dot(half_diagonal, half_diagonal);
+    return {(bounds.max + bounds.min) / 2.0f,
+            WATCHDOG_ESCAPE_FACTOR * WATCHDOG_ESCAPE_FACTOR * size_sq,
+            WATCHDOG_MIN_MOTION * WATCHDOG_MIN_MOTION * size_sq};
+}
+
+/// @brief Integrates `state` for the transient and the check time, and classifies the end state.
+template <class M> static Outcome classify(const M &model, const Criteria &c, vec3f &state) {
+    math::DiscretizedModel<M> discrete(model, math::DEFAULT_DT);
+    const auto steps_per_check = static_cast<size_t>(CHECK_INTERVAL / math::DEFAULT_DT);
+    const auto transient_checks = static_cast<size_t>(TRANSIENT_TIME / CHECK_INTERVAL);
+    const auto checks = transient_checks + static_cast<size_t>(CHECK_TIME / CHECK_INTERVAL);
+
+    // The watchdog reseeds after WATCHDOG_COLLAPSE_BLOCKS still checks in a row
+    uint32_t still = 0;
+    vec3f last = state;
+    for (size_t check = 0; check < checks; check++) {
+        for (size_t i = 0; i < steps_per_check; i++)
+            state = discrete.step(state);
+
+        vec3f offset = state - c.center;
+        float radius_sq = math::dot(offset, offset);
+        if (!std::isfinite(radius_sq) || radius_sq > c.escape_radius_sq)
+            return Outcome::DIVERGED;
+
+        vec3f motion = state - last;
+        last = state;
+        still = math::dot(motion, motion) < c.min_motion_sq ? still + 1 : 0;
+        if (check >= transient_checks && still >= WATCHDOG_COLLAPSE_BLOCKS)
+            return Outcome::FIXED_POINT;
+    }
+    return still == 0 ? Outcome::ATTRACTOR : Outcome::FIXED_POINT;
+}
+
+struct Cell {
+    float param_min, param_max;
+    size_t attractor = 0, diverged = 0, fixed_point = 0;
+    std::vector<vec3f> seeds;
+    /// Cell whose seeds are used, if this one has too few
+    size_t source;
+};
+
+struct TableSpec {
+    const char *model;      // class name in math::
+    const char *param;      // parameter of the grid
+    const char *name;       // table name
+    float param_min, param_max;
+    std::function<void(Cell &, size_t)> compute;
+    std::vector<Cell> cells;
+};
+
+template <class M, class Set>
+TableSpec table(const char *model, const char *param, const char *name, float param_min,
+                float param_max, KhaosModelData::SelectedModel selected, Set set) {
+    auto compute = [=](Cell &cell, size_t index) {
+        const ModelBounds &bounds = MODEL_BOUNDS[selected];
+        const Criteria c = criteria(bounds);
+        M low, center, high;
+        set(low, cell.param_min);
+        set(center, (cell.param_min + cell.param_max) / 2.0f);
+        set(high, cell.param_max);
+
+        std::mt19937 rng(static_cast<uint32_t>(1000 * selected + index));
+        vec3f margin = (bounds.max - bounds.min) / 2.0f;
+        std::array<std::uniform_real_distribution<float>, 3> draw;
+        for (size_t k = 0; k < 3; k++)
+            draw[k] = std::uniform_real_distribution<float>(bounds.min[k] - margin[k],
+                                                            bounds.max[k] + margin[k]);
+
+        for (size_t s = 0; s < SAMPLES; s++) {
+            vec3f state{draw[0](rng), draw[1](rng), draw[2](rng)};
+            switch (classify(center, c, state)) {
+            case Outcome::DIVERGED:
+                cell.diverged++;
+                continue;
+            case Outcome::FIXED_POINT:
+                cell.fixed_point++;
+                continue;
+            case Outcome::ATTRACTOR:
+                cell.attractor++;
+                break;
+            }
+            if (cell.seeds.size() == SEEDS)
+                continue;
+
+            // The seed must hold across the cell
+            vec3f at_low = state, at_high = state;
+            if (classify(low, c, at_low) == Outcome::ATTRACTOR &&
+                classify(high, c, at_high) == Outcome::ATTRACTOR) {
+                cell.seeds.push_back(state);
+            }
+        }
+    };
+
+    std::vector<Cell> cells(CELLS);
+    for (size_t i = 0; i < CELLS; i++) {
+        cells[i].param_min = param_min + (param_max - param_min) * i / CELLS;
+        cells[i].param_max = param_min + (param_max - param_min) * (i + 1) / CELLS;
+        cells[i].source = i;
+    }
+    return {model, param, name, param_min, param_max, compute, cells};
+}
+
+static int percent(size_t count) { return static_cast<int>(std::lround(100.0 * count / SAMPLES)); }
+
+int main() {
+    // Same parameters and ranges as the frequency tables, widened to include the defaults
+    std::vector<TableSpec> tables;
+    tables.push_back(table<math::Chua>("Chua", "alpha", "CHUA", 15.0f, 19.0f, KhaosModelData::CHUA,
+                                       [](math::Chua &m, float v) { m.alpha = v; }));
+    tables.push_back(table<math::Sprott>("Sprott", "a", "SPROTT", 1.8f, 2.4f,
+                                         KhaosModelData::SPROTT,
+                                         [](math::Sprott &m, float v) { m.a = v; }));
+    tables.push_back(table<math::Rossler>("Rossler", "c", "ROSSLER", 4.0f, 12.0f,
+                                          KhaosModelData::ROSSLER,
+                                          [](math::Rossler &m, float v) { m.c = v; }));
+    tables.push_back(table<math::Halvorsen>("Halvorsen", "a", "HALVORSEN", 1.3f, 2.1f,
+                                            KhaosModelData::HALVORSEN,
+                                            [](math::Halvorsen &m, float v) { m.a = v; }));
+    tables.push_back(table<math::Lorentz>("Lorentz", "rho", "LORENTZ", 25.0f, 60.0f,
+                                          KhaosModelData::LORENTZ,
+                                          [](math::Lorentz &m, float v) { m.rho = v; }));
+
+    std::atomic<size_t> next_cell{0};
+    size_t num_cells = tables.size() * CELLS;
+    auto worker = [&]() {
+        for (size_t e; (e = next_cell.fetch_add(1)) < num_cells;) {
+            TableSpec &t = tables[e / CELLS];
+            t.compute(t.cells[e % CELLS], e % CELLS);
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (size_t i = 0; i < std::max(1u, std::thread::hardware_concurrency()); i++)
+        workers.emplace_back(worker);
+    for (auto &w : workers)
+        w.join();
+
+    std::printf("#pragma once\n\n"
+                "// Generated by tools/gen_seed_tables.cpp, do not edit.\n\n"
+                "#include \"models.hpp\"\n"
+                "#include \"seed_table.hpp\"\n\n"
+                "namespace math {\n");
+
+    for (auto &t : tables) {
+        // Cells with too few seeds take those of the closest complete cell
+        size_t complete = 0, attractor = 0, diverged = 0, fixed_point = 0;
+        for (size_t i = 0; i < CELLS; i++) {
+            complete += t.cells[i].seeds.size() == SEEDS;
+            attractor += t.cells[i].attractor;
+            diverged += t.cells[i].diverged;
+            fixed_point += t.cells[i].fixed_point;
+            for (size_t d = 1; t.cells[t.cells[i].source].seeds.size() < SEEDS && d < CELLS; d++) {
+                if (i >= d && t.cells[i - d].seeds.size() == SEEDS)
+                    t.cells[i].source = i - d;
+                else if (i + d < CELLS && t.cells[i + d].seeds.size() == SEEDS)
+                    t.cells[i].source = i + d;
+            }
+        }
+        std::fprintf(stderr, "%-10s %2zu/%zu cells verified; basins: %5.1f%% attractor, %5.1f%% "
+                     "diverged, %5.1f%% fixed point\n", t.model, complete, CELLS,
+                     100.0 * attractor / (CELLS * SAMPLES), 100.0 * diverged / (CELLS * SAMPLES),
+                     100.0 * fixed_point / (CELLS * SAMPLES));
+        if (complete == 0) {
+            std::fprintf(stderr, "%s: no seed found\n", t.model);
+            return 1;
+        }
+
+        std::printf("\n/// Seeds of %s vs %s in [%g, %g]\n", t.model, t.param, t.param_min,
+                    t.param_max);
+        std::printf("inline constexpr vec3f %s_SEEDS[][SeedTable::SEEDS_PER_CELL] = {\n", t.name);
+        for (size_t i = 0; i < CELLS; i++) {
+            const Cell &cell = t.cells[i];
+            std::printf("    // %s in [%.4g, %.4g]: %d%% attractor, %d%% diverged, "
+                        "%d%% fixed point",
+                        t.param, cell.param_min, cell.param_max, percent(cell.attractor),
+                        percent(cell.diverged), percent(cell.fixed_point));
+            if (cell.source != i)
+                std::printf("; seeds of [%.4g, %.4g]", t.cells[cell.source].param_min,
+                            t.cells[cell.source].param_max);
+            std::printf("\n    {");
+            const std::vector<vec3f> &seeds = t.cells[cell.source].seeds;
+            for (size_t s = 0; s < SEEDS; s++) {
+                std::printf("%s{%.4ff, %.4ff, %.4ff}", s ? ",\n     " : "", seeds[s].x(),
+                            seeds[s].y(), seeds[s].z());
+            }
+            std::printf("},\n");
+        }
+        std::printf("};\n");
+        std::printf("inline constexpr bool %s_VERIFIED[] = {", t.name);
+        for (size_t i = 0; i < CELLS; i++) {
+            std::printf("%s%s", i % 8 ? ", " : (i ? ",\n    " : "\n    "),
+                        t.cells[i].source == i ? "true" : "false");
+        }
+        std::printf("};\n");
+        std::printf("inline constexpr SeedTable %s_SEED_TABLE{%.4ff, %.4ff, %s_SEEDS,\n"
+                    "    %s_VERIFIED, %zu};\n",
+                    t.name, t.param_min, t.param_max, t.name, t.name, CELLS);
+        std::printf("inline const vec3f *model_seeds(const %s &m) {\n"
+                    "    return %s_SEED_TABLE.lookup(m.%s);\n}\n",
+                    t.model, t.name, t.param);
+        std::printf("inline bool model_seeds_verified(const %s &m) {\n"
+                    "    return %s_SEED_TABLE.is_verified(m.%s);\n}\n",
+                    t.model, t.name, t.param);
+    }
+
+    std::printf("\n} // namespace math\n");
+    return 0;
+}
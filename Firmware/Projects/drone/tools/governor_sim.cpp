@@ -0,0 +1,157 @@
+/*
+ * Host tool: runs the output engine with the quality governor (engine/governor.hpp) against a
+ * synthetic cycle-cost model, through a sweep of time scales and model switches.
+ *
+ * Build (from Firmware/Projects/drone):
+ *   g++ -std=gnu++17 -O2 tools/governor_sim.cpp engine/khaos_engine.cpp math/models.cpp \
+ *       -o governor_sim
+ *
+ * The cost of a block is computed from the integration steps of each model (cycles per RK4
+ * step of a Cortex-M7 estimate), plus a fixed overhead per sample and per block. The engine
+ * renders at an audio rate, where high frequency multipliers need many steps per sample; the
+ * budget is half of the block period at 480 MHz.
+ *
+ * Prints the cost of the blocks relative to the budget with and without the governor, and checks
+ * that with the governor no block exceeds the budget nor the worst-case bound of its levels, and
+ * that every model is back to the nominal quality once the load is gone. Exits with a non-zero
+ * status if a check fails.
+ */
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "../engine/khaos_engine.hpp"
+
+constexpr KhaosEngineConfig CONFIG{48000, 128, 2048, 128, 512};
+constexpr uint32_t CPU_FREQUENCY = 480000000;
+constexpr uint32_t BUDGET =
+    static_cast<uint32_t>(uint64_t(CPU_FREQUENCY) * CONFIG.block_size / CONFIG.sample_rate / 2);
+
+/// Synthetic costs, in cycles
+constexpr uint32_t RK4_STEP_COST = 300;
+constexpr uint32_t SAMPLE_COST = 60;
+constexpr uint32_t BLOCK_COST = 2000;
+
+constexpr size_t NUM_MODELS = KhaosModelData::NUM_MODELS;
+
+/// @brief Cost of the last block rendered by `engine`.
+static uint32_t block_cost(const KhaosEngine &engine) {
+    uint64_t cost = BLOCK_COST + uint64_t(SAMPLE_COST) * CONFIG.block_size;
+    for (size_t i = 0; i < NUM_MODELS; i++) {
+        cost += uint64_t(engine.get_block_steps()[i]) * RK4_STEP_COST;
+    }
+    return static_cast<uint32_t>(cost);
+}
+
+/// @brief Highest cost of a block at the current levels: two models crossfading, or one model
+/// and a preroll, each taking the most steps their level allows.
+static uint32_t worst_case(const KhaosEngine &engine) {
+    uint64_t sample_steps[2] = {0, 0};
+    for (size_t i = 0; i < NUM_MODELS; i++) {
+        const QualityLevel &quality = QUALITY_LEVELS[engine.get_quality_level(i)];
+        uint64_t cost = uint64_t(quality.max_steps_per_sample) * RK4_STEP_COST;
+        if (cost > sample_steps[0]) {
+            sample_steps[1] = sample_steps[0];
+            sample_steps[0] = cost;
+        } else if (cost > sample_steps[1]) {
+            sample_steps[1] = cost;
+        }
+    }
+    uint64_t samples = CONFIG.block_size;
+    uint64_t crossfade = samples * (sample_steps[0] + sample_steps[1]);
+    uint64_t preroll =
+        samples * sample_steps[0] + uint64_t(CONFIG.preroll_steps_per_block) * RK4_STEP_COST;
+    return static_cast<uint32_t>(BLOCK_COST + SAMPLE_COST * samples +
+                                 std::max(crossfade, preroll));
+}
+
+struct Result {
+    size_t blocks = 0, over_budget = 0, over_bound = 0;
+    double max_load = 0.0, mean_load = 0.0;
+    std::array<size_t, QUALITY_LEVELS.size()> level_blocks{};
+    bool recovered = true;
+};
+
+/// Frequency multiplier at each block: up from 500 to 40000 (1 to 83 nominal steps per sample),
+/// held, back down, then idle
+static float multiplier(size_t block, size_t ramp) {
+    constexpr float LOW = 500.0f, HIGH = 40000.0f;
+    if (block < ramp)
+        return LOW * std::pow(HIGH / LOW, static_cast<float>(block) / ramp);
+    if (block < 2 * ramp)
+        return HIGH;
+    if (block < 3 * ramp)
+        return HIGH * std::pow(LOW / HIGH, static_cast<float>(block - 2 * ramp) / ramp);
+    return LOW;
+}
+
+static Result run(bool governed) {
+    constexpr size_t RAMP = 2000, BLOCKS = 4 * RAMP;
+    constexpr size_t SWITCH_PERIOD = 300;
+
+    KhaosEngine engine(CONFIG);
+    if (governed)
+        engine.set_governor({BUDGET, 0.8f, 0.3f, 16});
+
+    KhaosModelData data;
+    std::vector<math::vec3f> block(CONFIG.block_size);
+    Result result;
+
+    for (size_t n = 0; n < BLOCKS; n++) {
+        for (size_t i = 0; i < NUM_MODELS; i++)
+            engine.set_frequency_multiplier(i, multiplier(n, RAMP));
+        if (n % SWITCH_PERIOD == SWITCH_PERIOD - 1) {
+            data.selected = static_cast<KhaosModelData::SelectedModel>((data.selected + 1) %
+                                                                       NUM_MODELS);
+            engine.set_model_data(data);
+        }
+
+        uint32_t bound = worst_case(engine);
+        engine.render(block.data(), block.size());
+        uint32_t cost = block_cost(engine);
+        engine.govern(cost);
+
+        double load = static_cast<double>(cost) / BUDGET;
+        result.blocks++;
+        result.over_budget += cost > BUDGET;
+        result.over_bound += cost > bound;
+        result.max_load = std::max(result.max_load, load);
+        result.mean_load += load / BLOCKS;
+        result.level_blocks[engine.get_quality_level(data.selected)]++;
+    }
+
+    for (size_t i = 0; i < NUM_MODELS; i++)
+        result.recovered &= engine.get_quality_level(i) == 0;
+    return result;
+}
+
+static void print(const char *label, const Result &result) {
+    std::printf("%-12s %7zu %8zu %9zu %9.2f %9.2f", label, result.blocks, result.over_budget,
+                result.over_bound, result.max_load, result.mean_load);
+    for (size_t count : result.level_blocks)
+        std::printf(" %7zu", count);
+    std::printf("\n");
+}
+
+int main() {
+    std::printf("budget %u cycles per block of %u samples at %u Hz\n\n", BUDGET, CONFIG.block_size,
+                CONFIG.sample_rate);
+    std::printf("%-12s %7s %8s %9s %9s %9s", "", "blocks", "overrun", "> bound", "max load",
+                "mean load");
+    for (size_t i = 0; i < QUALITY_LEVELS.size(); i++)
+        std::printf(" level %zu", i);
+    std::printf("\n");
+
+    Result ungoverned = run(false);
+    Result governed = run(true);
+    print("ungoverned", ungoverned);
+    print("governed", governed);
+
+    bool ok = governed.over_budget == 0 && governed.over_bound == 0 && governed.recovered;
+    std::printf("\n%s\n",
+                ok ? "ok" : "FAIL: block over budget or over its bound, or quality not recovered");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,149 @@
+/*
+ * Host tool: Jacobian-vector products of the model fields through dual numbers (math::jvp)
+ * against forward and central finite differences of `gradient()`.
+ *
+ * Build (from Firmware/Projects/drone):
+ *   g++ -std=gnu++17 -O2 -fno-tree-slp-vectorize tools/jvp_bench.cpp math/models.cpp -o jvp_bench
+ *
+ * For each of the five models of the engine, at its default parameters, J(x) v is computed in
+ * float at states along the attractor, for random unit directions v:
+ *  - dual: one evaluation of the field on dual<float>;
+ *  - forward differences: (f(x + h v) - f(x)) / h, h = FORWARD_H |x|, near the optimal step
+ *    sqrt(eps) for float, two evaluations of the gradient;
+ *  - central differences: (f(x + h v) - f(x - h v)) / 2h, h = CENTRAL_H |x|, near the optimal
+ *    step cbrt(eps), two evaluations of the gradient.
+ * The error is the largest distance to a reference computed on dual<double>, relative to the
+ * RMS of |J v| over the samples; the cost is in ns per product. For Chua, the differences are
+ * worst where the step straddles a corner of the piecewise-linear diode.
+ * Exits with a non-zero status if the dual product is not more accurate than both differences,
+ * or if its error exceeds MAX_DUAL_ERROR. Host timings only give an idea of the relative cost:
+ * measure on the target.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "../math/dual.hpp"
+#include "../math/models.hpp"
+#include "../math/seed_tables.hpp"
+
+using math::vec3f;
+using vec3d = math::vec<3, double>;
+
+constexpr size_t SAMPLES = 4096;
+constexpr size_t TIMED_REPEATS = 200;
+constexpr float FORWARD_H = 3e-4f;
+constexpr float CENTRAL_H = 5e-3f;
+constexpr double MAX_DUAL_ERROR = 1e-5;
+
+struct Sample {
+    vec3f x, v;
+};
+
+/// @brief States along the attractor, after a transient, with random unit directions
+template <class M> static std::vector<Sample> samples(const M &model) {
+    const math::rk4_coeffs<float> coeffs(math::DEFAULT_DT);
+    vec3f x = math::model_seeds(model)[0];
+    for (size_t i = 0; i < 10000; i++)
+        x = model.rk4_step(x, coeffs);
+
+    std::mt19937 rng(1);
+    std::normal_distribution<float> normal;
+    std::vector<Sample> res(SAMPLES);
+    for (Sample &s : res) {
+        for (size_t i = 0; i < 10; i++)
+            x = model.rk4_step(x, coeffs);
+        vec3f v{normal(rng), normal(rng), normal(rng)};
+        s = {x, v / std::sqrt(math::dot(v, v))};
+    }
+    return res;
+}
+
+/// @brief Step of the finite differences, relative to the magnitude of the state
+static float step(vec3f x, float h) {
+    return h * std::max(1.0f, std::sqrt(math::dot(x, x)));
+}
+
+template <class M> static vec3f forward(const M &model, const Sample &s) {
+    float h = step(s.x, FORWARD_H);
+    return (model.gradient(s.x + h * s.v) - model.gradient(s.x)) / h;
+}
+
+template <class M> static vec3f central(const M &model, const Sample &s) {
+    float h = step(s.x, CENTRAL_H);
+    return (model.gradient(s.x + h * s.v) - model.gradient(s.x - h * s.v)) / (2.0f * h);
+}
+
+template <class M> static vec3f dual(const M &model, const Sample &s) {
+    return math::jvp(model, s.x, s.v);
+}
+
+/// @brief Largest distance to the references, relative to their RMS
+template <class F>
+static double error(const std::vector<Sample> &s, const std::vector<vec3d> &reference, F &&jvp) {
+    double worst = 0.0, sum_sq = 0.0;
+    for (size_t i = 0; i < s.size(); i++) {
+        vec3f r = jvp(s[i]);
+        vec3d d = vec3d{r.x(), r.y(), r.z()} - reference[i];
+        worst = std::max(worst, math::dot(d, d));
+        sum_sq += math::dot(reference[i], reference[i]);
+    }
+    return std::sqrt(worst / (sum_sq / s.size()));
+}
+
+template <class F> static double ns_per_product(const std::vector<Sample> &s, F &&jvp) {
+    vec3f sum{0.0f, 0.0f, 0.0f};
+    auto start = std::chrono::steady_clock::now();
+    for (size_t r = 0; r < TIMED_REPEATS; r++) {
+        for (const Sample &sample : s)
+            sum = sum + jvp(sample);
+    }
+    auto end = std::chrono::steady_clock::now();
+    volatile float sink = sum.x() + sum.y() + sum.z();
+    (void)sink;
+    return std::chrono::duration<double, std::nano>(end - start).count() /
+           (TIMED_REPEATS * s.size());
+}
+
+template <class M> static bool compare(const char *name) {
+    const M model;
+    const std::vector<Sample> s = samples(model);
+
+    std::vector<vec3d> reference(s.size());
+    for (size_t i = 0; i < s.size(); i++) {
+        vec3d x{s[i].x.x(), s[i].x.y(), s[i].x.z()}, v{s[i].v.x(), s[i].v.y(), s[i].v.z()};
+        reference[i] = math::jvp(model, x, v);
+    }
+
+    auto d = [&](const Sample &sample) { return dual(model, sample); };
+    auto fd = [&](const Sample &sample) { return forward(model, sample); };
+    auto cd = [&](const Sample &sample) { return central(model, sample); };
+    double dual_error = error(s, reference, d);
+    double forward_error = error(s, reference, fd);
+    double central_error = error(s, reference, cd);
+
+    bool ok = dual_error < MAX_DUAL_ERROR && dual_error < forward_error &&
+              dual_error < central_error;
+    std::printf("%-10s %10.2e %10.2e %10.2e %8.1f %8.1f %8.1f  %s\n", name, dual_error,
+                forward_error, central_error, ns_per_product(s, d), ns_per_product(s, fd),
+                ns_per_product(s, cd), ok ? "ok" : "FAIL");
+    return ok;
+}
+
+int main() {
+    std::printf("%-10s %32s %26s\n", "", "relative error", "ns per product");
+    std::printf("%-10s %10s %10s %10s %8s %8s %8s\n", "model", "dual", "forward", "central",
+                "dual", "forward", "central");
+    bool ok = compare<math::Chua>("Chua");
+    ok = compare<math::Sprott>("Sprott") && ok;
+    ok = compare<math::Rossler>("Rossler") && ok;
+    ok = compare<math::Halvorsen>("Halvorsen") && ok;
+    ok = compare<math::Lorentz>("Lorentz") && ok;
+
+    std::printf("\n%s\n", ok ? "ok" : "FAIL");
+    return ok ? 0 : 1;
+}
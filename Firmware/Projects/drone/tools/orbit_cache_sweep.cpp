@@ -0,0 +1,125 @@
+/*
+ * Host tool: integration cost saved by the periodic-orbit cache (math/orbit_cache.hpp) across a
+ * sweep of the Rossler parameter c, through the period-doubling cascade into chaos.
+ *
+ * Build (from Firmware/Projects/drone):
+ *   g++ -std=gnu++17 -O2 tools/orbit_cache_sweep.cpp engine/khaos_engine.cpp math/models.cpp \
+ *       -o orbit_cache_sweep
+ *
+ * For each value of c, the engine renders ten minutes at the firmware sample rate, next to a
+ * plain oscillator integrating the same trajectory. Prints the integration steps saved, when the
+ * orbit was cached and its period, and the largest difference between the cached playback and
+ * the integrated trajectory over the 20 periods after caching, in normalized output units (it
+ * grows with the phase drift of the period estimate). Exits with a non-zero status if an orbit
+ * which fits in the history is not cached, or not with its period (within MAX_PERIOD_ERROR
+ * samples), or if a chaotic regime is cached.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "../engine/khaos_engine.hpp"
+
+// Keep in sync with drone.cpp
+constexpr KhaosEngineConfig CONFIG{100, 128, 2048, 128, 512};
+constexpr size_t SECONDS = 600;
+constexpr size_t COMPARED_PERIODS = 20;
+constexpr float MAX_PERIOD_ERROR = 1.0f;
+
+struct SweepResult {
+    uint64_t cached_steps = 0, integrated_steps = 0;
+    /// First sample played from the cache, or 0
+    size_t cached_at = 0;
+    float period = 0.0f;
+    float max_error = 0.0f;
+};
+
+static SweepResult run(float c) {
+    constexpr size_t MODEL = KhaosModelData::ROSSLER;
+
+    KhaosEngine engine(CONFIG);
+    KhaosModelData data;
+    data.rossler.c = c;
+    data.touch(KhaosModelData::ROSSLER);
+    engine.set_model_data(data);
+
+    // Same integration as the engine's oscillator, without the cache
+    math::Rossler model;
+    static_cast<math::RosslerParams &>(model) = data.rossler;
+    ChaosOsc<math::Rossler> reference(model, math::model_seeds(math::Rossler{})[0],
+                                      static_cast<float>(CONFIG.sample_rate), 1.0f);
+    const ModelBounds &bounds = MODEL_BOUNDS[MODEL];
+
+    SweepResult result;
+    std::vector<math::vec3f> block(CONFIG.block_size);
+    const size_t total = SECONDS * CONFIG.sample_rate;
+
+    for (size_t n = 0; n < total; n += block.size()) {
+        engine.render(block.data(), block.size());
+        result.cached_steps += engine.get_block_steps()[MODEL];
+
+        float period = engine.get_orbit_period(MODEL);
+        if (period > 0.0f && result.cached_at == 0) {
+            result.cached_at = n + block.size();
+            result.period = period;
+        }
+
+        for (size_t i = 0; i < block.size(); i++) {
+            math::vec3f state = reference.step();
+            result.integrated_steps += reference.get_last_steps();
+
+            size_t sample = n + i;
+            if (result.cached_at == 0 || sample < result.cached_at ||
+                sample >= result.cached_at + COMPARED_PERIODS * result.period) {
+                continue;
+            }
+            for (size_t k = 0; k < 3; k++) {
+                float center = (bounds.max[k] + bounds.min[k]) / 2.0f;
+                float expected = (state[k] - center) * 2.0f / (bounds.max[k] - bounds.min[k]);
+                result.max_error = std::max(result.max_error, std::fabs(block[i][k] - expected));
+            }
+        }
+        reference.check_health();
+    }
+    return result;
+}
+
+int main() {
+    // Period 1, 2, 4, then chaotic bands (Rossler with a = b = 0.2), with the period of the
+    // orbit in samples, 0 if it should not be cached. The period-4 orbit (about 2300 samples)
+    // does not fit in the history
+    struct Point {
+        float c;
+        float period;
+    };
+    constexpr Point SWEEP[] = {{2.5f, 574.9f}, {3.0f, 1153.1f}, {3.5f, 1154.5f}, {4.0f, 0.0f},
+                               {4.2f, 0.0f},   {4.8f, 0.0f},    {5.7f, 0.0f},    {6.5f, 0.0f}};
+
+    std::printf("%6s %12s %12s %8s %10s %10s %10s\n", "c", "steps", "cached", "saved", "cached at",
+                "period", "max error");
+
+    bool ok = true;
+    uint64_t total_cached = 0, total_integrated = 0;
+    for (const Point &point : SWEEP) {
+        SweepResult result = run(point.c);
+        total_cached += result.cached_steps;
+        total_integrated += result.integrated_steps;
+
+        double saved = 100.0 - 100.0 * result.cached_steps / result.integrated_steps;
+        std::printf("%6.2f %12llu %12llu %7.1f%% %9.1fs %10.1f %10.2e\n", point.c,
+                    static_cast<unsigned long long>(result.integrated_steps),
+                    static_cast<unsigned long long>(result.cached_steps), saved,
+                    static_cast<double>(result.cached_at) / CONFIG.sample_rate, result.period,
+                    result.max_error);
+        ok &= std::fabs(result.period - point.period) < MAX_PERIOD_ERROR;
+    }
+
+    std::printf("\nsweep: %.1f%% of the integration steps saved\n",
+                100.0 - 100.0 * total_cached / total_integrated);
+    std::printf("%s\n", ok ? "ok"
+                            : "FAIL: periodic orbit not cached or at the wrong period, or chaotic "
+                              "regime cached");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,129 @@
+/*
+ * Host tool: size and latency of the model data exchanged between main and the output callback,
+ * whole model objects vs parameter snapshots with generation counters (see KhaosModelData).
+ *
+ * Build (from Firmware/Projects/drone):
+ *   g++ -std=gnu++17 -O2 tools/param_snapshot_bench.cpp math/models.cpp -o param_snapshot_bench
+ *
+ * Latency is measured on the callback side (swap and apply), with a single model changed per
+ * publish, as when a knob is turned. Sizes are those of the host, where vtable pointers take
+ * 8 bytes instead of 4; host timings only give an idea of the relative cost.
+ */
+
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <type_traits>
+
+#include "../math/chaos_osc.hpp"
+#include "../math/models.hpp"
+#include "../sync/TriBuf.hpp"
+
+enum Model { CHUA = 0, SPROTT, ROSSLER, HALVORSEN, LORENTZ, NUM_MODELS };
+
+/// Previous layout: whole models, applied unconditionally
+struct FullModelData {
+    Model selected = ROSSLER;
+    math::Chua chua;
+    math::Sprott sprott;
+    math::Rossler rossler;
+    math::Halvorsen halvorsen;
+    math::Lorentz lorentz;
+};
+
+/// Current layout: parameter snapshots, applied when their generation changed
+struct SnapshotModelData {
+    Model selected = ROSSLER;
+    std::array<uint32_t, NUM_MODELS> generation{};
+    math::ChuaParams chua;
+    math::SprottParams sprott;
+    math::RosslerParams rossler;
+    math::HalvorsenParams halvorsen;
+    math::LorentzParams lorentz;
+};
+
+static_assert(std::is_trivially_copyable<SnapshotModelData>::value, "");
+
+struct Oscillators {
+    ChaosOsc<math::Chua> chua{{}, {0.1f, 0.0f, 0.0f}, 48000.0f, 1.0f};
+    ChaosOsc<math::Sprott> sprott{{}, {0.1f, 0.0f, 0.0f}, 48000.0f, 1.0f};
+    ChaosOsc<math::Rossler> rossler{{}, {0.1f, 0.0f, 0.0f}, 48000.0f, 1.0f};
+    ChaosOsc<math::Halvorsen> halvorsen{{}, {0.1f, 0.0f, 0.0f}, 48000.0f, 1.0f};
+    ChaosOsc<math::Lorentz> lorentz{{}, {0.1f, 0.0f, 0.0f}, 48000.0f, 1.0f};
+    std::array<uint32_t, NUM_MODELS> generation{};
+
+    void apply(const FullModelData &data) {
+        chua.set_model(data.chua);
+        sprott.set_model(data.sprott);
+        rossler.set_model(data.rossler);
+        halvorsen.set_model(data.halvorsen);
+        lorentz.set_model(data.lorentz);
+    }
+
+    void apply(const SnapshotModelData &data) {
+        auto changed = [&](Model model) {
+            bool result = data.generation[model] != generation[model];
+            generation[model] = data.generation[model];
+            return result;
+        };
+
+        if (changed(CHUA))
+            chua.set_params(data.chua);
+        if (changed(SPROTT))
+            sprott.set_params(data.sprott);
+        if (changed(ROSSLER))
+            rossler.set_params(data.rossler);
+        if (changed(HALVORSEN))
+            halvorsen.set_params(data.halvorsen);
+        if (changed(LORENTZ))
+            lorentz.set_params(data.lorentz);
+    }
+};
+
+constexpr int ITERATIONS = 1000000;
+
+/// @brief Average cost of one swap and apply in the output callback, with the writer publishing
+/// a change to one model before each of them.
+template <class Data, class Change> double apply_ns(Change &&change) {
+    static TriBuf<Data> buf;
+    auto writer = buf.get_writer();
+    auto reader = buf.get_reader();
+    Data data;
+    Oscillators oscillators;
+    std::chrono::steady_clock::duration elapsed{};
+
+    for (int i = 0; i < ITERATIONS; i++) {
+        change(data, i);
+        writer.data() = data;
+        writer.swap();
+
+        auto start = std::chrono::steady_clock::now();
+        if (reader.try_swap())
+            oscillators.apply(reader.data());
+        elapsed += std::chrono::steady_clock::now() - start;
+    }
+
+    if (oscillators.rossler.get_model().c != data.rossler.c)
+        std::printf("error: last change not applied\n");
+    return std::chrono::duration<double, std::nano>(elapsed).count() / ITERATIONS;
+}
+
+int main() {
+    std::printf("%-22s %10s %14s\n", "layout", "bytes", "TriBuf bytes");
+    std::printf("%-22s %10zu %14zu\n", "whole models", sizeof(FullModelData),
+                sizeof(TriBuf<FullModelData>));
+    std::printf("%-22s %10zu %14zu\n", "parameter snapshots", sizeof(SnapshotModelData),
+                sizeof(TriBuf<SnapshotModelData>));
+
+    double full = apply_ns<FullModelData>(
+        [](FullModelData &data, int i) { data.rossler.c = 4.0f + (i % 100) * 0.05f; });
+    double snapshot = apply_ns<SnapshotModelData>([](SnapshotModelData &data, int i) {
+        data.rossler.c = 4.0f + (i % 100) * 0.05f;
+        data.generation[ROSSLER]++;
+    });
+
+    std::printf("\nswap + apply in the callback, one model changed:\n");
+    std::printf("%-22s %8.2f ns\n", "whole models", full);
+    std::printf("%-22s %8.2f ns\n", "parameter snapshots", snapshot);
+    return 0;
+}
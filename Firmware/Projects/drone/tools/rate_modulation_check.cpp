@@ -0,0 +1,94 @@
+/*
+ * Host tool: checks the ChaosOsc stepping scheduler against a fine-step reference, with and
+ * without per-sample modulation of the time step (chaotic FM, see Simulation/VCV/Chaotic_FM.vcv).
+ *
+ * Build (from Firmware/Projects/drone):
+ *   g++ -std=gnu++17 -O2 tools/rate_modulation_check.cpp math/models.cpp -o rate_modulation_check
+ *
+ * For each case the oscillator and the reference integrate the same model time per sample; the
+ * reference uses RK4 steps of at most REFERENCE_DT. The error is the largest distance between
+ * the two trajectories over the first HORIZON units of model time, before chaotic divergence
+ * dominates. Exits with a non-zero status if a case exceeds its tolerance.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+
+#include "../math/chaos_osc.hpp"
+
+constexpr float SAMPLING_FREQUENCY = 48000.0f;
+constexpr float REFERENCE_DT = 1e-4f;
+constexpr float HORIZON = 5.0f;
+constexpr float TOLERANCE = 1e-2f;
+
+struct Case {
+    const char *name;
+    float sample_dt;
+    /// Time scale of sample n
+    std::function<float(size_t)> rate;
+};
+
+template <class M> bool run(const char *model_name, math::vec3f seed, const Case &c) {
+    const float max_dt = math::DEFAULT_DT;
+    ChaosOsc<M> osc(M{}, seed, SAMPLING_FREQUENCY, c.sample_dt * SAMPLING_FREQUENCY, max_dt);
+
+    math::DiscretizedModel<M> reference(M{}, REFERENCE_DT);
+    math::vec3f expected = seed;
+
+    double time = 0.0, max_error = 0.0;
+    size_t samples = 0, steps = 0, max_steps = 0;
+
+    while (time < HORIZON) {
+        float rate = c.rate(samples);
+
+        // Reference: same model time, fine equal steps
+        float elapsed = c.sample_dt * std::max(rate, 0.0f);
+        auto n = static_cast<size_t>(std::ceil(elapsed / REFERENCE_DT));
+        reference.dt = n ? elapsed / n : 0.0f;
+        for (size_t k = 0; k < n; k++)
+            expected = reference.step(expected);
+
+        math::vec3f actual = osc.step(rate);
+        size_t taken = osc.get_last_steps();
+        steps += taken;
+        max_steps = std::max(max_steps, taken);
+
+        math::vec3f diff = actual - expected;
+        max_error = std::max<double>(max_error, std::sqrt(math::dot(diff, diff)));
+
+        time += elapsed;
+        samples++;
+    }
+
+    bool ok = max_error <= TOLERANCE;
+    std::printf("%-10s %-28s error %.2e  steps/sample %.2f (max %zu)  %s\n", model_name, c.name,
+                max_error, static_cast<double>(steps) / samples, max_steps, ok ? "ok" : "FAIL");
+    return ok;
+}
+
+int main() {
+    constexpr float TWO_PI = 6.28318530718f;
+    auto fm = [](float depth, float frequency) {
+        return [=](size_t n) {
+            return 1.0f + depth * std::sin(TWO_PI * frequency * n / SAMPLING_FREQUENCY);
+        };
+    };
+
+    const Case cases[] = {
+        {"constant, dt = 0.4 max_dt", 0.004f, [](size_t) { return 1.0f; }},
+        {"constant, dt = 2.5 max_dt", 0.025f, [](size_t) { return 1.0f; }},
+        {"FM 90% at 440 Hz", 0.004f, fm(0.9f, 440.0f)},
+        {"FM 90% at 440 Hz, fast", 0.02f, fm(0.9f, 440.0f)},
+        {"FM 150% at 3 kHz (clipped)", 0.004f, fm(1.5f, 3000.0f)},
+    };
+
+    bool ok = true;
+    for (const auto &c : cases) {
+        ok &= run<math::Rossler>("Rossler", {10.4794f, -1.0197f, 8.6062f}, c);
+        ok &= run<math::Chua>("Chua", {-0.1761f, -0.1046f, -1.1139f}, c);
+        ok &= run<math::Halvorsen>("Halvorsen", {-4.5143f, -7.2574f, 5.7629f}, c);
+    }
+    return ok ? 0 : 1;
+}
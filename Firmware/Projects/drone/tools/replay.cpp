@@ -0,0 +1,217 @@
+/*
+ * Host tool: replays a session recorded by the firmware (RECORD_EVENTS) through the same engine
+ * as the output callback, to reproduce and profile it off-device.
+ *
+ * Build (from Firmware/Projects/drone):
+ *   g++ -std=gnu++17 -O2 -ffp-contract=off tools/replay.cpp engine/khaos_engine.cpp \
+ *       math/models.cpp -o replay
+ *
+ * Usage:
+ *   ./replay <log file> [-o output.raw] [-t extra seconds] [-v]
+ *
+ * The log is the debug output of the module: lines containing `REC <hex>` are decoded, everything
+ * else is ignored. Model changes are applied at the block where they were applied on the module,
+ * then rendering continues for the extra seconds (default 10) after the last event. A session
+ * resumed from a snapshot starts from the recorded oscillator states, and the quality levels
+ * chosen by the governor on the module are applied where they changed, as is the frequency set
+ * by the rate CV.
+ * Prints a hash of the DAC output and the average render time per block; -o writes the DAC
+ * values as interleaved little-endian uint16 (channel 0, channel 1), -v prints every event.
+ *
+ * The replay is deterministic: the same log always renders the same output. Both the firmware
+ * (see the Makefile) and the replayer are built with -ffp-contract=off, so that neither fuses
+ * multiply-adds and the output matches the module bit for bit, given IEEE single precision
+ * arithmetic on the host (x86-64 SSE or AArch64; not x87).
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "../engine/khaos_engine.hpp"
+#include "../engine/record.hpp"
+
+static std::vector<RecordEvent> read_events(const char *path) {
+    std::vector<RecordEvent> events;
+    FILE *file = std::fopen(path, "r");
+    if (!file) {
+        std::perror(path);
+        std::exit(1);
+    }
+
+    char line[512];
+    while (std::fgets(line, sizeof(line), file)) {
+        const char *record = std::strstr(line, RECORD_PREFIX);
+        RecordEvent event;
+        if (record && record_decode(record + std::strlen(RECORD_PREFIX), event))
+            events.push_back(event);
+    }
+    std::fclose(file);
+
+    // Events from main and from the output callback are logged independently
+    std::stable_sort(events.begin(), events.end(),
+                     [](const RecordEvent &a, const RecordEvent &b) { return a.frame < b.frame; });
+    return events;
+}
+
+static void print_event(const RecordEvent &event) {
+    std::printf("frame %10lu  ", static_cast<unsigned long>(event.frame));
+    switch (event.type) {
+    case RecordType::CONFIG:
+        std::printf("config\n");
+        break;
+    case RecordType::INPUT: {
+        RecordedInput input;
+        if (event.get(input)) {
+            std::printf("input   encoders %u %u %u %u  switches %x  cvs %u %u\n",
+                        input.encoder_values[0], input.encoder_values[1], input.encoder_values[2],
+                        input.encoder_values[3], input.switches, input.cvs[0], input.cvs[1]);
+        }
+        break;
+    }
+    case RecordType::PARAMS:
+        std::printf("params  model %u (%u bytes)\n", event.index, event.size);
+        break;
+    case RecordType::SELECT:
+        std::printf("select  model %u\n", event.index);
+        break;
+    case RecordType::STATE:
+        std::printf("state   model %u\n", event.index);
+        break;
+    case RecordType::QUALITY: {
+        uint8_t level;
+        if (event.get(level))
+            std::printf("quality model %u  level %u\n", event.index, level);
+        break;
+    }
+    case RecordType::FREQUENCY: {
+        float frequency;
+        if (event.get(frequency))
+            std::printf("frequency %g Hz\n", frequency);
+        break;
+    }
+    }
+}
+
+int main(int argc, char **argv) {
+    const char *log_path = nullptr;
+    const char *output_path = nullptr;
+    float extra_seconds = 10.0f;
+    bool verbose = false;
+
+    for (int i = 1; i < argc; i++) {
+        if (!std::strcmp(argv[i], "-o") && i + 1 < argc)
+            output_path = argv[++i];
+        else if (!std::strcmp(argv[i], "-t") && i + 1 < argc)
+            extra_seconds = std::strtof(argv[++i], nullptr);
+        else if (!std::strcmp(argv[i], "-v"))
+            verbose = true;
+        else
+            log_path = argv[i];
+    }
+    if (!log_path) {
+        std::fprintf(stderr, "usage: %s <log file> [-o output.raw] [-t seconds] [-v]\n", argv[0]);
+        return 1;
+    }
+
+    std::vector<RecordEvent> events = read_events(log_path);
+    KhaosEngineConfig config;
+    auto config_event = std::find_if(events.begin(), events.end(), [](const RecordEvent &e) {
+        return e.type == RecordType::CONFIG;
+    });
+    if (config_event == events.end() || !config_event->get(config) || config.block_size == 0) {
+        std::fprintf(stderr, "%s: no engine configuration recorded\n", log_path);
+        return 1;
+    }
+
+    FILE *output = output_path ? std::fopen(output_path, "wb") : nullptr;
+    if (output_path && !output) {
+        std::perror(output_path);
+        return 1;
+    }
+
+    KhaosEngine engine(config);
+    KhaosModelData data;
+    std::vector<math::vec3f> block(config.block_size);
+    std::vector<uint16_t> dac(2 * config.block_size);
+
+    uint32_t last_frame = events.empty() ? 0 : events.back().frame;
+    auto end_frame = static_cast<uint64_t>(last_frame) +
+                     static_cast<uint64_t>(extra_seconds * config.sample_rate);
+
+    uint64_t hash = 14695981039346656037ull; // FNV-1a
+    uint32_t reseeds = 0;
+    size_t next_event = 0, blocks = 0;
+    std::chrono::steady_clock::duration render_time{};
+
+    for (uint64_t frame = 0; frame < end_frame; frame += config.block_size, blocks++) {
+        // Same as a successful TriBuf swap in the callback: all pending changes at once
+        bool swapped = false, resumed = false;
+        KhaosEngineState state{};
+        for (; next_event < events.size() && events[next_event].frame <= frame; next_event++) {
+            const RecordEvent &event = events[next_event];
+            if (verbose)
+                print_event(event);
+
+            if (event.type == RecordType::PARAMS && event.index < KhaosModelData::NUM_MODELS) {
+                KhaosModelData::visit_params(data, event.index, [&](auto &params) {
+                    if (event.get(params)) {
+                        data.touch(static_cast<KhaosModelData::SelectedModel>(event.index));
+                        swapped = true;
+                    }
+                });
+            } else if (event.type == RecordType::SELECT &&
+                       event.index < KhaosModelData::NUM_MODELS) {
+                data.selected = static_cast<KhaosModelData::SelectedModel>(event.index);
+                swapped = true;
+            } else if (event.type == RecordType::STATE && frame == 0 &&
+                       event.index < KhaosModelData::NUM_MODELS) {
+                resumed |= event.get(state.states[event.index]);
+            } else if (event.type == RecordType::FREQUENCY) {
+                swapped |= event.get(data.frequency);
+            } else if (event.type == RecordType::QUALITY &&
+                       event.index < KhaosModelData::NUM_MODELS) {
+                // The governor is not run: its decisions depend on the timing of the module
+                uint8_t level;
+                if (event.get(level))
+                    engine.set_quality_level(event.index, level);
+            }
+        }
+        if (resumed)
+            engine.resume(data, state);
+        else if (swapped)
+            engine.set_model_data(data);
+
+        auto start = std::chrono::steady_clock::now();
+        uint32_t reseeded = engine.render(block.data(), block.size());
+        render_time += std::chrono::steady_clock::now() - start;
+        reseeds += __builtin_popcount(reseeded);
+
+        for (size_t i = 0; i < block.size(); i++) {
+            dac[2 * i] = to_dac(block[i].x());
+            dac[2 * i + 1] = to_dac(block[i].y());
+        }
+        for (uint16_t value : dac) {
+            hash = (hash ^ (value & 0xFF)) * 1099511628211ull;
+            hash = (hash ^ (value >> 8)) * 1099511628211ull;
+        }
+        if (output)
+            std::fwrite(dac.data(), sizeof(uint16_t), dac.size(), output);
+    }
+
+    if (output)
+        std::fclose(output);
+
+    std::printf("events %zu  blocks %zu  frames %llu  reseeds %lu\n", events.size(), blocks,
+                static_cast<unsigned long long>(blocks) * config.block_size,
+                static_cast<unsigned long>(reseeds));
+    std::printf("output hash %016llx\n", static_cast<unsigned long long>(hash));
+    std::printf("render %.2f us/block\n",
+                std::chrono::duration<double, std::micro>(render_time).count() /
+                    std::max<size_t>(blocks, 1));
+    return 0;
+}
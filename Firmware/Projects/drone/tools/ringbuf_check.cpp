@@ -0,0 +1,146 @@
+/*
+ * Host tool: checks the lock-free ring buffer (sync/RingBuf.hpp) with a producer and a consumer
+ * thread.
+ *
+ * Build (from Firmware/Projects/drone):
+ *   g++ -std=gnu++17 -O2 -pthread tools/ringbuf_check.cpp -o ringbuf_check
+ *
+ * Elements carry a sequence number and copies derived from it, so that an element read before
+ * it was completely written shows up. Checks:
+ *  - single thread: a full buffer drops and counts new elements, and the slots are reused in
+ *    order after the indices wrap around the capacity;
+ *  - paced producer (never pushes into a full buffer): every element arrives once, in order,
+ *    nothing is dropped;
+ *  - free-running producer (the buffer overflows): the elements which arrive are whole and in
+ *    order, without duplicates, and those missing are exactly the ones counted as dropped.
+ * The threads pop in batches of varying sizes, so that the indices wrap around the capacity at
+ * every offset. Exits with a non-zero status if a check fails.
+ */
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+#include "../sync/RingBuf.hpp"
+
+constexpr size_t CAPACITY = 64;
+constexpr uint64_t COUNT = 1000000;
+
+struct Element {
+    uint64_t sequence;
+    uint64_t check[3];
+
+    static Element make(uint64_t sequence) {
+        return {sequence, {~sequence, sequence * 0x9E3779B97F4A7C15ull, sequence ^ 0x5555u}};
+    }
+
+    bool whole() const {
+        Element expected = make(sequence);
+        return expected.check[0] == check[0] && expected.check[1] == check[1] &&
+               expected.check[2] == check[2];
+    }
+};
+
+using Ring = RingBuf<Element, CAPACITY>;
+
+static bool check(bool ok, const char *label) {
+    std::printf("%-60s %s\n", label, ok ? "ok" : "FAIL");
+    return ok;
+}
+
+static bool check_single_thread() {
+    Ring ring;
+    std::vector<Element> out(CAPACITY);
+    uint64_t pushed = 0, popped = 0;
+    bool ok = true;
+
+    // Fill, overflow once, then drain part of it, several times around the buffer
+    for (size_t round = 0; round < 10; round++) {
+        while (ring.size() < CAPACITY)
+            ok &= ring.push(Element::make(pushed++));
+        uint32_t dropped = ring.dropped();
+        ok &= !ring.push(Element::make(~0ull)) && ring.dropped() == dropped + 1;
+
+        size_t count = ring.pop(out.data(), 3 * CAPACITY / 4 - round);
+        ok &= count == 3 * CAPACITY / 4 - round;
+        for (size_t i = 0; i < count; i++)
+            ok &= out[i].sequence == popped++ && out[i].whole();
+    }
+    size_t count = ring.pop(out.data(), out.size());
+    for (size_t i = 0; i < count; i++)
+        ok &= out[i].sequence == popped++;
+    ok &= popped == pushed && ring.size() == 0 && ring.pop(out.data(), 1) == 0;
+    return check(ok, "single thread: overflow and wrap-around");
+}
+
+/**
+ * @brief Pushes COUNT elements from one thread and pops them from another.
+ * @param paced whether the producer waits for room instead of dropping
+ */
+static bool check_threads(bool paced) {
+    Ring ring;
+    std::atomic<bool> done{false};
+
+    std::thread producer([&] {
+        for (uint64_t i = 0; i < COUNT; i++) {
+            if (paced) {
+                while (ring.size() == CAPACITY)
+                    std::this_thread::yield();
+            }
+            ring.push(Element::make(i));
+            // Bursts of twice the capacity, as from the output callback: the buffer overflows,
+            // and the consumer still gets to run on a single core
+            if (!paced && i % (2 * CAPACITY) == 0)
+                std::this_thread::yield();
+        }
+        done.store(true, std::memory_order_release);
+    });
+
+    std::vector<Element> out(CAPACITY);
+    uint64_t received = 0, next = 0;
+    bool ordered = true, whole = true;
+    size_t batch = 1;
+    while (true) {
+        bool finished = done.load(std::memory_order_acquire);
+        size_t count = ring.pop(out.data(), batch);
+        for (size_t i = 0; i < count; i++) {
+            whole &= out[i].whole();
+            // Elements may be missing (dropped), never repeated nor out of order
+            ordered &= out[i].sequence >= next && (!paced || out[i].sequence == next);
+            next = out[i].sequence + 1;
+        }
+        received += count;
+        batch = batch % CAPACITY + 1;
+        if (finished && count == 0)
+            break;
+        if (count == 0)
+            std::this_thread::yield();
+    }
+    producer.join();
+
+    char label[96];
+    bool ok = whole && ordered;
+    if (paced) {
+        ok &= received == COUNT && ring.dropped() == 0;
+        std::snprintf(label, sizeof(label), "paced producer: %llu received, %lu dropped",
+                      static_cast<unsigned long long>(received),
+                      static_cast<unsigned long>(ring.dropped()));
+    } else {
+        ok &= received + ring.dropped() == COUNT;
+        std::snprintf(label, sizeof(label), "free-running producer: %llu received, %lu dropped",
+                      static_cast<unsigned long long>(received),
+                      static_cast<unsigned long>(ring.dropped()));
+    }
+    return check(ok, label);
+}
+
+int main() {
+    bool ok = check_single_thread();
+    ok = check_threads(true) && ok;
+    ok = check_threads(false) && ok;
+
+    std::printf("\n%s\n", ok ? "ok" : "FAIL");
+    return ok ? 0 : 1;
+}
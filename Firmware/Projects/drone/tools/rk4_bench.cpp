@@ -0,0 +1,106 @@
+/*
+ * Host tool: fused RK4 kernels (math::rk4_fused, overridden by every continuous model) against
+ * the generic math::rk4, which calls the gradient through a std::function.
+ *
+ * Build (from Firmware/Projects/drone):
+ *   g++ -std=gnu++17 -O2 -fno-tree-slp-vectorize tools/rk4_bench.cpp math/models.cpp -o rk4_bench
+ * -fno-tree-slp-vectorize approximates the scalar FPU of the target: with SIMD, the host
+ * vectorizes the generic step and the comparison no longer says anything about the firmware
+ * (on x86, Sprott then comes out faster through the generic step).
+ *
+ * For each of the five models of the engine, at its default parameters and the default dt:
+ *  - both steps are applied to the same states along a trajectory, and their largest difference,
+ *    relative to the extent of the attractor, must stay below MAX_STEP_ERROR: the kernels only
+ *    reorder the floating-point operations;
+ *  - both are timed over the same trajectory, in ns per step.
+ * Exits with a non-zero status if the steps disagree or if a fused kernel is slower than the
+ * generic step. Host timings only give an idea of the relative cost: measure on the target.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "../math/models.hpp"
+#include "../math/seed_tables.hpp"
+
+using math::vec3f;
+using Base = math::ContinuousModel<vec3f>;
+
+constexpr size_t STATES = 4096;
+constexpr size_t TIMED_STEPS = 1000000;
+constexpr double MAX_STEP_ERROR = 1e-6;
+
+/// @brief States along the attractor, after a transient
+template <class M> static std::vector<vec3f> trajectory(const M &model) {
+    const math::rk4_coeffs<float> coeffs(math::DEFAULT_DT);
+    vec3f x = math::model_seeds(model)[0];
+    for (size_t i = 0; i < 10000; i++)
+        x = model.rk4_step(x, coeffs);
+
+    std::vector<vec3f> states(STATES);
+    for (vec3f &state : states) {
+        for (size_t i = 0; i < 10; i++)
+            x = model.rk4_step(x, coeffs);
+        state = x;
+    }
+    return states;
+}
+
+/// @brief ns per step of `step(state)`, integrating from the first state
+template <class F> static double ns_per_step(vec3f x, F &&step) {
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < TIMED_STEPS; i++)
+        x = step(x);
+    auto end = std::chrono::steady_clock::now();
+    volatile float sink = x.x();
+    (void)sink;
+    return std::chrono::duration<double, std::nano>(end - start).count() / TIMED_STEPS;
+}
+
+template <class M> static bool compare(const char *name) {
+    const M model;
+    const math::rk4_coeffs<float> coeffs(math::DEFAULT_DT);
+    const std::vector<vec3f> states = trajectory(model);
+
+    vec3f low = states[0], high = states[0];
+    for (const vec3f &x : states) {
+        for (size_t k = 0; k < 3; k++) {
+            low[k] = std::min(low[k], x[k]);
+            high[k] = std::max(high[k], x[k]);
+        }
+    }
+    vec3f extent = high - low;
+    double size = std::sqrt(math::dot(extent, extent));
+
+    double error = 0.0;
+    for (const vec3f &x : states) {
+        vec3f d = model.rk4_step(x, coeffs) - model.Base::rk4_step(x, coeffs);
+        error = std::max(error, std::sqrt(static_cast<double>(math::dot(d, d))) / size);
+    }
+
+    double generic = ns_per_step(states[0], [&](vec3f x) {
+        return model.Base::rk4_step(x, coeffs);
+    });
+    double fused = ns_per_step(states[0], [&](vec3f x) { return model.rk4_step(x, coeffs); });
+
+    bool ok = error < MAX_STEP_ERROR && fused < generic;
+    std::printf("%-10s %12.1f %12.1f %9.2f %12.2e  %s\n", name, generic, fused, generic / fused,
+                error, ok ? "ok" : "FAIL");
+    return ok;
+}
+
+int main() {
+    std::printf("%-10s %12s %12s %9s %12s\n", "model", "generic ns", "fused ns", "speedup",
+                "step error");
+    bool ok = compare<math::Chua>("Chua");
+    ok = compare<math::Sprott>("Sprott") && ok;
+    ok = compare<math::Rossler>("Rossler") && ok;
+    ok = compare<math::Halvorsen>("Halvorsen") && ok;
+    ok = compare<math::Lorentz>("Lorentz") && ok;
+
+    std::printf("\n%s\n", ok ? "ok" : "FAIL");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,312 @@
+/*
+ * Host tool: ROS2 (math::ros2_step) against RK4 at the integration steps of the quality levels
+ * of the governor (engine/khaos_engine.hpp), and at matched error in stiffer Chua settings.
+ *
+ * Build (from Firmware/Projects/drone):
+ *   g++ -std=gnu++17 -O2 -fno-tree-slp-vectorize tools/ros2_bench.cpp math/models.cpp -o ros2_bench
+ *
+ * For each of the five models of the engine, at its default parameters, both integrators are run
+ * through DiscretizedModel, as ChaosOsc does, at max_dt = DEFAULT_DT times the dt scale of each
+ * quality level, and twice the last one. Reported:
+ *  - the error: START_STATES states of the attractor are advanced by HORIZON units of model time,
+ *    and the largest distance to a double precision RK4 reference at REFERENCE_DT is given
+ *    relative to the extent of the attractor ("lost" from 1 on);
+ *  - whether a trajectory stays within the escape radius of the watchdog for LONG_TIME units
+ *    ("escaped" at the time it leaves);
+ *  - the steps per sample, and their cost, at the highest model time per sample the nominal level
+ *    covers (DEFAULT_MAX_STEPS_PER_SAMPLE steps of DEFAULT_DT).
+ * Then, at matched error, for the five models and for Chua at higher alpha (STIFF_CHUA): for each
+ * of MATCHED_ERRORS, the largest step of a ladder from HORIZON / 1024 to HORIZON / 3 (up to 33
+ * times DEFAULT_DT, as a high frequency multiplier asks) at which the error above stays within
+ * it, and the gradient evaluations (a Jacobian counts as one) and ns per sample it takes. The
+ * reference is checked for convergence against half its step.
+ * Exits with a non-zero status if RK4 at DEFAULT_DT is off by more than MAX_NOMINAL_ERROR, if RK4
+ * lets a model escape at the step of a quality level, or if a reference has not converged to
+ * MAX_REFERENCE_ERROR.
+ * Host timings only give an idea of the relative cost: measure on the target.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <utility>
+#include <vector>
+
+#include "../engine/khaos_engine.hpp"
+
+using math::vec3f;
+using vec3d = math::vec<3, double>;
+
+/// Stiffer Chua settings (alpha, beta): the fast x axis relaxes at about 0.29 alpha. With the
+/// default diode, the trajectory escapes from alpha about 100 at every beta up to 200
+constexpr std::pair<float, float> STIFF_CHUA[] = {{44.0f, 100.0f}, {86.0f, 200.0f}};
+
+constexpr size_t START_STATES = 64;
+constexpr double HORIZON = 1.0;
+constexpr double REFERENCE_DT = 1e-4;
+constexpr double LONG_TIME = 2000.0;
+constexpr double MAX_NOMINAL_ERROR = 1e-3;
+constexpr float SAMPLE_TIME = math::DEFAULT_DT * DEFAULT_MAX_STEPS_PER_SAMPLE;
+constexpr size_t TIMED_STEPS = 1000000;
+/// Errors after HORIZON at which the integrators are compared, and the steps over HORIZON tried
+constexpr double MATCHED_ERRORS[] = {1e-3, 1e-2, 1e-1};
+constexpr size_t MATCHED_MAX_STEPS = 1024;
+constexpr size_t MATCHED_MIN_STEPS = 3;
+/// Gradient evaluations per step, a Jacobian counting as one
+constexpr double RK4_EVALUATIONS = 4;
+constexpr double ROS2_EVALUATIONS = 3;
+/// Distance between the references at REFERENCE_DT and half of it, relative to the extent of the
+/// attractor: well below the smallest of MATCHED_ERRORS
+constexpr double MAX_REFERENCE_ERROR = 1e-5;
+
+static vec3d to_double(vec3f x) { return {x.x(), x.y(), x.z()}; }
+
+/// @brief Double precision RK4 on the templated field of the model
+template <class M> static vec3d reference(const M &model, vec3d x, double dt = REFERENCE_DT) {
+    const auto steps = static_cast<size_t>(std::lround(HORIZON / dt));
+    for (size_t i = 0; i < steps; i++) {
+        vec3d k1 = model.field(x);
+        vec3d k2 = model.field(x + (dt / 2) * k1);
+        vec3d k3 = model.field(x + (dt / 2) * k2);
+        vec3d k4 = model.field(x + dt * k3);
+        x = x + (dt / 6) * (k1 + 2.0 * k2 + 2.0 * k3 + k4);
+    }
+    return x;
+}
+
+/// @brief States along the attractor, with the reference after HORIZON
+struct Starts {
+    std::vector<vec3f> states;
+    std::vector<vec3d> expected;
+    double size;
+    vec3f center;
+    float escape_radius_sq;
+};
+
+struct Result {
+    double error;
+    /// Model time at which the trajectory left the escape radius, LONG_TIME if it did not
+    double escaped_at;
+    double ns_per_step;
+};
+
+template <class M> static Starts starts(const M &model, const ModelBounds &bounds) {
+    const math::rk4_coeffs<float> coeffs(math::DEFAULT_DT);
+    vec3f x = math::model_seeds(model)[0];
+    for (size_t i = 0; i < 10000; i++)
+        x = model.rk4_step(x, coeffs);
+
+    Starts res{std::vector<vec3f>(START_STATES), std::vector<vec3d>(START_STATES), 0.0, {}, 0.0f};
+    vec3f low = x, high = x;
+    for (size_t i = 0; i < START_STATES; i++) {
+        for (size_t s = 0; s < 100; s++) {
+            x = model.rk4_step(x, coeffs);
+            for (size_t k = 0; k < 3; k++) {
+                low[k] = std::min(low[k], x[k]);
+                high[k] = std::max(high[k], x[k]);
+            }
+        }
+        res.states[i] = x;
+        res.expected[i] = reference(model, to_double(x));
+    }
+    vec3f extent = high - low;
+    res.size = std::sqrt(math::dot(extent, extent));
+
+    // As the watchdog of the engine
+    vec3f half_diagonal = (bounds.max - bounds.min) / 2.0f;
+    res.center = (bounds.max + bounds.min) / 2.0f;
+    res.escape_radius_sq =
+        WATCHDOG_ESCAPE_FACTOR * WATCHDOG_ESCAPE_FACTOR * math::dot(half_diagonal, half_diagonal);
+    return res;
+}
+
+/// @brief Largest distance to the reference after HORIZON, relative to the extent of the
+/// attractor
+template <class M>
+static double error(const M &model, const Starts &s, math::Integrator integrator, float dt) {
+    math::DiscretizedModel<M> discrete(model, dt);
+    discrete.integrator = integrator;
+    double res = 0.0;
+    const auto steps = static_cast<size_t>(std::lround(HORIZON / dt));
+    for (size_t i = 0; i < s.states.size(); i++) {
+        vec3f x = s.states[i];
+        for (size_t n = 0; n < steps; n++)
+            x = discrete.step(x);
+        vec3d d = to_double(x) - s.expected[i];
+        double distance = std::sqrt(math::dot(d, d)) / s.size;
+        // NaN compares false: keep it
+        res = distance <= res ? res : distance;
+    }
+    return res;
+}
+
+template <class M>
+static double ns_per_step(const M &model, const Starts &s, math::Integrator integrator,
+                          float dt) {
+    math::DiscretizedModel<M> discrete(model, dt);
+    discrete.integrator = integrator;
+    vec3f x = s.states[0];
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < TIMED_STEPS; i++)
+        x = discrete.step(x);
+    auto end = std::chrono::steady_clock::now();
+    volatile float sink = x.x();
+    (void)sink;
+    return std::chrono::duration<double, std::nano>(end - start).count() / TIMED_STEPS;
+}
+
+template <class M>
+static Result run(const M &model, const Starts &s, math::Integrator integrator, float dt) {
+    math::DiscretizedModel<M> discrete(model, dt);
+    discrete.integrator = integrator;
+    Result res{error(model, s, integrator, dt), LONG_TIME, ns_per_step(model, s, integrator, dt)};
+
+    vec3f x = s.states[0];
+    const auto long_steps = static_cast<size_t>(std::lround(LONG_TIME / dt));
+    for (size_t n = 0; n < long_steps; n++) {
+        x = discrete.step(x);
+        vec3f offset = x - s.center;
+        if (!(math::dot(offset, offset) < s.escape_radius_sq)) {
+            res.escaped_at = static_cast<double>(n + 1) * dt;
+            break;
+        }
+    }
+    return res;
+}
+
+/// @brief Largest dt of the ladder HORIZON / n at which the error stays within `target`, along
+/// with every smaller step (the error of a chaotic trajectory is not monotonic in dt); 0 if none
+template <class M>
+static float matched_dt(const M &model, const Starts &s, math::Integrator integrator,
+                        double target) {
+    float dt = 0.0f;
+    for (size_t n = MATCHED_MAX_STEPS; n >= MATCHED_MIN_STEPS; n = n * 4 / 5) {
+        float step = static_cast<float>(HORIZON / n);
+        if (!(error(model, s, integrator, step) <= target))
+            break;
+        dt = step;
+    }
+    return dt;
+}
+
+/**
+ * @brief Gradient evaluations per output sample of each integrator at matched error: for each
+ * target, at the largest step that meets it (a Jacobian counts as one evaluation).
+ * @return whether the reference has converged
+ */
+template <class M>
+static bool compare_matched(const char *name, const M &model, KhaosModelData::SelectedModel id) {
+    const Starts s = starts(model, MODEL_BOUNDS[id]);
+    double converged = 0.0;
+    for (size_t i = 0; i < s.states.size(); i++) {
+        vec3d d = reference(model, to_double(s.states[i]), REFERENCE_DT / 2) - s.expected[i];
+        converged = std::max(converged, std::sqrt(math::dot(d, d)) / s.size);
+    }
+    const double rk4_ns = ns_per_step(model, s, math::Integrator::RK4, math::DEFAULT_DT);
+    const double ros2_ns = ns_per_step(model, s, math::Integrator::ROS2, math::DEFAULT_DT);
+
+    for (double target : MATCHED_ERRORS) {
+        std::printf("%-22s %7.0e", name, target);
+        double evals[2];
+        size_t k = 0;
+        for (math::Integrator integrator : {math::Integrator::RK4, math::Integrator::ROS2}) {
+            float dt = matched_dt(model, s, integrator, target);
+            if (dt == 0.0f) {
+                evals[k++] = INFINITY;
+                std::printf(" %8s %6s %8s", "-", "-", "-");
+                continue;
+            }
+            auto steps = static_cast<unsigned>(std::ceil(SAMPLE_TIME / dt));
+            bool rk4 = integrator == math::Integrator::RK4;
+            evals[k++] = steps * (rk4 ? RK4_EVALUATIONS : ROS2_EVALUATIONS);
+            std::printf(" %8.4f %6.0f %8.1f", dt, evals[k - 1], steps * (rk4 ? rk4_ns : ros2_ns));
+        }
+        if (std::isfinite(evals[0]) && std::isfinite(evals[1]))
+            std::printf(" %9.2f\n", evals[1] / evals[0]);
+        else
+            std::printf(" %9s\n", "-");
+    }
+    bool ok = converged < MAX_REFERENCE_ERROR;
+    if (!ok)
+        std::printf("%-22s reference not converged: %.1e\n", name, converged);
+    return ok;
+}
+
+static void print(const Result &r) {
+    if (std::isfinite(r.error) && r.error < 1.0)
+        std::printf(" %9.2e", r.error);
+    else
+        std::printf(" %9s", "lost");
+    if (r.escaped_at < LONG_TIME)
+        std::printf(" %8.1f", r.escaped_at);
+    else
+        std::printf(" %8s", "-");
+}
+
+template <class M> static bool compare(const char *name, KhaosModelData::SelectedModel id) {
+    const M model;
+    const Starts s = starts(model, MODEL_BOUNDS[id]);
+
+    std::printf("\n%s\n%6s %8s %6s %9s %8s %9s %8s %8s %8s %9s\n", name, "level", "dt", "steps",
+                "RK4 err", "escaped", "ROS2 err", "escaped", "RK4 ns", "ROS2 ns", "ROS2/RK4");
+    bool ok = true;
+    for (size_t level = 0; level <= QUALITY_LEVELS.size(); level++) {
+        const bool beyond = level == QUALITY_LEVELS.size();
+        float scale = beyond ? 2.0f * QUALITY_LEVELS.back().dt_scale
+                             : QUALITY_LEVELS[level].dt_scale;
+        float dt = math::DEFAULT_DT * scale;
+        Result rk4 = run(model, s, math::Integrator::RK4, dt);
+        Result ros2 = run(model, s, math::Integrator::ROS2, dt);
+        auto steps = static_cast<unsigned>(std::ceil(SAMPLE_TIME / dt));
+
+        if (beyond)
+            std::printf("%6s", "-");
+        else
+            std::printf("%6zu", level);
+        std::printf(" %8.3f %6u", dt, steps);
+        print(rk4);
+        print(ros2);
+        std::printf(" %8.1f %8.1f %9.2f\n", steps * rk4.ns_per_step, steps * ros2.ns_per_step,
+                    ros2.ns_per_step / rk4.ns_per_step);
+
+        if (level == 0)
+            ok &= rk4.error < MAX_NOMINAL_ERROR;
+        if (!beyond) {
+            ok &= rk4.escaped_at >= LONG_TIME;
+        }
+    }
+    return ok;
+}
+
+int main() {
+    std::printf("error after %g time units; steps and ns per sample of %g time units; "
+                "escapes within %g time units\n",
+                HORIZON, SAMPLE_TIME, LONG_TIME);
+    bool ok = compare<math::Chua>("Chua", KhaosModelData::CHUA);
+    ok = compare<math::Sprott>("Sprott", KhaosModelData::SPROTT) && ok;
+    ok = compare<math::Rossler>("Rossler", KhaosModelData::ROSSLER) && ok;
+    ok = compare<math::Halvorsen>("Halvorsen", KhaosModelData::HALVORSEN) && ok;
+    ok = compare<math::Lorentz>("Lorentz", KhaosModelData::LORENTZ) && ok;
+
+    std::printf("\nmatched error after %g time units: largest dt, gradient evaluations and ns per "
+                "sample of %g time units\n%-22s %7s %8s %6s %8s %8s %6s %8s %9s\n",
+                HORIZON, SAMPLE_TIME, "model", "error", "RK4 dt", "evals", "ns", "ROS2 dt",
+                "evals", "ns", "ROS2/RK4");
+    ok = compare_matched("Chua", math::Chua{}, KhaosModelData::CHUA) && ok;
+    for (auto [alpha, beta] : STIFF_CHUA) {
+        math::Chua chua;
+        chua.alpha = alpha;
+        chua.beta = beta;
+        char name[64];
+        std::snprintf(name, sizeof(name), "Chua a=%g b=%g", alpha, beta);
+        ok = compare_matched(name, chua, KhaosModelData::CHUA) && ok;
+    }
+    ok = compare_matched("Sprott", math::Sprott{}, KhaosModelData::SPROTT) && ok;
+    ok = compare_matched("Rossler", math::Rossler{}, KhaosModelData::ROSSLER) && ok;
+    ok = compare_matched("Halvorsen", math::Halvorsen{}, KhaosModelData::HALVORSEN) && ok;
+    ok = compare_matched("Lorentz", math::Lorentz{}, KhaosModelData::LORENTZ) && ok;
+
+    std::printf("\n%s\n", ok ? "ok" : "FAIL");
+    return ok ? 0 : 1;
+}
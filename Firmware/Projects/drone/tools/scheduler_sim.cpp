@@ -0,0 +1,214 @@
+/*
+ * Host tool: runs the main loop scheduler (sync/Scheduler.hpp) against a simulated clock, with
+ * the task set of the firmware and simulated task costs and interrupts.
+ *
+ * Build (from Firmware/Projects/drone):
+ *   g++ -std=gnu++17 -O2 tools/scheduler_sim.cpp -o scheduler_sim
+ *
+ * The clock starts shortly before the 32-bit microsecond counter wraps around. Interrupts (input
+ * changes signaling the input task) are raised during task runs and during sleeps, as on the
+ * module. Prints the statistics of each scenario and exits with a non-zero status if the nominal
+ * one misses a deadline or loses a release.
+ */
+
+#include <cstdio>
+#include <functional>
+#include <random>
+#include <vector>
+
+#include "../sync/Scheduler.hpp"
+
+// Keep in sync with drone.cpp
+constexpr uint32_t INPUT_SAMPLE_RATE = 1;
+constexpr uint32_t DISPLAY_REFRESH_RATE = 30;
+constexpr uint32_t INPUT_DEADLINE = 20000;
+constexpr uint32_t DISPLAY_DEADLINE = 1000000 / DISPLAY_REFRESH_RATE;
+constexpr uint32_t LOG_PERIOD = 20000;
+constexpr uint32_t LOG_DEADLINE = 50000;
+constexpr uint32_t SNAPSHOT_PERIOD = 60000000;
+constexpr uint32_t SNAPSHOT_DEADLINE = 1000000;
+constexpr uint32_t SCHEDULER_STATS_PERIOD = 10000000;
+enum MainTask { TASK_INPUT = 0, TASK_DISPLAY, TASK_LOG, TASK_SNAPSHOT, TASK_STATS, NUM_TASKS };
+
+/// Rate of the filtered CVs, which signal the input task when they change
+constexpr uint32_t CV_RATE = 125;
+
+class SimClock {
+  public:
+    explicit SimClock(uint32_t start) : time(start) {}
+
+    uint32_t now() const { return time; }
+
+    /// @brief Raises `interrupt` at `when`.
+    void at(uint32_t when, std::function<void()> interrupt) {
+        interrupts.push_back({when, std::move(interrupt)});
+    }
+
+    /// @brief Spends `us` microseconds, serving the interrupts raised meanwhile.
+    void advance(uint32_t us) { run_until(time + us); }
+
+    template <class Ready> void sleep(Ready &&ready, uint32_t wake_time) {
+        if (ready())
+            return;
+        // Wakes up at the next interrupt; the system timer tick bounds the sleep to 1 ms
+        uint32_t until = wake_time;
+        if (static_cast<int32_t>(until - (time + 1000)) > 0)
+            until = time + 1000;
+        for (const auto &interrupt : interrupts) {
+            if (static_cast<int32_t>(interrupt.when - until) < 0)
+                until = interrupt.when;
+        }
+        sleeps++;
+        run_until(until);
+    }
+
+    uint32_t sleeps = 0;
+
+  private:
+    struct Interrupt {
+        uint32_t when;
+        std::function<void()> handler;
+    };
+
+    uint32_t time;
+    std::vector<Interrupt> interrupts;
+
+    void run_until(uint32_t end) {
+        for (size_t i = 0; i < interrupts.size();) {
+            if (static_cast<int32_t>(interrupts[i].when - end) <= 0) {
+                auto handler = std::move(interrupts[i].handler);
+                interrupts.erase(interrupts.begin() + i);
+                handler();
+                i = 0;
+            } else {
+                i++;
+            }
+        }
+        time = end;
+    }
+};
+
+using SimScheduler = Scheduler<SimClock, NUM_TASKS>;
+
+struct TaskCost {
+    SimClock *clock;
+    uint32_t min, max;
+    std::mt19937 *rng;
+};
+
+static void simulated_task(void *data) {
+    auto *cost = static_cast<TaskCost *>(data);
+    std::uniform_int_distribution<uint32_t> distribution(cost->min, cost->max);
+    cost->clock->advance(distribution(*cost->rng));
+}
+
+struct Scenario {
+    const char *name;
+    TaskCost input, display, log, snapshot, stats;
+    /// Input changes at the CV rate, one second out of two, as when a knob is turned
+    bool knob_turned;
+};
+
+/// @return false if a deadline was missed or a release lost
+static bool run(Scenario scenario, double seconds) {
+    std::mt19937 rng(7);
+    SimClock clock(0xFFFFFFFFu - 2000000u); // wraps after 2 s
+    SimScheduler scheduler(clock);
+
+    for (TaskCost *cost : {&scenario.input, &scenario.display, &scenario.log, &scenario.snapshot,
+                           &scenario.stats}) {
+        cost->clock = &clock;
+        cost->rng = &rng;
+    }
+    scheduler.add("input", simulated_task, &scenario.input, 1000000 / INPUT_SAMPLE_RATE,
+                  INPUT_DEADLINE);
+    scheduler.add("display", simulated_task, &scenario.display, 1000000 / DISPLAY_REFRESH_RATE,
+                  DISPLAY_DEADLINE);
+    scheduler.add("log", simulated_task, &scenario.log, LOG_PERIOD, LOG_DEADLINE);
+    scheduler.add("snapshot", simulated_task, &scenario.snapshot, SNAPSHOT_PERIOD,
+                  SNAPSHOT_DEADLINE);
+    scheduler.add("stats", simulated_task, &scenario.stats, SCHEDULER_STATS_PERIOD,
+                  SCHEDULER_STATS_PERIOD);
+
+    // Input changes at the CV rate, one second out of two
+    uint32_t start = clock.now();
+    const auto total = static_cast<uint32_t>(seconds * 1e6);
+    uint32_t signals = 0;
+    if (scenario.knob_turned) {
+        for (uint32_t t = 0; t < total; t += 1000000 / CV_RATE) {
+            if ((t / 1000000) % 2 == 0) {
+                clock.at(start + t, [&] { scheduler.signal(TASK_INPUT); });
+                signals++;
+            }
+        }
+    }
+
+    while (static_cast<int32_t>(clock.now() - (start + total)) < 0)
+        scheduler.run_once();
+
+    uint32_t elapsed = clock.now() - start;
+    std::printf("\n%s: %.0f s, main loop busy %.1f%%, %u sleeps\n", scenario.name, seconds,
+                100.0 - 100.0 * scheduler.idle_time() / elapsed, clock.sleeps);
+    std::printf("%-8s %8s %8s %8s %10s %12s %10s\n", "task", "runs", "misses", "skipped",
+                "max us", "response us", "cpu %");
+
+    bool ok = true;
+    for (size_t i = 0; i < scheduler.size(); i++) {
+        const auto &stats = scheduler.stats(i);
+        std::printf("%-8s %8u %8u %8u %10u %12u %10.2f\n", scheduler.name(i), stats.runs,
+                    stats.misses, stats.skipped, stats.max_time, stats.max_response,
+                    100.0 * stats.cpu_time / elapsed);
+        ok &= stats.misses == 0 && stats.skipped == 0;
+    }
+
+    // Signals arriving while the input task is pending merge into one run, but every burst of
+    // changes must be followed by a run
+    const auto &input = scheduler.stats(TASK_INPUT);
+    ok &= !scenario.knob_turned || input.runs >= signals / 2;
+    return ok;
+}
+
+int main() {
+    // Costs in microseconds: the display update is dominated by the I2C transfer of the frame,
+    // a snapshot by programming and verifying its slot
+    Scenario nominal{"nominal",
+                     {nullptr, 50, 150, nullptr},
+                     {nullptr, 8000, 12000, nullptr},
+                     {nullptr, 10, 40, nullptr},
+                     {nullptr, 500, 1500, nullptr},
+                     {nullptr, 1000, 3000, nullptr},
+                     true};
+    Scenario idle{"idle",
+                  {nullptr, 50, 150, nullptr},
+                  {nullptr, 8000, 12000, nullptr},
+                  {nullptr, 10, 40, nullptr},
+                  {nullptr, 500, 1500, nullptr},
+                  {nullptr, 1000, 3000, nullptr},
+                  false};
+    // A display update longer than its period: late releases are skipped, the input task still
+    // runs between display updates
+    Scenario overload{"display overload",
+                      {nullptr, 50, 150, nullptr},
+                      {nullptr, 35000, 45000, nullptr},
+                      {nullptr, 10, 40, nullptr},
+                      {nullptr, 500, 1500, nullptr},
+                      {nullptr, 1000, 3000, nullptr},
+                      true};
+    // One snapshot out of 16 erases a sector first (45 ms typical): the tasks released meanwhile
+    // miss their deadline once
+    Scenario erase{"snapshot erase",
+                   {nullptr, 50, 150, nullptr},
+                   {nullptr, 8000, 12000, nullptr},
+                   {nullptr, 10, 40, nullptr},
+                   {nullptr, 45000, 50000, nullptr},
+                   {nullptr, 1000, 3000, nullptr},
+                   true};
+
+    bool ok = run(nominal, 60.0);
+    ok &= run(idle, 60.0);
+    run(overload, 20.0);
+    run(erase, 20.0);
+
+    std::printf("\n%s\n", ok ? "ok" : "FAIL: deadline missed or release lost in nominal load");
+    return ok ? 0 : 1;
+}
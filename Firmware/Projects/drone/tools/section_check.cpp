@@ -0,0 +1,247 @@
+/*
+ * Host tool: timing accuracy of the Poincaré-section detector (math/section.hpp) behind the gate
+ * outputs.
+ *
+ * Build (from Firmware/Projects/drone):
+ *   g++ -std=gnu++17 -O2 tools/section_check.cpp math/models.cpp -o section_check
+ *
+ * Two references with known crossing times:
+ *  - a sinusoid sampled at several points per period, whose crossings are exact;
+ *  - a Rossler trajectory sampled at the output rate, whose crossings are located by integrating
+ *    each sample interval again with a 64 times smaller step.
+ * Errors are in output samples, for the interpolated crossing positions and for the sample at
+ * which the crossing is detected (what a gate updated once per sample would see). A crossing on
+ * the second sample after a reset is also checked against linear interpolation.
+ * The gate output is checked as the GPIO plays it: KhaosGates and GatePulses (engine/gates.hpp)
+ * driven block by block as in drone.cpp, each schedule starting with the next block on a
+ * 40 ticks per sample clock, some blocks a tick early or late. The rising edges of the gate, less
+ * the latency of a block and a sample, are compared with the Rossler crossings, and the length
+ * of every pulse is checked.
+ * Exits with a non-zero status if a crossing is missed, or if the largest interpolation error
+ * exceeds SINE_ERROR / (samples per period)^2 for the sinusoids (the error of the quadratic
+ * interpolation scales so), ROSSLER_ERROR for Rossler, or ROSSLER_ERROR plus 1.5 ticks for the
+ * gate edges, or if a gate pulse is not GATE_PULSE_TICKS long.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "../engine/gates.hpp"
+#include "../math/chaos_osc.hpp"
+#include "../math/models.hpp"
+#include "../math/section.hpp"
+
+constexpr double SINE_ERROR = 3.0;
+constexpr double ROSSLER_ERROR = 1e-2;
+/// Gate output as on the target (see drone.cpp)
+constexpr size_t GATE_BLOCK_SIZE = 128;
+constexpr uint32_t GATE_TICKS_PER_SAMPLE = 40;
+constexpr uint32_t GATE_PULSE_TICKS = 4 * GATE_TICKS_PER_SAMPLE;
+
+static bool check(bool condition, const char *label) {
+    std::printf("%-60s %s\n", label, condition ? "ok" : "FAIL");
+    return condition;
+}
+
+struct Errors {
+    size_t count = 0, missed = 0;
+    double interpolated_max = 0, interpolated_sum = 0;
+    double sample_max = 0, sample_sum = 0;
+
+    void add(double interpolated, double sample) {
+        count++;
+        interpolated_max = std::max(interpolated_max, std::fabs(interpolated));
+        interpolated_sum += std::fabs(interpolated);
+        sample_max = std::max(sample_max, std::fabs(sample));
+        sample_sum += std::fabs(sample);
+    }
+
+    /// @return whether no crossing was missed and the interpolation error is within `bound`
+    bool print(const char *label, double bound) const {
+        bool ok = missed == 0 && count > 0 && interpolated_max <= bound;
+        std::printf("%-28s %6zu %7zu %12.2e %12.2e %10.3f %10.3f  %s\n", label, count, missed,
+                    interpolated_max, interpolated_sum / std::max<size_t>(count, 1), sample_max,
+                    sample_sum / std::max<size_t>(count, 1), ok ? "ok" : "FAIL");
+        return ok;
+    }
+};
+
+/// @brief Matches detected crossings (in samples) with reference crossings.
+static Errors compare(const std::vector<double> &detected, const std::vector<double> &reference) {
+    Errors errors;
+    size_t j = 0;
+    for (double t : reference) {
+        while (j < detected.size() && detected[j] < t - 1.0)
+            j++;
+        if (j == detected.size() || detected[j] > t + 1.0) {
+            errors.missed++;
+            continue;
+        }
+        errors.add(detected[j] - t, std::ceil(detected[j]) - t);
+        j++;
+    }
+    return errors;
+}
+
+/// @brief Crossings of `value` (one per sample) through 0 in the rising direction, in samples.
+template <class F> static std::vector<double> detect(size_t samples, F &&value) {
+    math::SectionDetector<math::vec3f> detector({0, 0.0f, math::SectionDirection::RISING, 0.0f});
+    std::vector<double> crossings;
+    for (size_t n = 0; n < samples; n++) {
+        float position = detector.process({value(n), 0.0f, 0.0f});
+        if (position >= 0.0f)
+            crossings.push_back(static_cast<double>(n) - 1.0 + position);
+    }
+    return crossings;
+}
+
+static bool check_sinusoid(double samples_per_period) {
+    constexpr size_t SAMPLES = 200000;
+    const double phase = 0.1234;
+    auto value = [&](size_t n) {
+        return static_cast<float>(std::sin(2.0 * M_PI * (n / samples_per_period) + phase));
+    };
+
+    std::vector<double> reference;
+    for (double k = 1.0; ; k++) {
+        double t = (k - phase / (2.0 * M_PI)) * samples_per_period;
+        if (t >= SAMPLES - 1)
+            break;
+        if (t > 1.0)
+            reference.push_back(t);
+    }
+
+    char label[64];
+    std::snprintf(label, sizeof(label), "sine, %.1f samples/period", samples_per_period);
+    return compare(detect(SAMPLES, value), reference)
+        .print(label, SINE_ERROR / (samples_per_period * samples_per_period));
+}
+
+/// @brief Rossler trajectory, one step per sample
+static std::vector<math::vec3f> rossler_states(size_t samples, float sample_dt) {
+    const math::vec3f seed{10.4794f, -1.0197f, 8.6062f};
+    std::vector<math::vec3f> states(samples);
+    ChaosOsc<math::Rossler> osc({}, seed, 1.0f, sample_dt, sample_dt);
+    for (auto &state : states)
+        state = osc.step();
+    return states;
+}
+
+/// @brief Rising crossings of x = 0 by a Rossler trajectory, in samples: each sample interval is
+/// integrated again from its starting state with a step OVERSAMPLING times smaller (restarting
+/// from the output trajectory keeps chaos from separating the two), and crossings are located
+/// linearly between fine steps
+static std::vector<double> rossler_crossings(const std::vector<math::vec3f> &states,
+                                             float sample_dt) {
+    constexpr size_t OVERSAMPLING = 64;
+    math::Rossler model;
+    const float fine_dt = sample_dt / OVERSAMPLING;
+    std::vector<double> reference;
+    for (size_t n = 1; n < states.size(); n++) {
+        math::vec3f state = states[n - 1];
+        float previous = state.x();
+        for (size_t k = 0; k < OVERSAMPLING; k++) {
+            state = model.step(state, fine_dt);
+            float x = state.x();
+            if (previous <= 0.0f && x > 0.0f) {
+                reference.push_back(n - 1 + (k + previous / (previous - x)) / OVERSAMPLING);
+                break;
+            }
+            previous = x;
+        }
+    }
+    return reference;
+}
+
+static bool check_rossler(float sample_dt) {
+    constexpr size_t SAMPLES = 100000;
+    std::vector<math::vec3f> states = rossler_states(SAMPLES, sample_dt);
+    std::vector<double> reference = rossler_crossings(states, sample_dt);
+
+    char label[64];
+    std::snprintf(label, sizeof(label), "rossler x, dt %.3f", sample_dt);
+    return compare(detect(SAMPLES, [&](size_t n) { return states[n].x(); }), reference)
+        .print(label, ROSSLER_ERROR);
+}
+
+/**
+ * @brief Edges of a gate driven as on the target: KhaosGates schedules the crossings of each
+ * block, GatePulses plays the schedule from the start of the next block, one tick at a time.
+ * Blocks start alternately on time, a tick early and a tick late on the gate clock.
+ */
+static bool check_gate_output(float sample_dt) {
+    constexpr size_t SAMPLES = 100000;
+    constexpr size_t BLOCKS = SAMPLES / GATE_BLOCK_SIZE;
+    std::vector<math::vec3f> states = rossler_states(BLOCKS * GATE_BLOCK_SIZE, sample_dt);
+    std::vector<double> reference = rossler_crossings(states, sample_dt);
+
+    using Gates = KhaosGates<1, GATE_BLOCK_SIZE>;
+    Gates gates({{{0, 0.0f, math::SectionDirection::RISING, 0.0f}}}, GATE_TICKS_PER_SAMPLE);
+    Gates::Pulses pulses(GATE_PULSE_TICKS);
+    Gates::Schedule schedule;
+
+    // Rising edges, as output samples of the trajectory, and lengths of the pulses
+    std::vector<double> edges;
+    uint32_t shortest = UINT32_MAX, longest = 0, high = 0;
+    uint64_t tick = 0;
+    for (size_t k = 0; k <= BLOCKS; k++) {
+        // Block k - 1 starts playing while block k is rendered
+        pulses.start(schedule);
+        if (k < BLOCKS)
+            gates.process(&states[k * GATE_BLOCK_SIZE], GATE_BLOCK_SIZE, schedule);
+        int64_t jitter = k % 3 == 1 ? -1 : k % 3 == 2 ? 1 : 0;
+        uint64_t next_start = (k + 1) * GATE_BLOCK_SIZE * GATE_TICKS_PER_SAMPLE + jitter;
+        for (; tick < next_start; tick++) {
+            bool gate = pulses.tick() & 1u;
+            if (gate && high == 0) {
+                // Played one block late, and one sample after the crossing by design
+                edges.push_back(static_cast<double>(tick) / GATE_TICKS_PER_SAMPLE -
+                                GATE_BLOCK_SIZE - 1.0);
+            }
+            if (!gate && high > 0) {
+                shortest = std::min(shortest, high);
+                longest = std::max(longest, high);
+            }
+            high = gate ? high + 1 : 0;
+        }
+    }
+
+    char label[64];
+    std::snprintf(label, sizeof(label), "gate output, dt %.3f", sample_dt);
+    // Rounding to the nearest tick, and a tick of jitter
+    bool ok = compare(edges, reference)
+                  .print(label, ROSSLER_ERROR + 1.5 / GATE_TICKS_PER_SAMPLE);
+    std::snprintf(label, sizeof(label), "gate pulses of %u ticks, dt %.3f", GATE_PULSE_TICKS,
+                  sample_dt);
+    return check(shortest == GATE_PULSE_TICKS && longest == GATE_PULSE_TICKS, label) && ok;
+}
+
+/// @brief A crossing on the second sample after a reset has no third sample to interpolate from.
+static bool check_reset() {
+    math::SectionDetector<math::vec3f> detector({0, 0.0f, math::SectionDirection::RISING, 0.0f});
+    detector.process({5.0f, 0.0f, 0.0f});
+    detector.process({4.0f, 0.0f, 0.0f});
+    detector.reset();
+    detector.process({-1.0f, 0.0f, 0.0f});
+    float position = detector.process({3.0f, 0.0f, 0.0f});
+    return check(position == 0.25f, "crossing after a reset, linear interpolation");
+}
+
+int main() {
+    std::printf("%-28s %6s %7s %12s %12s %10s %10s\n", "signal", "count", "missed",
+                "interp max", "interp mean", "sample max", "sample mean");
+    bool ok = true;
+    for (double period : {8.3, 16.7, 33.1, 127.9})
+        ok &= check_sinusoid(period);
+    for (float dt : {0.05f, 0.1f, 0.2f})
+        ok &= check_rossler(dt);
+    for (float dt : {0.05f, 0.1f, 0.2f})
+        ok &= check_gate_output(dt);
+    std::printf("\n");
+    ok &= check_reset();
+
+    std::printf("\n%s\n", ok ? "ok" : "FAIL");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,272 @@
+/*
+ * Host tool: checks the snapshot log (engine/snapshot.hpp) on an emulated NOR flash with the
+ * layout used by the firmware, and that a resumed engine continues the saved trajectory.
+ *
+ * Build (from Firmware/Projects/drone):
+ *   g++ -std=gnu++17 -O2 tools/snapshot_check.cpp engine/khaos_engine.cpp math/models.cpp \
+ *       -o snapshot_check
+ *
+ * Usage:
+ *   ./snapshot_check [-f flash.bin]
+ *
+ * Checks:
+ *  - thousands of saves, each loaded back by a fresh log (as after a power cycle), with the
+ *    erases spread evenly over the sectors;
+ *  - power cuts at every byte of a save, and while erasing: the previous snapshot is loaded;
+ *  - corrupted slots are ignored;
+ *  - an engine resumed from a snapshot renders the same samples as the engine it was taken from.
+ * With -f, the emulated flash is loaded from the file if it exists, one more snapshot is saved
+ * and the file is written back: running it repeatedly behaves like power cycles of the module.
+ * Exits with a non-zero status if a check fails.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "../engine/khaos_engine.hpp"
+#include "../engine/snapshot.hpp"
+#include "../engine/storage.hpp"
+
+// Keep in sync with drone.cpp
+constexpr size_t SECTOR_SIZE = 4096;
+constexpr size_t SNAPSHOT_STORAGE_SIZE = 16 * SECTOR_SIZE;
+constexpr double SNAPSHOT_PERIOD = 60.0; // s
+
+using Flash = RamStorage<SNAPSHOT_STORAGE_SIZE, SECTOR_SIZE>;
+using Log = SnapshotLog<KhaosSnapshot>;
+
+/// Emulates a power cut: operations stop taking effect once `budget` bytes were programmed, or
+/// at the erase number `erase_cut`.
+class CutStorage : public Storage {
+  public:
+    CutStorage(Storage &storage, size_t budget, size_t erase_cut = SIZE_MAX)
+        : storage(storage), budget(budget), erase_cut(erase_cut) {}
+
+    size_t size() const override { return storage.size(); }
+    size_t sector_size() const override { return storage.sector_size(); }
+
+    bool read(size_t address, void *out, size_t size) override {
+        return storage.read(address, out, size);
+    }
+
+    bool write(size_t address, const void *data, size_t size) override {
+        size_t written = std::min(size, budget);
+        budget -= written;
+        storage.write(address, data, written);
+        return written == size;
+    }
+
+    bool erase_sector(size_t sector) override {
+        if (erases++ == erase_cut) {
+            // Interrupted halfway: the start of the sector is erased, the rest is not
+            std::vector<uint8_t> half(storage.sector_size() / 2, 0xFF);
+            std::vector<uint8_t> rest(storage.sector_size() / 2);
+            size_t address = sector * storage.sector_size();
+            storage.read(address + half.size(), rest.data(), rest.size());
+            storage.erase_sector(sector);
+            storage.write(address + half.size(), rest.data(), rest.size());
+            budget = 0;
+            return false;
+        }
+        return budget > 0 && storage.erase_sector(sector);
+    }
+
+  private:
+    Storage &storage;
+    size_t budget;
+    size_t erase_cut;
+    size_t erases = 0;
+};
+
+/// A snapshot whose every field depends on `n`
+static KhaosSnapshot make_snapshot(uint32_t n) {
+    KhaosSnapshot snapshot{};
+    snapshot.model_data.selected =
+        static_cast<KhaosModelData::SelectedModel>(n % KhaosModelData::NUM_MODELS);
+    snapshot.model_data.rossler.c = 5.0f + 0.001f * static_cast<float>(n % 1000);
+    snapshot.model_data.touch(KhaosModelData::ROSSLER);
+    for (size_t i = 0; i < KhaosModelData::NUM_MODELS; i++) {
+        snapshot.engine_state.states[i] = {static_cast<float>(n), static_cast<float>(i), -1.0f};
+    }
+    for (size_t i = 0; i < snapshot.encoder_values.size(); i++)
+        snapshot.encoder_values[i] = static_cast<uint16_t>(n * 7 + i);
+    return snapshot;
+}
+
+static bool same(const KhaosSnapshot &a, const KhaosSnapshot &b) {
+    return std::memcmp(&a, &b, sizeof(KhaosSnapshot)) == 0;
+}
+
+/// @return true if a fresh log loads `expected` from `storage`
+static bool loads(Storage &storage, const KhaosSnapshot &expected) {
+    Log log(storage);
+    KhaosSnapshot loaded;
+    return log.load(loaded) && same(loaded, expected);
+}
+
+static bool check(bool ok, const char *label) {
+    std::printf("%-52s %s\n", label, ok ? "ok" : "FAIL");
+    return ok;
+}
+
+static bool check_wear() {
+    constexpr uint32_t SAVES = 5000;
+    Flash flash;
+    bool ok = true;
+    {
+        Log log(flash);
+        KhaosSnapshot loaded;
+        ok &= !log.load(loaded);
+    }
+
+    // Power cycle after every save: each boot loads, then saves
+    for (uint32_t n = 1; n <= SAVES && ok; n++) {
+        Log log(flash);
+        KhaosSnapshot loaded;
+        log.load(loaded);
+        ok &= log.save(make_snapshot(n)) && loads(flash, make_snapshot(n));
+    }
+
+    auto range = std::minmax_element(flash.erases.begin(), flash.erases.end());
+    size_t slots = Log(flash).num_slots();
+    std::printf("%u saves in %zu slots of %zu bytes: %u to %u erases per sector\n", SAVES, slots,
+                Log::SLOT_SIZE, *range.first, *range.second);
+    std::printf("one save every %.0f s: each sector erased every %.1f h\n", SNAPSHOT_PERIOD,
+                SNAPSHOT_PERIOD * static_cast<double>(slots) / 3600.0);
+    return check(ok && *range.second - *range.first <= 1, "saves load back, erases even");
+}
+
+/// @brief Cuts the power at every byte of the save following the first `saves` ones, and halfway
+/// through the erase if that save starts a sector.
+static bool check_power_cuts(uint32_t saves) {
+    Flash flash;
+    Log log(flash);
+    for (uint32_t n = 1; n <= saves; n++)
+        log.save(make_snapshot(n));
+    const KhaosSnapshot previous = make_snapshot(saves);
+
+    bool ok = true;
+    for (size_t budget = 0; budget < sizeof(Log::Header) + sizeof(KhaosSnapshot); budget++) {
+        Flash cut_flash = flash;
+        CutStorage cut(cut_flash, budget);
+        Log cut_log(cut);
+        KhaosSnapshot loaded;
+        cut_log.load(loaded);
+        cut_log.save(make_snapshot(1000));
+        ok &= loads(cut_flash, previous);
+    }
+
+    Flash cut_flash = flash;
+    if (saves % (SECTOR_SIZE / Log::SLOT_SIZE) == 0) {
+        CutStorage cut(cut_flash, SIZE_MAX, 0);
+        Log cut_log(cut);
+        KhaosSnapshot loaded;
+        cut_log.load(loaded);
+        cut_log.save(make_snapshot(1000));
+        ok &= loads(cut_flash, previous);
+    }
+
+    // The log keeps working after a cut
+    Log after(cut_flash);
+    KhaosSnapshot loaded;
+    after.load(loaded);
+    return ok && after.save(make_snapshot(2000)) && loads(cut_flash, make_snapshot(2000));
+}
+
+static bool check_corruption() {
+    Flash flash;
+    Log log(flash);
+    for (uint32_t n = 1; n <= 10; n++)
+        log.save(make_snapshot(n));
+
+    bool ok = true;
+    // Every bit of the latest slot, one at a time (header included)
+    size_t latest = 9 * Log::SLOT_SIZE;
+    for (size_t bit = 0; bit < 8 * (sizeof(Log::Header) + sizeof(KhaosSnapshot)); bit++) {
+        Flash corrupted = flash;
+        corrupted.data[latest + bit / 8] ^= static_cast<uint8_t>(1u << (bit % 8));
+        KhaosSnapshot loaded;
+        Log reload(corrupted);
+        ok &= reload.load(loaded) && same(loaded, make_snapshot(9));
+    }
+    return check(ok, "corrupted slots are ignored");
+}
+
+static bool check_resume() {
+    constexpr KhaosEngineConfig CONFIG{100, 128, 2048, 128, 512};
+    KhaosEngine original(CONFIG);
+    KhaosModelData data;
+    data.selected = KhaosModelData::LORENTZ;
+    original.set_model_data(data);
+
+    // Past the preroll and the crossfade
+    std::vector<math::vec3f> block(CONFIG.block_size), resumed_block(CONFIG.block_size);
+    for (size_t i = 0; i < 100; i++)
+        original.render(block.data(), block.size());
+
+    KhaosEngine resumed(CONFIG);
+    resumed.resume(data, original.get_state());
+
+    float max_error = 0.0f;
+    for (size_t i = 0; i < 10; i++) {
+        original.render(block.data(), block.size());
+        resumed.render(resumed_block.data(), resumed_block.size());
+        for (size_t k = 0; k < block.size(); k++) {
+            math::vec3f d = block[k] - resumed_block[k];
+            max_error = std::max({max_error, std::fabs(d.x()), std::fabs(d.y()), std::fabs(d.z())});
+        }
+    }
+    std::printf("resumed engine: max output difference %.2e over 10 blocks\n", max_error);
+    return check(max_error == 0.0f, "resumed engine continues the trajectory");
+}
+
+/// Saves one more snapshot in the flash image `path`, as one power cycle of the module
+static bool cycle_file(const char *path) {
+    Flash flash;
+    if (FILE *file = std::fopen(path, "rb")) {
+        size_t read = std::fread(flash.data.data(), 1, flash.data.size(), file);
+        std::fclose(file);
+        if (read != flash.data.size()) {
+            std::fprintf(stderr, "%s: not a %zu-byte flash image\n", path, flash.data.size());
+            return false;
+        }
+    }
+
+    Log log(flash);
+    KhaosSnapshot snapshot;
+    bool found = log.load(snapshot);
+    std::printf("%s: %s %lu\n", path, found ? "loaded snapshot" : "no snapshot, saving",
+                static_cast<unsigned long>(log.get_sequence()));
+    if (!log.save(make_snapshot(log.get_sequence() + 1)))
+        return false;
+
+    FILE *file = std::fopen(path, "wb");
+    if (!file) {
+        std::perror(path);
+        return false;
+    }
+    std::fwrite(flash.data.data(), 1, flash.data.size(), file);
+    std::fclose(file);
+    return true;
+}
+
+int main(int argc, char **argv) {
+    if (argc == 3 && !std::strcmp(argv[1], "-f"))
+        return cycle_file(argv[2]) ? 0 : 1;
+
+    std::printf("snapshot %zu bytes, slot %zu bytes\n", sizeof(KhaosSnapshot), Log::SLOT_SIZE);
+    bool ok = check_wear();
+    constexpr auto SLOTS_PER_SECTOR = static_cast<uint32_t>(SECTOR_SIZE / Log::SLOT_SIZE);
+    ok &= check(check_power_cuts(5), "power cuts within a sector load the previous one");
+    ok &= check(check_power_cuts(SLOTS_PER_SECTOR), "power cuts at an erase load the previous one");
+    ok &= check(check_power_cuts(SNAPSHOT_STORAGE_SIZE / Log::SLOT_SIZE),
+                "power cuts at the wrap-around load the previous one");
+    ok &= check_corruption();
+    ok &= check_resume();
+
+    std::printf("\n%s\n", ok ? "ok" : "FAIL");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,195 @@
+/*
+ * Host tool: checks the divergence/collapse watchdog of ChaosOsc (math/chaos_osc.hpp), and that
+ * the engine does not rely on it at the default parameters.
+ *
+ * Build (from Firmware/Projects/drone):
+ *   g++ -std=gnu++17 -O2 tools/watchdog_check.cpp engine/khaos_engine.cpp math/models.cpp \
+ *       -o watchdog_check
+ *
+ * Checks, on a Rossler oscillator with the watchdog of the engine (escape and stillness criteria
+ * from MODEL_BOUNDS, seeds from math/seed_tables.hpp):
+ *  - a healthy trajectory is never reseeded;
+ *  - a NaN or infinite state, and a state beyond the escape radius, are reseeded at the next
+ *    check and counted as diverged;
+ *  - a state which stops moving is reseeded after WATCHDOG_COLLAPSE_BLOCKS checks, not before,
+ *    and counted as collapsed; with the collapse check disabled, it is left alone;
+ *  - reseeds go through the seeds in turn, and start over from the first one with new seeds;
+ *  - without seeds, the watchdog does nothing.
+ * Then every model is rendered by the engine at its default parameters for ENGINE_TIME seconds
+ * of output: none may be reseeded.
+ * Exits with a non-zero status if a check fails.
+ */
+
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <vector>
+
+#include "../engine/khaos_engine.hpp"
+
+using math::vec3f;
+using Osc = ChaosOsc<math::Rossler>;
+
+// Keep in sync with drone.cpp
+constexpr KhaosEngineConfig CONFIG{100, 128, 2048, 128, 512};
+constexpr float ENGINE_TIME = 600.0f; // s
+/// Output samples per check of the watchdog, as one block of the firmware
+constexpr size_t BLOCK_SIZE = 128;
+
+static bool check(bool ok, const char *label) {
+    std::printf("%-60s %s\n", label, ok ? "ok" : "FAIL");
+    return ok;
+}
+
+static bool equal(const vec3f &a, const vec3f &b) {
+    return a.x() == b.x() && a.y() == b.y() && a.z() == b.z();
+}
+
+/// @brief Rossler oscillator with the watchdog the engine gives it
+static Osc make_osc() {
+    const ModelBounds &bounds = MODEL_BOUNDS[KhaosModelData::ROSSLER];
+    const vec3f *seeds = math::model_seeds(math::Rossler{});
+    Osc osc(math::Rossler{}, seeds[0], CONFIG.sample_rate, 1.0f);
+
+    vec3f half_diagonal = (bounds.max - bounds.min) / 2.0f;
+    float size_sq = math::dot(half_diagonal, half_diagonal);
+    ChaosWatchdog<vec3f> watchdog;
+    watchdog.center = (bounds.max + bounds.min) / 2.0f;
+    watchdog.escape_radius_sq = WATCHDOG_ESCAPE_FACTOR * WATCHDOG_ESCAPE_FACTOR * size_sq;
+    watchdog.min_motion_sq = WATCHDOG_MIN_MOTION * WATCHDOG_MIN_MOTION * size_sq;
+    watchdog.collapse_checks = WATCHDOG_COLLAPSE_BLOCKS;
+    watchdog.seeds = seeds;
+    watchdog.num_seeds = math::SeedTable::SEEDS_PER_CELL;
+    osc.set_watchdog(watchdog);
+    return osc;
+}
+
+/// @brief Renders one block, then runs the health check.
+static bool run_block(Osc &osc) {
+    for (size_t i = 0; i < BLOCK_SIZE; i++)
+        osc.step();
+    return osc.check_health();
+}
+
+static bool check_healthy() {
+    Osc osc = make_osc();
+    bool reseeded = false;
+    for (size_t block = 0; block < 1000; block++)
+        reseeded |= run_block(osc);
+    const ChaosOscStats &stats = osc.get_stats();
+    return check(!reseeded && stats.diverged == 0 && stats.collapsed == 0,
+                 "healthy trajectory is left alone");
+}
+
+static bool check_diverged() {
+    const vec3f *seeds = math::model_seeds(math::Rossler{});
+    const float inf = std::numeric_limits<float>::infinity();
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    const vec3f bad[] = {{nan, 0.0f, 0.0f}, {0.0f, 0.0f, inf}, {0.0f, -inf, 0.0f},
+                         {1e3f, 1e3f, 1e3f}};
+
+    Osc osc = make_osc();
+    bool ok = true;
+    for (size_t i = 0; i < sizeof(bad) / sizeof(bad[0]); i++) {
+        osc.state = bad[i];
+        ok &= osc.check_health();
+        // In turn, so the first one comes back after the last
+        ok &= equal(osc.state, seeds[i % math::SeedTable::SEEDS_PER_CELL]);
+        ok &= osc.get_stats().diverged == i + 1;
+    }
+    osc.state = {nan, nan, nan};
+    ok &= osc.check_health() && equal(osc.state, seeds[0]);
+    ok &= osc.get_stats().diverged == 5 && osc.get_stats().collapsed == 0;
+    return check(ok, "NaN, Inf and escaped states reseeded in turn");
+}
+
+static bool check_collapsed() {
+    const vec3f *seeds = math::model_seeds(math::Rossler{});
+    Osc osc = make_osc();
+    const vec3f still{1.0f, 2.0f, 3.0f};
+
+    bool ok = true;
+    osc.set_state(still);
+    for (uint32_t i = 1; i < WATCHDOG_COLLAPSE_BLOCKS; i++)
+        ok &= !osc.check_health();
+    ok &= osc.check_health() && equal(osc.state, seeds[0]);
+    ok &= osc.get_stats().collapsed == 1 && osc.get_stats().diverged == 0;
+
+    // Motion in between starts the count over
+    osc.set_state(still);
+    for (uint32_t i = 1; i < WATCHDOG_COLLAPSE_BLOCKS; i++)
+        ok &= !osc.check_health();
+    osc.state = still + vec3f{1.0f, 0.0f, 0.0f};
+    ok &= !osc.check_health();
+    for (uint32_t i = 1; i < WATCHDOG_COLLAPSE_BLOCKS; i++)
+        ok &= !osc.check_health();
+    ok &= osc.check_health() && equal(osc.state, seeds[1]);
+    ok &= osc.get_stats().collapsed == 2;
+    ok = check(ok, "still state reseeded after WATCHDOG_COLLAPSE_BLOCKS checks") && ok;
+
+    osc.set_collapse_checks(0);
+    osc.set_state(still);
+    bool reseeded = false;
+    for (uint32_t i = 0; i < 4 * WATCHDOG_COLLAPSE_BLOCKS; i++)
+        reseeded |= osc.check_health();
+    osc.state = {0.0f, 0.0f, std::numeric_limits<float>::quiet_NaN()};
+    bool diverged = osc.check_health();
+    return check(!reseeded && diverged && osc.get_stats().collapsed == 2,
+                 "collapse check disabled, divergence still caught") && ok;
+}
+
+static bool check_seeds() {
+    Osc osc = make_osc();
+    const vec3f other[] = {{1.0f, 1.0f, 1.0f}, {2.0f, 2.0f, 2.0f}};
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+
+    bool ok = true;
+    osc.state = {nan, 0.0f, 0.0f};
+    osc.check_health();
+    osc.set_seeds(other, 2);
+    for (size_t i = 0; i < 3; i++) {
+        osc.state = {nan, 0.0f, 0.0f};
+        ok &= osc.check_health() && equal(osc.state, other[i % 2]);
+    }
+    ok = check(ok, "new seeds used from the first one") && ok;
+
+    osc.set_seeds(nullptr, 0);
+    osc.state = {nan, 0.0f, 0.0f};
+    bool reseeded = osc.check_health();
+    return check(!reseeded && std::isnan(osc.state.x()), "no seeds, no watchdog") && ok;
+}
+
+static bool check_engine() {
+    const char *names[] = {"Chua", "Sprott", "Rossler", "Halvorsen", "Lorentz"};
+    const auto blocks = static_cast<size_t>(ENGINE_TIME * CONFIG.sample_rate / CONFIG.block_size);
+    std::vector<vec3f> block(CONFIG.block_size);
+
+    bool ok = true;
+    for (size_t model = 0; model < KhaosModelData::NUM_MODELS; model++) {
+        KhaosEngine engine(CONFIG);
+        KhaosModelData data;
+        data.selected = static_cast<KhaosModelData::SelectedModel>(model);
+        engine.set_model_data(data);
+
+        size_t reseeds = 0;
+        for (size_t i = 0; i < blocks; i++)
+            reseeds += (engine.render(block.data(), block.size()) >> model) & 1u;
+
+        char label[64];
+        std::snprintf(label, sizeof(label), "%s at default parameters: %zu reseeds", names[model],
+                      reseeds);
+        ok = check(reseeds == 0, label) && ok;
+    }
+    return ok;
+}
+
+int main() {
+    bool ok = check_healthy();
+    ok = check_diverged() && ok;
+    ok = check_collapsed() && ok;
+    ok = check_seeds() && ok;
+    ok = check_engine() && ok;
+
+    std::printf("\n%s\n", ok ? "ok" : "FAIL");
+    return ok ? 0 : 1;
+}